@@ -1,19 +1,19 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "intfmt.h"
+
 int len(char *s) {
     return strlen(s);
 }
 
+// s 至少 INTFMT_MAX + 1 字节
 void iptoa(char *s, long *p) {
     long val = *p;
-    sprintf(s, "%ld", val);
+    i64_to_str(val, s);
 }
 
+// 不再先格式化再 strlen: 直接由 clz 和 10 的幂表算出位数
 int intlen(long x) {
-    long v;
-    char buf[12];
-    v = x;
-    iptoa(buf, &v);
-    return len(buf);
-}
\ No newline at end of file
+    return i64_len(x);
+}
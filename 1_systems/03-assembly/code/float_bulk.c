@@ -0,0 +1,455 @@
+#include <immintrin.h>
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// 批量版的 float_.c: 对整个数组做分类 (NaN/Inf/非规格化数)、取指数、
+// 与 int 互相转换。每个操作有标量循环、AVX2 和 AVX-512 三个版本,
+// 运行时按 CPU 支持选择, main 里逐一对比结果和速度。
+//
+// 编译: gcc -O2 float_bulk.c -o float_bulk -lm
+
+// 分类编号恰好等于 |x| 的位模式越过的边界数:
+// 0 < 非规格化 < 0x00800000 <= 规格化 < 0x7f800000 = Inf < NaN
+enum { FC_ZERO, FC_SUBNORMAL, FC_NORMAL, FC_INF, FC_NAN, FC_NUM };
+
+static const char* class_names[FC_NUM] = {"zero", "subnormal", "normal",
+                                          "inf", "nan"};
+
+#define ABS_MASK 0x7fffffff
+#define MIN_NORMAL 0x00800000
+#define EXP_ALL_ONES 0x7f800000
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static inline uint32_t float_bits(float f) {
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+// ---------------- 标量版本 (基准) ----------------
+// 关掉自动向量化, 保证这里真的是一次一个元素
+
+__attribute__((optimize("no-tree-vectorize"))) static void
+classify_scalar(const float* x, size_t n, uint8_t* cls, size_t counts[]) {
+    memset(counts, 0, FC_NUM * sizeof(size_t));
+    for (size_t i = 0; i < n; i++) {
+        int c;
+        switch (fpclassify(x[i])) {
+        case FP_ZERO:
+            c = FC_ZERO;
+            break;
+        case FP_SUBNORMAL:
+            c = FC_SUBNORMAL;
+            break;
+        case FP_INFINITE:
+            c = FC_INF;
+            break;
+        case FP_NAN:
+            c = FC_NAN;
+            break;
+        default:
+            c = FC_NORMAL;
+        }
+        if (cls)
+            cls[i] = c;
+        counts[c]++;
+    }
+}
+
+// 和 ilogbf 一致: 0 和 NaN 得 INT_MIN, Inf 得 INT_MAX
+__attribute__((optimize("no-tree-vectorize"))) static void
+ilogb_scalar(const float* x, size_t n, int32_t* e) {
+    for (size_t i = 0; i < n; i++)
+        e[i] = ilogbf(x[i]);
+}
+
+// cvttss2si: 超出 int 范围和 NaN 得 0x80000000, 与打包版本一致
+__attribute__((optimize("no-tree-vectorize"))) static void
+to_int_scalar(const float* x, size_t n, int32_t* out) {
+    for (size_t i = 0; i < n; i++)
+        out[i] = _mm_cvtt_ss2si(_mm_set_ss(x[i]));
+}
+
+__attribute__((optimize("no-tree-vectorize"))) static void
+to_float_scalar(const int32_t* x, size_t n, float* out) {
+    for (size_t i = 0; i < n; i++)
+        out[i] = (float)x[i];
+}
+
+// ---------------- AVX2 ----------------
+
+// 32 个元素的分类编号: 4 次有符号比较的结果 (-1/0) 相加再取负
+__attribute__((target("avx2"))) static void
+classify_avx2(const float* x, size_t n, uint8_t* cls, size_t counts[]) {
+    const __m256i abs_mask = _mm256_set1_epi32(ABS_MASK);
+    const __m256i b0 = _mm256_setzero_si256();
+    const __m256i b1 = _mm256_set1_epi32(MIN_NORMAL - 1);
+    const __m256i b2 = _mm256_set1_epi32(EXP_ALL_ONES - 1);
+    const __m256i b3 = _mm256_set1_epi32(EXP_ALL_ONES);
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    size_t above[4] = {0, 0, 0, 0}; // 越过每条边界的元素数
+    size_t i = 0;
+
+    for (; i + 32 <= n; i += 32) {
+        __m256i code[4];
+        for (int k = 0; k < 4; k++) {
+            __m256i a = _mm256_and_si256(
+                _mm256_loadu_si256((const __m256i*)(x + i + 8 * k)), abs_mask);
+            __m256i m0 = _mm256_cmpgt_epi32(a, b0);
+            __m256i m1 = _mm256_cmpgt_epi32(a, b1);
+            __m256i m2 = _mm256_cmpgt_epi32(a, b2);
+            __m256i m3 = _mm256_cmpgt_epi32(a, b3);
+            above[0] += __builtin_popcount(_mm256_movemask_ps((__m256)m0));
+            above[1] += __builtin_popcount(_mm256_movemask_ps((__m256)m1));
+            above[2] += __builtin_popcount(_mm256_movemask_ps((__m256)m2));
+            above[3] += __builtin_popcount(_mm256_movemask_ps((__m256)m3));
+            __m256i sum = _mm256_add_epi32(_mm256_add_epi32(m0, m1),
+                                           _mm256_add_epi32(m2, m3));
+            code[k] = _mm256_sub_epi32(_mm256_setzero_si256(), sum);
+        }
+        if (cls) {
+            // 32 位 -> 16 位 -> 8 位, pack 按 128 位分半交错, 最后重排
+            __m256i w01 = _mm256_packs_epi32(code[0], code[1]);
+            __m256i w23 = _mm256_packs_epi32(code[2], code[3]);
+            __m256i b = _mm256_packs_epi16(w01, w23);
+            b = _mm256_permutevar8x32_epi32(b, order);
+            _mm256_storeu_si256((__m256i*)(cls + i), b);
+        }
+    }
+
+    size_t tail[FC_NUM];
+    classify_scalar(x + i, n - i, cls ? cls + i : NULL, tail);
+    size_t total = i;
+    counts[FC_ZERO] = total - above[0] + tail[FC_ZERO];
+    counts[FC_SUBNORMAL] = above[0] - above[1] + tail[FC_SUBNORMAL];
+    counts[FC_NORMAL] = above[1] - above[2] + tail[FC_NORMAL];
+    counts[FC_INF] = above[2] - above[3] + tail[FC_INF];
+    counts[FC_NAN] = above[3] + tail[FC_NAN];
+}
+
+// 指数字段减偏置; 非规格化数先乘 2^23 变成规格化数再取
+__attribute__((target("avx2"))) static void ilogb_avx2(const float* x,
+                                                       size_t n, int32_t* e) {
+    const __m256i abs_mask = _mm256_set1_epi32(ABS_MASK);
+    const __m256i exp_ones = _mm256_set1_epi32(EXP_ALL_ONES);
+    const __m256i ff = _mm256_set1_epi32(0xff);
+    const __m256i int_min = _mm256_set1_epi32(INT_MIN);
+    const __m256i int_max = _mm256_set1_epi32(INT_MAX);
+    const __m256 two23 = _mm256_set1_ps(8388608.0f);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(x + i);
+        __m256i a = _mm256_and_si256(_mm256_castps_si256(v), abs_mask);
+        __m256i ex = _mm256_srli_epi32(a, 23);
+        __m256i r = _mm256_sub_epi32(ex, _mm256_set1_epi32(127));
+
+        __m256i scaled = _mm256_castps_si256(_mm256_mul_ps(v, two23));
+        __m256i sub_ex = _mm256_and_si256(_mm256_srli_epi32(scaled, 23), ff);
+        __m256i sub = _mm256_sub_epi32(sub_ex, _mm256_set1_epi32(150));
+        __m256i is_sub = _mm256_cmpeq_epi32(ex, _mm256_setzero_si256());
+        r = _mm256_blendv_epi8(r, sub, is_sub);
+
+        __m256i is_zero = _mm256_cmpeq_epi32(a, _mm256_setzero_si256());
+        __m256i is_inf = _mm256_cmpeq_epi32(a, exp_ones);
+        __m256i is_nan = _mm256_cmpgt_epi32(a, exp_ones);
+        r = _mm256_blendv_epi8(r, int_min, _mm256_or_si256(is_zero, is_nan));
+        r = _mm256_blendv_epi8(r, int_max, is_inf);
+        _mm256_storeu_si256((__m256i*)(e + i), r);
+    }
+    ilogb_scalar(x + i, n - i, e + i);
+}
+
+// cvttps2dq
+__attribute__((target("avx2"))) static void to_int_avx2(const float* x,
+                                                        size_t n,
+                                                        int32_t* out) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_si256((__m256i*)(out + i),
+                            _mm256_cvttps_epi32(_mm256_loadu_ps(x + i)));
+    to_int_scalar(x + i, n - i, out + i);
+}
+
+// cvtdq2ps
+__attribute__((target("avx2"))) static void
+to_float_avx2(const int32_t* x, size_t n, float* out) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(out + i, _mm256_cvtepi32_ps(_mm256_loadu_si256(
+                                      (const __m256i*)(x + i))));
+    to_float_scalar(x + i, n - i, out + i);
+}
+
+// ---------------- AVX-512 ----------------
+
+// 比较直接得到掩码寄存器, vpmovdb 把编号压成字节
+__attribute__((target("avx512f"))) static void
+classify_avx512(const float* x, size_t n, uint8_t* cls, size_t counts[]) {
+    const __m512i abs_mask = _mm512_set1_epi32(ABS_MASK);
+    const __m512i b1 = _mm512_set1_epi32(MIN_NORMAL - 1);
+    const __m512i b2 = _mm512_set1_epi32(EXP_ALL_ONES - 1);
+    const __m512i b3 = _mm512_set1_epi32(EXP_ALL_ONES);
+    const __m512i one = _mm512_set1_epi32(1);
+    size_t above[4] = {0, 0, 0, 0};
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m512i a = _mm512_and_si512(_mm512_loadu_si512(x + i), abs_mask);
+        __mmask16 m0 = _mm512_test_epi32_mask(a, a);
+        __mmask16 m1 = _mm512_cmpgt_epi32_mask(a, b1);
+        __mmask16 m2 = _mm512_cmpgt_epi32_mask(a, b2);
+        __mmask16 m3 = _mm512_cmpgt_epi32_mask(a, b3);
+        above[0] += __builtin_popcount(m0);
+        above[1] += __builtin_popcount(m1);
+        above[2] += __builtin_popcount(m2);
+        above[3] += __builtin_popcount(m3);
+        if (cls) {
+            __m512i c = _mm512_maskz_mov_epi32(m0, one);
+            c = _mm512_mask_add_epi32(c, m1, c, one);
+            c = _mm512_mask_add_epi32(c, m2, c, one);
+            c = _mm512_mask_add_epi32(c, m3, c, one);
+            _mm_storeu_si128((__m128i*)(cls + i), _mm512_cvtepi32_epi8(c));
+        }
+    }
+
+    size_t tail[FC_NUM];
+    classify_scalar(x + i, n - i, cls ? cls + i : NULL, tail);
+    size_t total = i;
+    counts[FC_ZERO] = total - above[0] + tail[FC_ZERO];
+    counts[FC_SUBNORMAL] = above[0] - above[1] + tail[FC_SUBNORMAL];
+    counts[FC_NORMAL] = above[1] - above[2] + tail[FC_NORMAL];
+    counts[FC_INF] = above[2] - above[3] + tail[FC_INF];
+    counts[FC_NAN] = above[3] + tail[FC_NAN];
+}
+
+// vgetexpps 直接给出 floor(log2|x|), 非规格化数也正确; 只需修正特殊值
+__attribute__((target("avx512f"))) static void
+ilogb_avx512(const float* x, size_t n, int32_t* e) {
+    const __m512i abs_mask = _mm512_set1_epi32(ABS_MASK);
+    const __m512i exp_ones = _mm512_set1_epi32(EXP_ALL_ONES);
+    const __m512i int_min = _mm512_set1_epi32(INT_MIN);
+    const __m512i int_max = _mm512_set1_epi32(INT_MAX);
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m512 v = _mm512_loadu_ps(x + i);
+        __m512i a = _mm512_and_si512(_mm512_castps_si512(v), abs_mask);
+        __m512i r = _mm512_cvttps_epi32(_mm512_getexp_ps(v));
+        __mmask16 zero = _mm512_testn_epi32_mask(a, a);
+        __mmask16 nan = _mm512_cmpgt_epi32_mask(a, exp_ones);
+        __mmask16 inf = _mm512_cmpeq_epi32_mask(a, exp_ones);
+        r = _mm512_mask_mov_epi32(r, zero | nan, int_min);
+        r = _mm512_mask_mov_epi32(r, inf, int_max);
+        _mm512_storeu_si512(e + i, r);
+    }
+    ilogb_scalar(x + i, n - i, e + i);
+}
+
+__attribute__((target("avx512f"))) static void
+to_int_avx512(const float* x, size_t n, int32_t* out) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+        _mm512_storeu_si512(out + i,
+                            _mm512_cvttps_epi32(_mm512_loadu_ps(x + i)));
+    to_int_scalar(x + i, n - i, out + i);
+}
+
+__attribute__((target("avx512f"))) static void
+to_float_avx512(const int32_t* x, size_t n, float* out) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+        _mm512_storeu_ps(out + i,
+                         _mm512_cvtepi32_ps(_mm512_loadu_si512(x + i)));
+    to_float_scalar(x + i, n - i, out + i);
+}
+
+// ---------------- 对外接口: 按 CPU 选择实现 ----------------
+
+enum { IMPL_SCALAR, IMPL_AVX2, IMPL_AVX512, IMPL_NUM };
+static const char* impl_names[IMPL_NUM] = {"scalar", "avx2", "avx512"};
+static int impl = -1;
+
+static int best_impl(void) {
+    if (__builtin_cpu_supports("avx512f"))
+        return IMPL_AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return IMPL_AVX2;
+    return IMPL_SCALAR;
+}
+
+static int current_impl(void) {
+    if (impl < 0)
+        impl = best_impl();
+    return impl;
+}
+
+// 分类每个元素, cls 可以为 NULL (只要计数)
+void float_classify(const float* x, size_t n, uint8_t* cls,
+                    size_t counts[FC_NUM]) {
+    static void (*const fns[])(const float*, size_t, uint8_t*, size_t[]) = {
+        classify_scalar, classify_avx2, classify_avx512};
+    fns[current_impl()](x, n, cls, counts);
+}
+
+// 每个元素的 ilogbf
+void float_ilogb(const float* x, size_t n, int32_t* e) {
+    static void (*const fns[])(const float*, size_t, int32_t*) = {
+        ilogb_scalar, ilogb_avx2, ilogb_avx512};
+    fns[current_impl()](x, n, e);
+}
+
+// 按二进制指数分桶: hist[ilogb + 149], 覆盖非规格化数到最大规格化数
+// (-149..127); 0, Inf, NaN 不计入
+#define EXP_BUCKETS 277
+
+void float_exp_histogram(const float* x, size_t n, size_t hist[EXP_BUCKETS]) {
+    int32_t e[1024];
+    memset(hist, 0, EXP_BUCKETS * sizeof(size_t));
+    for (size_t i = 0; i < n; i += 1024) {
+        size_t m = n - i < 1024 ? n - i : 1024;
+        float_ilogb(x + i, m, e);
+        for (size_t j = 0; j < m; j++) {
+            if (e[j] != INT_MIN && e[j] != INT_MAX)
+                hist[e[j] + 149]++;
+        }
+    }
+}
+
+// 截断成 int (cvttps2dq), 越界和 NaN 得 INT_MIN
+void float_to_int_array(const float* x, size_t n, int32_t* out) {
+    static void (*const fns[])(const float*, size_t, int32_t*) = {
+        to_int_scalar, to_int_avx2, to_int_avx512};
+    fns[current_impl()](x, n, out);
+}
+
+void int_to_float_array(const int32_t* x, size_t n, float* out) {
+    static void (*const fns[])(const int32_t*, size_t, float*) = {
+        to_float_scalar, to_float_avx2, to_float_avx512};
+    fns[current_impl()](x, n, out);
+}
+
+// ---------------- 对比 ----------------
+
+#define N (16 << 20)
+#define REPS 5
+
+// 大部分是规格化数, 掺入约 1% 的 0, 非规格化数, Inf, NaN 和越界值
+static void make_input(float* x, size_t n) {
+    uint32_t s = 12345;
+    for (size_t i = 0; i < n; i++) {
+        s = s * 1103515245 + 12345;
+        uint32_t r = s >> 8;
+        switch (r % 400) {
+        case 0:
+            x[i] = 0.0f;
+            break;
+        case 1:
+            x[i] = 1e-40f * (r % 1000);
+            break;
+        case 2:
+            x[i] = (r & 1) ? INFINITY : -INFINITY;
+            break;
+        case 3:
+            x[i] = NAN;
+            break;
+        case 4:
+            x[i] = 3e9f;
+            break;
+        default:
+            x[i] = ((float)r / (1 << 24) - 0.5f) * (float)(1 << (r % 30));
+        }
+    }
+}
+
+int main(void) {
+    float* x = aligned_alloc(64, N * sizeof(float));
+    uint8_t* cls[IMPL_NUM];
+    int32_t* ints[IMPL_NUM];
+    int32_t* exps[IMPL_NUM];
+    float* back[IMPL_NUM];
+    size_t counts[IMPL_NUM][FC_NUM];
+    double t_cls[IMPL_NUM], t_exp[IMPL_NUM], t_int[IMPL_NUM], t_flt[IMPL_NUM];
+
+    make_input(x, N);
+    int top = best_impl();
+    printf("%d floats, best implementation: %s\n\n", N, impl_names[top]);
+
+    for (int k = 0; k <= top; k++) {
+        cls[k] = aligned_alloc(64, N);
+        ints[k] = aligned_alloc(64, N * sizeof(int32_t));
+        exps[k] = aligned_alloc(64, N * sizeof(int32_t));
+        back[k] = aligned_alloc(64, N * sizeof(float));
+        impl = k;
+        t_cls[k] = t_exp[k] = t_int[k] = t_flt[k] = 1e9;
+        for (int r = 0; r < REPS; r++) {
+            double t0 = now_sec();
+            float_classify(x, N, cls[k], counts[k]);
+            double t1 = now_sec();
+            float_ilogb(x, N, exps[k]);
+            double t2 = now_sec();
+            float_to_int_array(x, N, ints[k]);
+            double t3 = now_sec();
+            int_to_float_array(ints[k], N, back[k]);
+            double t4 = now_sec();
+            t_cls[k] = fmin(t_cls[k], t1 - t0);
+            t_exp[k] = fmin(t_exp[k], t2 - t1);
+            t_int[k] = fmin(t_int[k], t3 - t2);
+            t_flt[k] = fmin(t_flt[k], t4 - t3);
+        }
+    }
+
+    printf("%-14s", "ns/element");
+    for (int k = 0; k <= top; k++)
+        printf(" %10s", impl_names[k]);
+    printf("\n");
+    struct {
+        const char* name;
+        double* t;
+    } rows[] = {{"classify", t_cls},
+                {"ilogb", t_exp},
+                {"float->int", t_int},
+                {"int->float", t_flt}};
+    for (int r = 0; r < 4; r++) {
+        printf("%-14s", rows[r].name);
+        for (int k = 0; k <= top; k++)
+            printf(" %10.3f", rows[r].t[k] * 1e9 / N);
+        printf("\n");
+    }
+
+    // 所有实现的输出必须逐元素相同
+    int ok = 1;
+    for (int k = 1; k <= top; k++) {
+        ok &= memcmp(cls[k], cls[0], N) == 0;
+        ok &= memcmp(counts[k], counts[0], sizeof(counts[0])) == 0;
+        ok &= memcmp(exps[k], exps[0], N * sizeof(int32_t)) == 0;
+        ok &= memcmp(ints[k], ints[0], N * sizeof(int32_t)) == 0;
+        ok &= memcmp(back[k], back[0], N * sizeof(float)) == 0;
+    }
+    printf("\nresults %s\n", ok ? "identical" : "DIFFER");
+
+    printf("classes:");
+    for (int c = 0; c < FC_NUM; c++)
+        printf(" %s %zu", class_names[c], counts[0][c]);
+    printf("\n");
+
+    size_t hist[EXP_BUCKETS];
+    float_exp_histogram(x, N, hist);
+    printf("exponent buckets (ilogb: count):");
+    for (int b = 0; b < EXP_BUCKETS; b++) {
+        if (hist[b] > N / 50)
+            printf(" %d:%zu", b - 149, hist[b]);
+    }
+    printf(" ...\n");
+    return ok ? 0 : 1;
+}
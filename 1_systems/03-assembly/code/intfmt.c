@@ -0,0 +1,136 @@
+#include "intfmt.h"
+
+#include <string.h>
+
+// 10^k, k = 0..19
+static const uint64_t pow10_table[20] = {
+    1ull,
+    10ull,
+    100ull,
+    1000ull,
+    10000ull,
+    100000ull,
+    1000000ull,
+    10000000ull,
+    100000000ull,
+    1000000000ull,
+    10000000000ull,
+    100000000000ull,
+    1000000000000ull,
+    10000000000000ull,
+    100000000000000ull,
+    1000000000000000ull,
+    10000000000000000ull,
+    100000000000000000ull,
+    1000000000000000000ull,
+    10000000000000000000ull,
+};
+
+// 00 01 02 ... 99, 第 i 对字符就是 i 的两位十进制
+static const char digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+int u64_digits(uint64_t x) {
+    // x | 1 让 0 也有 1 个二进制位; t 是 floor(bits * log10(2)),
+    // 真实位数是 t 或 t + 1
+    int bits = 64 - __builtin_clzll(x | 1);
+    int t = (bits * 1233) >> 12;
+    return t + ((x | 1) >= pow10_table[t]);
+}
+
+int i64_len(int64_t x) {
+    // 取绝对值用无符号运算, INT64_MIN 不溢出
+    uint64_t u = x < 0 ? 0 - (uint64_t)x : (uint64_t)x;
+    return (x < 0) + u64_digits(u);
+}
+
+// 已知位数 n, 从 out + n 往前写
+static inline void write_digits(uint64_t x, int n, char* out) {
+    char* p = out + n;
+    while (x >= 100) {
+        uint64_t q = x / 100;
+        unsigned r = (unsigned)(x - q * 100);
+        x = q;
+        p -= 2;
+        memcpy(p, digit_pairs + 2 * r, 2);
+    }
+    if (x >= 10) {
+        p -= 2;
+        memcpy(p, digit_pairs + 2 * x, 2);
+    } else {
+        *--p = (char)('0' + x);
+    }
+}
+
+char* u64_format(uint64_t x, char* out) {
+    int n = u64_digits(x);
+    write_digits(x, n, out);
+    return out + n;
+}
+
+char* i64_format(int64_t x, char* out) {
+    uint64_t u = (uint64_t)x;
+    if (x < 0) {
+        *out++ = '-';
+        u = 0 - u;
+    }
+    return u64_format(u, out);
+}
+
+int i64_to_str(int64_t x, char* out) {
+    char* end = i64_format(x, out);
+    *end = '\0';
+    return (int)(end - out);
+}
+
+size_t i64_format_array(const int64_t* x, size_t n, char sep, char* buf) {
+    char* p = buf;
+    for (size_t i = 0; i < n; i++) {
+        p = i64_format(x[i], p);
+        *p++ = sep;
+    }
+    return p - buf;
+}
+
+// 32 位的商和余数用 32 位乘法就能算出, 比 64 位的快
+static inline char* u32_format(uint32_t x, char* out) {
+    int n = u64_digits(x);
+    char* p = out + n;
+    while (x >= 100) {
+        uint32_t q = x / 100;
+        unsigned r = x - q * 100;
+        x = q;
+        p -= 2;
+        memcpy(p, digit_pairs + 2 * r, 2);
+    }
+    if (x >= 10) {
+        p -= 2;
+        memcpy(p, digit_pairs + 2 * x, 2);
+    } else {
+        *--p = (char)('0' + x);
+    }
+    return out + n;
+}
+
+size_t i32_format_array(const int32_t* x, size_t n, char sep, char* buf) {
+    char* p = buf;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t u = (uint32_t)x[i];
+        if (x[i] < 0) {
+            *p++ = '-';
+            u = 0 - u;
+        }
+        p = u32_format(u, p);
+        *p++ = sep;
+    }
+    return p - buf;
+}
@@ -0,0 +1,44 @@
+#ifndef INTFMT_H
+#define INTFMT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * 整数转十进制字符串, 不经过 sprintf
+ *
+ * 位数: 用 clz 得到二进制位数, 乘 log10(2) ≈ 1233/4096 估出十进制位数,
+ * 再和 10 的幂表比较一次修正, 没有循环也没有除法。
+ * 输出: 已知位数后从末尾往前写, 每次用一张 "00".."99" 表写两位,
+ * 除法次数减半 (除以常数 100 会被编译成乘法和移位)。
+ */
+
+// 最长的输出: "-9223372036854775808" 20 字节, 或 UINT64_MAX 的 20 位
+#define INTFMT_MAX 20
+
+// 十进制位数, 0 算 1 位
+int u64_digits(uint64_t x);
+
+// 包括负号在内的字符数
+int i64_len(int64_t x);
+
+// 写入 out (至少 INTFMT_MAX 字节), 不写结尾的 '\0',
+// 返回写完后的位置
+char* u64_format(uint64_t x, char* out);
+char* i64_format(int64_t x, char* out);
+
+// 写入 out 并加 '\0' (至少 INTFMT_MAX + 1 字节), 返回长度
+int i64_to_str(int64_t x, char* out);
+
+/*
+ * 批量: 把 x[0..n) 依次写进一块连续缓冲区, 每个数后面跟 sep
+ * (例如 '\n' 或 ','), 不加 '\0'; 返回写入的字节数。
+ * buf 至少要 intfmt_bound(n) 字节
+ */
+static inline size_t intfmt_bound(size_t n) {
+    return n * (INTFMT_MAX + 1);
+}
+size_t i64_format_array(const int64_t* x, size_t n, char sep, char* buf);
+size_t i32_format_array(const int32_t* x, size_t n, char sep, char* buf);
+
+#endif
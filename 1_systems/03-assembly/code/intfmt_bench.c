@@ -0,0 +1,145 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "intfmt.h"
+
+// intfmt 和 sprintf 的对比: 先在边界值和随机数上核对输出完全一致,
+// 再比较单个转换、求位数以及整个数组写成一块文本的速度
+//
+// 编译: gcc -O2 intfmt.c intfmt_bench.c -o intfmt_bench
+
+#define N (10 << 20)
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint64_t rng = 88172645463325252ull;
+
+static uint64_t xorshift(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return rng;
+}
+
+// 位数均匀分布在 1..19 位, 一半是负数, 模拟日志里大小不一的数
+static int64_t random_value(void) {
+    uint64_t r = xorshift();
+    int64_t v = (int64_t)((r >> 8) % (uint64_t)INT64_MAX >> (r % 63));
+    return (r & 0x80) ? -v : v;
+}
+
+static int check_one(int64_t v) {
+    char a[32], b[32];
+    int la = sprintf(a, "%" PRId64, v);
+    int lb = i64_to_str(v, b);
+    if (la != lb || strcmp(a, b) != 0 || i64_len(v) != la) {
+        printf("mismatch for %s: got \"%s\" len %d\n", a, b, i64_len(v));
+        return 0;
+    }
+    return 1;
+}
+
+static int check(void) {
+    int ok = 1;
+    // 每个 10 的幂两侧, 10^0 .. 10^18
+    uint64_t p = 1;
+    for (int k = 0; k < 19; k++, p *= 10) {
+        for (int64_t d = -1; d <= 1; d++) {
+            ok &= check_one((int64_t)p + d);
+            ok &= check_one(-(int64_t)p - d);
+        }
+    }
+    ok &= check_one(INT64_MAX);
+    ok &= check_one(INT64_MIN);
+    ok &= check_one(INT64_MIN + 1);
+
+    char a[32], b[32];
+    uint64_t um = UINT64_MAX;
+    *u64_format(um, b) = '\0';
+    sprintf(a, "%" PRIu64, um);
+    ok &= strcmp(a, b) == 0 && u64_digits(um) == 20;
+
+    for (int i = 0; i < 1000000; i++)
+        ok &= check_one(random_value());
+    return ok;
+}
+
+int main(void) {
+    if (!check())
+        return 1;
+    printf("outputs match sprintf\n\n");
+
+    int64_t* x = malloc(N * sizeof(int64_t));
+    int32_t* y = malloc(N * sizeof(int32_t));
+    char* buf = malloc(intfmt_bound(N));
+    char* ref = malloc(intfmt_bound(N));
+    for (size_t i = 0; i < N; i++) {
+        x[i] = random_value();
+        y[i] = (int32_t)x[i];
+    }
+
+    // sprintf 逐个写进同一块缓冲区
+    double t0 = now_sec();
+    char* p = ref;
+    for (size_t i = 0; i < N; i++) {
+        p += sprintf(p, "%" PRId64, x[i]);
+        *p++ = '\n';
+    }
+    size_t ref_len = p - ref;
+    double t_sprintf = now_sec() - t0;
+
+    t0 = now_sec();
+    size_t len = i64_format_array(x, N, '\n', buf);
+    double t_batch = now_sec() - t0;
+    int same64 = len == ref_len && memcmp(buf, ref, len) == 0;
+
+    // 位数: 原来的 intlen 是 sprintf 再 strlen
+    t0 = now_sec();
+    size_t sum_ref = 0;
+    for (size_t i = 0; i < N; i++) {
+        char tmp[32];
+        sprintf(tmp, "%" PRId64, x[i]);
+        sum_ref += strlen(tmp);
+    }
+    double t_len_sprintf = now_sec() - t0;
+
+    t0 = now_sec();
+    size_t sum = 0;
+    for (size_t i = 0; i < N; i++)
+        sum += i64_len(x[i]);
+    double t_len = now_sec() - t0;
+
+    t0 = now_sec();
+    p = ref;
+    for (size_t i = 0; i < N; i++) {
+        p += sprintf(p, "%" PRId32, y[i]);
+        *p++ = ',';
+    }
+    ref_len = p - ref;
+    double t_sprintf32 = now_sec() - t0;
+
+    t0 = now_sec();
+    len = i32_format_array(y, N, ',', buf);
+    double t_batch32 = now_sec() - t0;
+    int same32 = len == ref_len && memcmp(buf, ref, len) == 0;
+
+    printf("%-22s %10s %10s %8s\n", "", "sprintf", "intfmt", "speedup");
+    printf("%-22s %10.1f %10.1f %7.1fx\n", "int64 array (ns/num)",
+           t_sprintf * 1e9 / N, t_batch * 1e9 / N, t_sprintf / t_batch);
+    printf("%-22s %10.1f %10.1f %7.1fx\n", "int32 array (ns/num)",
+           t_sprintf32 * 1e9 / N, t_batch32 * 1e9 / N,
+           t_sprintf32 / t_batch32);
+    printf("%-22s %10.1f %10.1f %7.1fx\n", "length (ns/num)",
+           t_len_sprintf * 1e9 / N, t_len * 1e9 / N, t_len_sprintf / t_len);
+    printf("\nbatch output %s, lengths %s\n",
+           same64 && same32 ? "identical" : "DIFFER",
+           sum == sum_ref ? "identical" : "DIFFER");
+    return same64 && same32 && sum == sum_ref ? 0 : 1;
+}
@@ -0,0 +1,242 @@
+#ifndef AGGREGATE_HPP
+#define AGGREGATE_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <immintrin.h>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "vec.hpp"
+
+// Sum, min and max of a Vector kept up to date under point updates, so a
+// few thousand writes into a large vector do not cost a full combine pass.
+//
+// The vector is cut into leaf blocks of AGG_BLOCK elements (several cache
+// lines), each summarized by an AVX2 pass when it changes. A bottom-up
+// segment tree over the block summaries, stored as an implicit array,
+// gives the whole-vector result at the root. Costs:
+//   total()            O(1), the root
+//   set() / refresh()  one block pass plus log2(n / AGG_BLOCK) nodes
+//   apply(batch)       each dirty block and tree node recomputed once
+//   query(lo, hi)      the two partial end blocks plus O(log n) nodes
+// Like combine6 the block pass uses several accumulators, so float sums
+// may differ from a sequential sum in the last bits; sums are of type T and
+// wrap or lose precision the same way combineN does.
+
+#define AGG_BLOCK 64
+
+template <typename T>
+struct Aggregate {
+    T sum, min, max;
+
+    // What an empty range reduces to; +-infinity for floating types, so
+    // that infinities survive min and max
+    static Aggregate identity() { return {T(0), top(), bottom()}; }
+
+    Aggregate merge(const Aggregate& o) const {
+        return {sum + o.sum, std::min(min, o.min), std::max(max, o.max)};
+    }
+
+    using limits = std::numeric_limits<T>;
+    static constexpr T top() {
+        return limits::has_infinity ? limits::infinity() : limits::max();
+    }
+    static constexpr T bottom() {
+        return limits::has_infinity ? -limits::infinity() : limits::lowest();
+    }
+};
+
+namespace agg_detail {
+
+template <typename T>
+Aggregate<T> scan_scalar(const T* p, size_t n) {
+    // Two independent chains of each, as in combine6
+    Aggregate<T> a = Aggregate<T>::identity(), b = a;
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        a = a.merge({p[i], p[i], p[i]});
+        b = b.merge({p[i + 1], p[i + 1], p[i + 1]});
+    }
+    if (i < n)
+        a = a.merge({p[i], p[i], p[i]});
+    return a.merge(b);
+}
+
+__attribute__((target("avx2"))) inline Aggregate<int32_t>
+scan_avx2(const int32_t* p, size_t n) {
+    __m256i sum = _mm256_setzero_si256();
+    __m256i lo = _mm256_set1_epi32(std::numeric_limits<int32_t>::max());
+    __m256i hi = _mm256_set1_epi32(std::numeric_limits<int32_t>::min());
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        sum = _mm256_add_epi32(sum, x);
+        lo = _mm256_min_epi32(lo, x);
+        hi = _mm256_max_epi32(hi, x);
+    }
+    int32_t s[8], l[8], h[8];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(s), sum);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(l), lo);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(h), hi);
+    Aggregate<int32_t> a = scan_scalar(p + i, n - i);
+    for (int k = 0; k < 8; k++)
+        a = a.merge({s[k], l[k], h[k]});
+    return a;
+}
+
+__attribute__((target("avx2"))) inline Aggregate<float>
+scan_avx2(const float* p, size_t n) {
+    __m256 sum = _mm256_setzero_ps();
+    __m256 lo = _mm256_set1_ps(Aggregate<float>::top());
+    __m256 hi = _mm256_set1_ps(Aggregate<float>::bottom());
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 x = _mm256_loadu_ps(p + i);
+        sum = _mm256_add_ps(sum, x);
+        lo = _mm256_min_ps(lo, x);
+        hi = _mm256_max_ps(hi, x);
+    }
+    float s[8], l[8], h[8];
+    _mm256_storeu_ps(s, sum);
+    _mm256_storeu_ps(l, lo);
+    _mm256_storeu_ps(h, hi);
+    Aggregate<float> a = scan_scalar(p + i, n - i);
+    for (int k = 0; k < 8; k++)
+        a = a.merge({s[k], l[k], h[k]});
+    return a;
+}
+
+template <typename T>
+inline constexpr bool has_simd =
+    std::is_same_v<T, int32_t> || std::is_same_v<T, float>;
+
+// Aggregate of p[0 .. n)
+template <typename T>
+Aggregate<T> scan(const T* p, size_t n) {
+    if constexpr (has_simd<T>) {
+        static const bool avx2 = __builtin_cpu_supports("avx2");
+        if (avx2)
+            return scan_avx2(p, n);
+    }
+    return scan_scalar(p, n);
+}
+
+} // namespace agg_detail
+
+template <typename T>
+class AggregateIndex {
+private:
+    Vector<T>& v;
+    size_t blocks; // ceil(length / AGG_BLOCK)
+    size_t leaves; // blocks rounded up to a power of two
+    // tree[1] is the root, node k has children 2k and 2k+1, block b is
+    // leaf tree[leaves + b]; padding leaves hold the identity
+    std::vector<Aggregate<T>> tree;
+    std::vector<size_t> dirty; // scratch for apply()
+
+    Aggregate<T> scan_block(size_t b) const {
+        size_t lo = b * AGG_BLOCK;
+        size_t n = std::min<size_t>(AGG_BLOCK, v.length() - lo);
+        return agg_detail::scan(v.get_start() + lo, n);
+    }
+
+    void pull(size_t k) { tree[k] = tree[2 * k].merge(tree[2 * k + 1]); }
+
+public:
+    // Builds the index over v in one pass. v must outlive the index, and
+    // writes to v have to go through set() or be followed by refresh().
+    explicit AggregateIndex(Vector<T>& v) : v(v) { rebuild(); }
+
+    // Recompute everything, e.g. after bulk writes to the vector
+    void rebuild() {
+        blocks = (v.length() + AGG_BLOCK - 1) / AGG_BLOCK;
+        leaves = 1;
+        while (leaves < blocks)
+            leaves *= 2;
+        tree.assign(2 * leaves, Aggregate<T>::identity());
+        for (size_t b = 0; b < blocks; b++)
+            tree[leaves + b] = scan_block(b);
+        for (size_t k = leaves - 1; k >= 1; k--)
+            pull(k);
+    }
+
+    // v[i] = x
+    void set(size_t i, T x) {
+        v[i] = x;
+        refresh(i);
+    }
+
+    // v[i] was written directly
+    void refresh(size_t i) {
+        size_t b = i / AGG_BLOCK;
+        tree[leaves + b] = scan_block(b);
+        for (size_t k = (leaves + b) / 2; k >= 1; k /= 2)
+            pull(k);
+    }
+
+    // v[idx[j]] = val[j] for j < k, then each changed block and each tree
+    // node above them is recomputed once; later writes to the same index win
+    void apply(const size_t* idx, const T* val, size_t k) {
+        for (size_t j = 0; j < k; j++)
+            v[idx[j]] = val[j];
+        refresh(idx, k);
+    }
+
+    // v[idx[j]] for j < k were written directly
+    void refresh(const size_t* idx, size_t k) {
+        if (k == 0)
+            return;
+        dirty.resize(k);
+        for (size_t j = 0; j < k; j++)
+            dirty[j] = idx[j] / AGG_BLOCK;
+        std::sort(dirty.begin(), dirty.end());
+        dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+        for (size_t& b : dirty) {
+            tree[leaves + b] = scan_block(b);
+            b = leaves + b;
+        }
+        // Sorted node numbers stay sorted when halved, so each level is
+        // deduplicated by dropping adjacent repeats
+        while (dirty[0] > 1) {
+            size_t m = 0;
+            for (size_t node : dirty) {
+                size_t parent = node / 2;
+                if (m == 0 || dirty[m - 1] != parent)
+                    dirty[m++] = parent;
+            }
+            dirty.resize(m);
+            for (size_t node : dirty)
+                pull(node);
+        }
+    }
+
+    // The whole vector
+    const Aggregate<T>& total() const { return tree[1]; }
+
+    // v[lo .. hi), clamped to the vector
+    Aggregate<T> query(size_t lo, size_t hi) const {
+        hi = std::min(hi, v.length());
+        if (lo >= hi)
+            return Aggregate<T>::identity();
+        const T* data = v.get_start();
+        size_t bl = (lo + AGG_BLOCK - 1) / AGG_BLOCK; // first whole block
+        size_t br = hi / AGG_BLOCK;                   // end of whole blocks
+        if (bl >= br)
+            return agg_detail::scan(data + lo, hi - lo);
+
+        Aggregate<T> res = agg_detail::scan(data + lo, bl * AGG_BLOCK - lo);
+        res = res.merge(agg_detail::scan(data + br * AGG_BLOCK,
+                                         hi - br * AGG_BLOCK));
+        for (size_t l = bl + leaves, r = br + leaves; l < r; l /= 2, r /= 2) {
+            if (l & 1)
+                res = res.merge(tree[l++]);
+            if (r & 1)
+                res = res.merge(tree[--r]);
+        }
+        return res;
+    }
+};
+
+#endif
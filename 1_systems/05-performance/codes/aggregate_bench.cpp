@@ -0,0 +1,158 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+
+#include "aggregate.hpp"
+
+// Dashboard workload: each tick writes k random elements of a large vector
+// and re-reads the sum, min and max. Compares rerunning combine6 plus a
+// min/max pass after every tick with the incremental index (one point
+// update at a time, and the whole tick as a batch), then times random range
+// queries against scanning the range. All answers are checked against the
+// full recomputation.
+//
+// Build: g++ -std=c++20 -O2 aggregate_bench.cpp -o aggregate_bench
+// Usage: ./aggregate_bench [elems] [updates per tick]
+
+static double now_sec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Min and max of v[lo .. hi) by a plain scan
+template <typename T>
+static Aggregate<T> full_pass(const Vector<T>& v, size_t lo, size_t hi) {
+    Aggregate<T> a = Aggregate<T>::identity();
+    const T* data = v.get_start();
+    for (size_t i = lo; i < hi; i++) {
+        a.min = std::min(a.min, data[i]);
+        a.max = std::max(a.max, data[i]);
+    }
+    return a;
+}
+
+// What a caller has without the index: combine6 for the sum and a second
+// pass for min and max
+template <typename T>
+static Aggregate<T> full_combine(const Vector<T>& v) {
+    Aggregate<T> a = full_pass(v, 0, v.length());
+    combine6(v, a.sum, '+');
+    return a;
+}
+
+template <typename T>
+static bool same(const Aggregate<T>& a, const Aggregate<T>& b) {
+    if constexpr (std::is_integral_v<T>)
+        return a.sum == b.sum && a.min == b.min && a.max == b.max;
+    else
+        return std::fabs(a.sum - b.sum) <= 1e-3 * std::fabs(b.sum) + 1e-2 &&
+               a.min == b.min && a.max == b.max;
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? strtoul(argv[1], nullptr, 10) : 100000000;
+    size_t k = argc > 2 ? strtoul(argv[2], nullptr, 10) : 4096;
+    const int ticks = 10;
+    std::mt19937_64 rng(42);
+    bool ok = true;
+
+    // Values small enough that an int32 sum of the whole vector is exact
+    Vector<int> v(n, no_init);
+    for (size_t i = 0; i < n; i++)
+        v[i] = int(rng() % 16);
+
+    double t0 = now_sec();
+    AggregateIndex<int> index(v);
+    double t_build = now_sec() - t0;
+    t0 = now_sec();
+    Aggregate<int> ref = full_combine(v);
+    double t_full = now_sec() - t0;
+    ok &= same(index.total(), ref);
+    printf("%zu elements: build %.1f ms, one full combine %.1f ms\n", n,
+           t_build * 1e3, t_full * 1e3);
+
+    std::vector<size_t> idx(k);
+    std::vector<int> val(k);
+    double t_point = 0, t_batch = 0, t_rescan = 0;
+    for (int tick = 0; tick < ticks; tick++) {
+        for (size_t j = 0; j < k; j++) {
+            idx[j] = rng() % n;
+            val[j] = int(rng() % 16);
+        }
+        // Point updates, then the same values again as one batch
+        t0 = now_sec();
+        for (size_t j = 0; j < k; j++)
+            index.set(idx[j], val[j]);
+        Aggregate<int> a = index.total();
+        t_point += now_sec() - t0;
+        ok &= same(a, full_combine(v));
+
+        for (size_t j = 0; j < k; j++)
+            val[j] = int(rng() % 16);
+        t0 = now_sec();
+        index.apply(idx.data(), val.data(), k);
+        Aggregate<int> b = index.total();
+        t_batch += now_sec() - t0;
+
+        t0 = now_sec();
+        ref = full_combine(v);
+        t_rescan += now_sec() - t0;
+        ok &= same(b, ref);
+    }
+    printf("\n%zu updates per tick, ms per tick\n", k);
+    printf("%-28s %10.3f\n", "full combine after writes",
+           t_rescan / ticks * 1e3);
+    printf("%-28s %10.3f\n", "index, point updates", t_point / ticks * 1e3);
+    printf("%-28s %10.3f\n", "index, batched", t_batch / ticks * 1e3);
+
+    printf("\nrandom range queries, us per query\n");
+    printf("%12s %10s %10s\n", "range", "scan", "index");
+    for (size_t len = 100; len <= n; len *= 100) {
+        const int q = len >= 10000000 ? 5 : 200;
+        double t_scan = 0, t_index = 0;
+        for (int r = 0; r < q; r++) {
+            size_t lo = rng() % (n - len + 1);
+            t0 = now_sec();
+            Aggregate<int> s = full_pass(v, lo, lo + len);
+            s.sum = 0;
+            for (size_t i = lo; i < lo + len; i++)
+                s.sum += v[i];
+            t_scan += now_sec() - t0;
+            t0 = now_sec();
+            Aggregate<int> x = index.query(lo, lo + len);
+            t_index += now_sec() - t0;
+            ok &= same(x, s);
+        }
+        printf("%12zu %10.2f %10.3f\n", len, t_scan / q * 1e6,
+               t_index / q * 1e6);
+    }
+
+    // Small float vectors: partial blocks, ranges inside one block and
+    // across many, batches with repeated indices
+    for (size_t m : {0, 1, 63, 64, 65, 1000}) {
+        Vector<float> f(m);
+        f.fill_random(-1.0f, 1.0f);
+        AggregateIndex<float> fi(f);
+        ok &= same(fi.total(), full_combine(f));
+        for (size_t j = 0; j < 3 * m; j++) {
+            size_t at[2] = {rng() % m, rng() % m};
+            float x[2] = {float(rng() % 100) - 50, float(rng() % 100)};
+            fi.apply(at, x, 2);
+        }
+        ok &= same(fi.total(), full_combine(f));
+        for (size_t lo = 0; lo <= m; lo += 7)
+            for (size_t hi = lo; hi <= m; hi += 13) {
+                Aggregate<float> s = full_pass(f, lo, hi);
+                s.sum = 0;
+                for (size_t i = lo; i < hi; i++)
+                    s.sum += f[i];
+                ok &= same(fi.query(lo, hi), s);
+            }
+    }
+
+    printf("results %s\n", ok ? "agree" : "DIFFER");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,344 @@
+#ifndef APPEND_LOG_HPP
+#define APPEND_LOG_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <thread>
+
+#include "vec.hpp"
+
+// Append-only log of T written by many producer threads and reduced
+// concurrently, chunk by chunk, by a background thread.
+//
+// Storage is a sequence of fixed-size chunks, each a Vector<T>, so the
+// combine kernels run on them unchanged. Producers share no lock and no
+// cache line: each thread appends through its own Writer, which reserves a
+// whole block (APPEND_LOG_BLOCK bytes, cache-line aligned) with a single
+// fetch_add and fills it with plain stores. When a block is full, or the
+// Writer is closed, the block is committed to its chunk, and a chunk whose
+// slots are all committed is sealed. The watermark is the end of the longest
+// prefix of sealed chunks; it is published with release semantics, so
+// everything below it can be read without further synchronization.
+//
+// Slots a Writer reserved but never used (the rest of its last block) and
+// the tail of the last chunk after close() hold the fill value. Pass the
+// identity of the op the log will be reduced with (0 for '+', 1 for '*').
+
+#define APPEND_LOG_BLOCK 4096
+#define APPEND_LOG_LINE 64
+
+// Forwards to upstream with at least cache-line alignment, so blocks start
+// on a line boundary and two producers never write the same line
+class LineAligned : public std::pmr::memory_resource {
+private:
+    std::pmr::memory_resource* upstream;
+
+    static size_t line_align(size_t align) {
+        return std::max<size_t>(align, APPEND_LOG_LINE);
+    }
+
+protected:
+    void* do_allocate(size_t bytes, size_t align) override {
+        return upstream->allocate(bytes, line_align(align));
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t align) override {
+        upstream->deallocate(p, bytes, line_align(align));
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const
+        noexcept override {
+        return this == &other;
+    }
+
+public:
+    explicit LineAligned(std::pmr::memory_resource* upstream =
+                             std::pmr::get_default_resource())
+        : upstream(upstream) {}
+};
+
+template <typename T>
+class AppendLog {
+private:
+    struct Chunk {
+        Vector<T> data;
+        alignas(APPEND_LOG_LINE) std::atomic<size_t> committed{0};
+
+        Chunk(size_t n, std::pmr::memory_resource* mr)
+            : data(n, no_init, mr) {}
+    };
+
+    const size_t block_elems;
+    const size_t chunk_elems; // a multiple of block_elems
+    const size_t max_chunks;
+    const T fill;
+    LineAligned aligned;
+    std::unique_ptr<std::atomic<Chunk*>[]> dir;
+
+    // Each counter on its own line: producers hit reserved once per block,
+    // the reducer polls sealed
+    alignas(APPEND_LOG_LINE) std::atomic<size_t> reserved{0};
+    alignas(APPEND_LOG_LINE) std::atomic<size_t> sealed{0};
+    alignas(APPEND_LOG_LINE) std::atomic<size_t> appended{0};
+
+    // Chunk i, allocated by whichever producer reserves in it first; a
+    // producer that loses the race frees its copy
+    Chunk* get_chunk(size_t i) {
+        Chunk* c = dir[i].load(std::memory_order_acquire);
+        if (c)
+            return c;
+        Chunk* fresh = new Chunk(chunk_elems, &aligned);
+        if (dir[i].compare_exchange_strong(c, fresh,
+                                           std::memory_order_acq_rel))
+            return fresh;
+        delete fresh;
+        return c;
+    }
+
+    // One block of slots [start, start + block_elems); blocks never cross a
+    // chunk boundary because chunk_elems is a multiple of block_elems. A CAS
+    // rather than fetch_add, so that a full log leaves reserved at its
+    // capacity instead of past the end of the directory.
+    T* reserve(size_t& start) {
+        start = reserved.load(std::memory_order_relaxed);
+        do {
+            if (start / chunk_elems >= max_chunks)
+                throw std::length_error("AppendLog: capacity exceeded");
+        } while (!reserved.compare_exchange_weak(start, start + block_elems,
+                                                 std::memory_order_relaxed));
+        return get_chunk(start / chunk_elems)->data.get_start() +
+               start % chunk_elems;
+    }
+
+    // The committed counters use sequentially consistent operations: the
+    // producer sealing chunk i and the one sealing chunk i - 1 must not both
+    // miss the other's commit, or the watermark would stall between them
+    void commit(size_t start, size_t n) {
+        Chunk* c = dir[start / chunk_elems].load(std::memory_order_acquire);
+        if (c->committed.fetch_add(n) + n == chunk_elems)
+            advance();
+    }
+
+    // Move the watermark over every sealed chunk after it. Racing threads
+    // only retry the CAS, nobody waits for anybody
+    void advance() {
+        size_t w = sealed.load(std::memory_order_acquire);
+        for (;;) {
+            size_t i = w / chunk_elems;
+            if (i >= max_chunks)
+                return;
+            Chunk* c = dir[i].load(std::memory_order_acquire);
+            if (!c || c->committed.load() != chunk_elems)
+                return;
+            if (sealed.compare_exchange_weak(w, w + chunk_elems,
+                                             std::memory_order_acq_rel,
+                                             std::memory_order_acquire))
+                w += chunk_elems;
+        }
+    }
+
+public:
+    // Per-thread append handle; not thread-safe itself, one per producer
+    class Writer {
+    private:
+        AppendLog* log;
+        T* pos = nullptr; // next free slot of the current block
+        T* end = nullptr; // end of the current block
+        size_t start = 0; // log index of the current block
+
+        void refill() {
+            close();
+            pos = log->reserve(start);
+            end = pos + log->block_elems;
+        }
+
+    public:
+        explicit Writer(AppendLog& log) : log(&log) {}
+
+        Writer(Writer&& other) noexcept
+            : log(other.log), pos(other.pos), end(other.end),
+              start(other.start) {
+            other.pos = other.end = nullptr;
+        }
+
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+        Writer& operator=(Writer&&) = delete;
+
+        ~Writer() { close(); }
+
+        void append(T x) {
+            if (pos == end)
+                refill();
+            *pos++ = x;
+        }
+
+        // Commit the current block, padding its unused slots with the fill
+        // value. The next append() reserves a new block.
+        void close() {
+            if (!pos)
+                return;
+            size_t unused = end - pos;
+            std::fill(pos, end, log->fill);
+            log->appended.fetch_add(log->block_elems - unused,
+                                    std::memory_order_relaxed);
+            log->commit(start, log->block_elems);
+            pos = end = nullptr;
+        }
+    };
+
+    // Room for max_chunks * chunk_elems slots; chunk_elems is rounded up to
+    // a whole number of blocks
+    explicit AppendLog(
+        T fill = T(), size_t chunk_elems = 1 << 16, size_t max_chunks = 1 << 16,
+        std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+        : block_elems(std::max<size_t>(1, APPEND_LOG_BLOCK / sizeof(T))),
+          chunk_elems((std::max<size_t>(chunk_elems, 1) + block_elems - 1) /
+                      block_elems * block_elems),
+          max_chunks(max_chunks), fill(fill), aligned(mr),
+          dir(new std::atomic<Chunk*>[max_chunks]) {
+        for (size_t i = 0; i < max_chunks; i++)
+            dir[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    AppendLog(const AppendLog&) = delete;
+    AppendLog& operator=(const AppendLog&) = delete;
+
+    ~AppendLog() {
+        for (size_t i = 0; i < max_chunks; i++)
+            delete dir[i].load(std::memory_order_relaxed);
+    }
+
+    Writer writer() { return Writer(*this); }
+
+    // Fill the rest of the partly reserved last chunk so that it seals too.
+    // Call after every Writer is closed; appends may continue afterwards and
+    // start in a new chunk.
+    void close() {
+        size_t r = reserved.load(std::memory_order_relaxed);
+        size_t tail;
+        do {
+            tail = (r + chunk_elems - 1) / chunk_elems * chunk_elems;
+            if (tail == r)
+                return;
+        } while (!reserved.compare_exchange_weak(r, tail,
+                                                 std::memory_order_relaxed));
+        T* p = get_chunk(r / chunk_elems)->data.get_start() + r % chunk_elems;
+        std::fill(p, p + (tail - r), fill);
+        commit(r, tail - r);
+    }
+
+    // Slots below the watermark are sealed and may be read by any thread
+    size_t watermark() const { return sealed.load(std::memory_order_acquire); }
+
+    // Values appended by Writers so far (committed blocks only, no fill)
+    size_t size() const { return appended.load(std::memory_order_relaxed); }
+
+    size_t chunk_size() const { return chunk_elems; }
+    size_t block_size() const { return block_elems; }
+
+    // Sealed chunk i, i < watermark() / chunk_size()
+    const Vector<T>& chunk(size_t i) const {
+        return dir[i].load(std::memory_order_acquire)->data;
+    }
+};
+
+// Background thread that combines newly sealed chunks of a log as they
+// appear and keeps a running result
+template <typename T>
+class LogReducer {
+public:
+    struct Result {
+        T value;
+        size_t slots; // log slots reduced so far, fill included
+    };
+
+private:
+    const AppendLog<T>& log;
+    const char op;
+    CombineFunction<T> kernel;
+    std::chrono::microseconds poll;
+
+    // Seqlock around the running result: odd while it is being updated
+    std::atomic<unsigned> seq{0};
+    std::atomic<T> value;
+    std::atomic<size_t> slots{0};
+
+    std::atomic<bool> stopping{false};
+    std::thread thread;
+
+    void publish(T v, size_t n) {
+        unsigned s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        value.store(v, std::memory_order_relaxed);
+        slots.store(n, std::memory_order_relaxed);
+        seq.store(s + 2, std::memory_order_release);
+    }
+
+    void run() {
+        size_t cs = log.chunk_size();
+        size_t next = 0;
+        T acc = (op == '+') ? T(0) : T(1);
+        for (;;) {
+            // Read the flag before the watermark: after stop() one more
+            // pass sees everything sealed before it was called
+            bool last = stopping.load(std::memory_order_acquire);
+            size_t w = log.watermark();
+            if (next == w) {
+                if (last)
+                    return;
+                std::this_thread::sleep_for(poll);
+                continue;
+            }
+            for (; next < w; next += cs) {
+                T part;
+                kernel(log.chunk(next / cs), part, op);
+                acc = (op == '*') ? acc * part : acc + part;
+                publish(acc, next + cs);
+            }
+        }
+    }
+
+public:
+    LogReducer(const AppendLog<T>& log, char op,
+               CombineFunction<T> kernel = combine6<T>,
+               std::chrono::microseconds poll = std::chrono::microseconds(100))
+        : log(log), op(op), kernel(std::move(kernel)), poll(poll),
+          value((op == '+') ? T(0) : T(1)), thread([this] { run(); }) {}
+
+    LogReducer(const LogReducer&) = delete;
+    LogReducer& operator=(const LogReducer&) = delete;
+
+    ~LogReducer() { stop(); }
+
+    // Consistent snapshot of the running result
+    Result result() const {
+        for (;;) {
+            unsigned s1 = seq.load(std::memory_order_acquire);
+            if (s1 & 1)
+                continue;
+            T v = value.load(std::memory_order_relaxed);
+            size_t n = slots.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq.load(std::memory_order_relaxed) == s1)
+                return {v, n};
+        }
+    }
+
+    // Reduce what is sealed now, then end the thread. Call log.close()
+    // first to include the partial last chunk.
+    Result stop() {
+        stopping.store(true, std::memory_order_release);
+        if (thread.joinable())
+            thread.join();
+        return result();
+    }
+};
+
+#endif
@@ -0,0 +1,135 @@
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "append_log.hpp"
+
+// Producer throughput of the append log against a mutex-protected
+// std::vector as the thread count grows, with and without a reducer
+// summing sealed chunks in the background; every run checks the final sum.
+//
+// Build: g++ -std=c++20 -O2 -pthread append_log_bench.cpp -o append_log_bench
+// Usage: ./append_log_bench [values] [max threads]
+
+static double now_sec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Thread t of nthreads produces values i = t, t + nthreads, ... < n
+static long value_of(size_t i) {
+    return long(i % 7);
+}
+
+static long expected_sum(size_t n) {
+    long sum = 0;
+    for (size_t i = 0; i < n; i++)
+        sum += value_of(i);
+    return sum;
+}
+
+template <typename F>
+static double run_threads(unsigned nthreads, F body) {
+    std::vector<std::thread> threads;
+    double t0 = now_sec();
+    for (unsigned t = 0; t < nthreads; t++)
+        threads.emplace_back(body, t);
+    for (auto& th : threads)
+        th.join();
+    return now_sec() - t0;
+}
+
+static double mutex_vector(size_t n, unsigned nthreads, long& sum) {
+    std::vector<long> v;
+    std::mutex m;
+    double t = run_threads(nthreads, [&](unsigned id) {
+        for (size_t i = id; i < n; i += nthreads) {
+            std::lock_guard<std::mutex> lock(m);
+            v.push_back(value_of(i));
+        }
+    });
+    sum = 0;
+    for (long x : v)
+        sum += x;
+    return t;
+}
+
+// Producers only; the log is summed after they finish
+static double log_only(size_t n, unsigned nthreads, long& sum) {
+    AppendLog<long> log(0);
+    double t = run_threads(nthreads, [&](unsigned id) {
+        auto w = log.writer();
+        for (size_t i = id; i < n; i += nthreads)
+            w.append(value_of(i));
+    });
+    log.close();
+    sum = 0;
+    for (size_t c = 0; c < log.watermark() / log.chunk_size(); c++) {
+        long part;
+        combine6(log.chunk(c), part, '+');
+        sum += part;
+    }
+    return t;
+}
+
+// Producers with the reducer running alongside them. Returns the time until
+// the final result is available and how much was already reduced when the
+// producers finished.
+static double log_reduced(size_t n, unsigned nthreads, long& sum,
+                          double& early) {
+    AppendLog<long> log(0);
+    LogReducer<long> reducer(log, '+');
+    double t0 = now_sec();
+    run_threads(nthreads, [&](unsigned id) {
+        auto w = log.writer();
+        for (size_t i = id; i < n; i += nthreads)
+            w.append(value_of(i));
+    });
+    early = double(reducer.result().slots) / n;
+    log.close();
+    sum = reducer.stop().value;
+    return now_sec() - t0;
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1 << 24;
+    unsigned max_threads = argc > 2 ? atoi(argv[2]) : 8;
+    long want = expected_sum(n);
+    bool ok = true;
+
+    printf("%zu values, M appends/s (hardware threads: %u)\n", n,
+           std::thread::hardware_concurrency());
+    printf("%8s %12s %12s %12s %10s\n", "threads", "mutex+vec", "log",
+           "log+reduce", "reduced");
+    for (unsigned t = 1; t <= max_threads; t *= 2) {
+        long s1, s2, s3;
+        double early;
+        double t1 = mutex_vector(n, t, s1);
+        double t2 = log_only(n, t, s2);
+        double t3 = log_reduced(n, t, s3, early);
+        ok &= s1 == want && s2 == want && s3 == want;
+        printf("%8u %12.1f %12.1f %12.1f %9.0f%%\n", t, n / t1 * 1e-6,
+               n / t2 * 1e-6, n / t3 * 1e-6, early * 100);
+    }
+
+    // Small logs: partial blocks from every writer and a partial last chunk
+    for (size_t small : {0, 1, 511, 512, 513, 100000}) {
+        AppendLog<long> log(0, 1024);
+        LogReducer<long> reducer(log, '+');
+        run_threads(3, [&](unsigned id) {
+            auto w = log.writer();
+            for (size_t i = id; i < small; i += 3)
+                w.append(value_of(i));
+        });
+        log.close();
+        ok &= reducer.stop().value == expected_sum(small) &&
+              log.size() == small;
+    }
+
+    printf("results %s\n", ok ? "agree" : "DIFFER");
+    return ok ? 0 : 1;
+}
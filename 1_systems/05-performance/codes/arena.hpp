@@ -0,0 +1,104 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+// Bump-pointer arena for short-lived Vector temporaries.
+//
+// Allocation advances a pointer inside the current chunk, deallocation is a
+// no-op, and reset() rewinds to the first chunk in O(1) while keeping every
+// chunk for the next request. Not thread-safe: use one arena per thread.
+class Arena : public std::pmr::memory_resource {
+private:
+    struct Chunk {
+        Chunk* next;
+        size_t size; // usable bytes after the header
+    };
+
+    std::pmr::memory_resource* upstream;
+    size_t chunk_size;
+    Chunk* head = nullptr;    // first chunk, where reset() rewinds to
+    Chunk* current = nullptr; // chunk being bumped
+    char* ptr = nullptr;      // next free byte in current
+    char* end = nullptr;      // end of current
+
+    static char* chunk_begin(Chunk* c) {
+        return reinterpret_cast<char*>(c) + sizeof(Chunk);
+    }
+
+    Chunk* new_chunk(size_t min_size) {
+        size_t size = min_size > chunk_size ? min_size : chunk_size;
+        void* mem = upstream->allocate(sizeof(Chunk) + size, alignof(Chunk));
+        return ::new (mem) Chunk{nullptr, size};
+    }
+
+    void enter(Chunk* c) {
+        current = c;
+        ptr = chunk_begin(c);
+        end = ptr + c->size;
+    }
+
+    // Move to the next retained chunk, or link in a new one that fits
+    void advance(size_t bytes, size_t align) {
+        size_t need = bytes + align;
+        if (current && current->next && current->next->size >= need) {
+            enter(current->next);
+            return;
+        }
+        Chunk* c = new_chunk(need);
+        if (!head) {
+            head = c;
+        } else {
+            c->next = current->next;
+            current->next = c;
+        }
+        enter(c);
+    }
+
+protected:
+    void* do_allocate(size_t bytes, size_t align) override {
+        for (;;) {
+            uintptr_t p = reinterpret_cast<uintptr_t>(ptr);
+            uintptr_t aligned = (p + align - 1) & ~(uintptr_t)(align - 1);
+            if (ptr && aligned + bytes <= reinterpret_cast<uintptr_t>(end)) {
+                ptr = reinterpret_cast<char*>(aligned + bytes);
+                return reinterpret_cast<void*>(aligned);
+            }
+            advance(bytes, align);
+        }
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const
+        noexcept override {
+        return this == &other;
+    }
+
+public:
+    explicit Arena(size_t chunk_size = 1 << 20,
+                   std::pmr::memory_resource* upstream =
+                       std::pmr::new_delete_resource())
+        : upstream(upstream), chunk_size(chunk_size) {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    ~Arena() override {
+        for (Chunk* c = head; c;) {
+            Chunk* next = c->next;
+            upstream->deallocate(c, sizeof(Chunk) + c->size, alignof(Chunk));
+            c = next;
+        }
+    }
+
+    // Forget every allocation; all chunks stay mapped for reuse
+    void reset() noexcept {
+        if (head)
+            enter(head);
+    }
+};
+
+#endif
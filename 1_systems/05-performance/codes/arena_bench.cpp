@@ -0,0 +1,85 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "arena.hpp"
+#include "vec.hpp"
+
+// Per-request temporaries: heap-backed Vectors against Vectors carved from
+// an Arena that is reset after every request.
+
+enum class Mode { Heap, Arena, ArenaNoInit };
+
+// One simulated request: build a batch of temporaries, fill and reduce them
+template <typename T>
+T run_request(Mode mode, Arena& arena, int num_vectors, size_t base_len) {
+    T total = 0;
+    for (int k = 0; k < num_vectors; k++) {
+        size_t len = base_len + (k * 97) % base_len;
+        T result;
+        if (mode == Mode::Heap) {
+            Vector<T> v(len);
+            for (size_t i = 0; i < len; i++)
+                v[i] = T(i & 7);
+            combine4(v, result, '+');
+        } else if (mode == Mode::Arena) {
+            Vector<T> v(len, &arena);
+            for (size_t i = 0; i < len; i++)
+                v[i] = T(i & 7);
+            combine4(v, result, '+');
+        } else {
+            Vector<T> v(len, no_init, &arena);
+            for (size_t i = 0; i < len; i++)
+                v[i] = T(i & 7);
+            combine4(v, result, '+');
+        }
+        total += result;
+    }
+    if (mode != Mode::Heap)
+        arena.reset(); // O(1), chunks are kept for the next request
+    return total;
+}
+
+template <typename T>
+double bench(Mode mode, int requests, int num_vectors, size_t base_len,
+             T& checksum) {
+    Arena arena;
+    checksum = run_request<T>(mode, arena, num_vectors, base_len); // warm up
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < requests; r++) {
+        checksum += run_request<T>(mode, arena, num_vectors, base_len);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double, std::nano> elapsed = end - start;
+    return elapsed.count() / requests;
+}
+
+int main() {
+    const int requests = 20000;
+    const int num_vectors = 32; // temporaries per request
+
+    struct TestCase {
+        std::string name;
+        Mode mode;
+    };
+    std::vector<TestCase> modes = {{"heap (std::vector)", Mode::Heap},
+                                   {"arena", Mode::Arena},
+                                   {"arena, no value-init", Mode::ArenaNoInit}};
+
+    for (size_t base_len : {64, 1024, 16384}) {
+        std::cout << "\n=== " << num_vectors << " vectors of " << base_len
+                  << ".." << 2 * base_len << " longs per request ===\n";
+        for (const auto& m : modes) {
+            long checksum;
+            double ns = bench<long>(m.mode, requests, num_vectors, base_len,
+                                    checksum);
+            std::cout << std::left << std::setw(24) << m.name << std::right
+                      << std::fixed << std::setprecision(1) << std::setw(12)
+                      << ns << " ns/request  (checksum " << checksum << ")\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,590 @@
+#ifndef COLUMN_HPP
+#define COLUMN_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <immintrin.h>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <type_traits>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#include "vec.hpp"
+
+// Chunked, compressed column file for Vector<int32_t> / Vector<float>.
+//
+//   header (64 B) | chunk 0 | chunk 1 | ... | footer: ChunkMeta[n] | trailer
+//
+// Every chunk starts on a COLUMN_ALIGN boundary so a mapped file can be
+// decoded with aligned loads. Each chunk picks the smallest of four
+// encodings and records min/max/sum, so range queries can skip chunks or
+// answer them from the footer without decoding. The reader maps the file
+// and decodes one chunk at a time into a chunk-sized Vector, which keeps the
+// working set in cache and lets the existing combine kernels run unchanged.
+//
+// Encodings (all values are handled as 32-bit patterns):
+//   Raw    the values as they are
+//   For    frame of reference: bit-packed (v - min)        (int only)
+//   Delta  bit-packed (v[i] - v[i-1] - min_delta)         (int only)
+//   Dict   up to COLUMN_MAX_DICT distinct values + bit-packed indices
+
+#define COLUMN_MAGIC 0x4c4f4356u // "VCOL"
+#define COLUMN_ALIGN 64
+#define COLUMN_MAX_DICT 4096
+#define COLUMN_SLACK 8 // bit-packed payloads may be read 8 bytes at a time
+
+enum class Encoding : uint8_t { Raw, For, Delta, Dict };
+
+inline const char* encoding_name(Encoding e) {
+    static const char* names[] = {"raw", "for", "delta", "dict"};
+    return names[static_cast<int>(e)];
+}
+
+struct ChunkMeta {
+    uint64_t offset; // from the start of the file, COLUMN_ALIGN-aligned
+    uint32_t bytes;  // payload size
+    uint32_t count;  // number of values
+    Encoding encoding;
+    uint8_t bits;       // width of each packed code
+    uint16_t dict_size; // Dict: entries before the packed indices
+    uint32_t base;      // For: min, Delta: first value
+    uint32_t min_delta; // Delta only
+    uint32_t reserved;
+    double min, max, sum; // exact for int32 up to 2^53
+};
+static_assert(sizeof(ChunkMeta) == 56);
+
+struct ColumnTrailer {
+    uint64_t footer_offset;
+    uint64_t num_chunks;
+    uint64_t total_count;
+    uint32_t chunk_elems;
+    uint32_t magic;
+};
+
+// ---------------- bit packing ----------------
+
+inline int bits_needed(uint32_t range) {
+    return range ? 32 - __builtin_clz(range) : 0;
+}
+
+inline size_t packed_bytes(size_t n, int bits) {
+    return (n * bits + 7) / 8 + COLUMN_SLACK;
+}
+
+inline void bitpack(const uint32_t* codes, size_t n, int bits,
+                    std::vector<uint8_t>& out) {
+    size_t start = out.size();
+    out.resize(start + packed_bytes(n, bits), 0);
+    uint8_t* p = out.data() + start;
+    uint64_t acc = 0;
+    int filled = 0;
+    for (size_t i = 0; i < n; i++) {
+        acc |= (uint64_t)codes[i] << filled;
+        filled += bits;
+        while (filled >= 8) {
+            *p++ = (uint8_t)acc;
+            acc >>= 8;
+            filled -= 8;
+        }
+    }
+    if (filled > 0)
+        *p = (uint8_t)acc;
+}
+
+// Code i lives at bit i*bits; bits <= 32 and shift <= 7 fit in one 64-bit load
+inline uint32_t unpack_one(const uint8_t* in, size_t i, int bits) {
+    uint64_t off = (uint64_t)i * bits;
+    uint64_t word;
+    memcpy(&word, in + (off >> 3), 8);
+    uint64_t mask = (1ULL << bits) - 1;
+    return (uint32_t)((word >> (off & 7)) & mask);
+}
+
+// Eight codes starting at i: gather the 64-bit words, shift, mask
+__attribute__((target("avx2"))) inline __m256i unpack8_avx2(const uint8_t* in,
+                                                            size_t i,
+                                                            int bits) {
+    const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i idx = _mm256_add_epi32(_mm256_set1_epi32((int)i), lane);
+    __m256i off = _mm256_mullo_epi32(idx, _mm256_set1_epi32(bits));
+    __m256i byte = _mm256_srli_epi32(off, 3);
+    __m256i shift = _mm256_and_si256(off, _mm256_set1_epi32(7));
+
+    const long long* base = reinterpret_cast<const long long*>(in);
+    __m256i lo = _mm256_i32gather_epi64(base, _mm256_castsi256_si128(byte), 1);
+    __m256i hi =
+        _mm256_i32gather_epi64(base, _mm256_extracti128_si256(byte, 1), 1);
+    lo = _mm256_srlv_epi64(
+        lo, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(shift)));
+    hi = _mm256_srlv_epi64(
+        hi, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(shift, 1)));
+
+    // Keep the low 32 bits of each 64-bit lane, in order
+    const __m256i even = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    lo = _mm256_permutevar8x32_epi32(lo, even);
+    hi = _mm256_permutevar8x32_epi32(hi, even);
+    __m256i v = _mm256_permute2x128_si256(lo, hi, 0x20);
+    uint32_t mask = bits == 32 ? ~0u : (1u << bits) - 1;
+    return _mm256_and_si256(v, _mm256_set1_epi32((int)mask));
+}
+
+// ---------------- chunk decoders (32-bit patterns) ----------------
+
+inline void decode_for_scalar(const uint8_t* in, uint32_t* out, size_t n,
+                              int bits, uint32_t base) {
+    for (size_t i = 0; i < n; i++)
+        out[i] = base + unpack_one(in, i, bits);
+}
+
+inline void decode_delta_scalar(const uint8_t* in, uint32_t* out, size_t n,
+                                int bits, uint32_t first, uint32_t min_delta) {
+    uint32_t v = first;
+    for (size_t i = 0; i < n; i++) {
+        v += unpack_one(in, i, bits) + min_delta;
+        out[i] = v;
+    }
+}
+
+inline void decode_dict_scalar(const uint8_t* in, uint32_t* out, size_t n,
+                               int bits, const uint32_t* dict) {
+    for (size_t i = 0; i < n; i++)
+        out[i] = dict[unpack_one(in, i, bits)];
+}
+
+__attribute__((target("avx2"))) inline void
+decode_for_avx2(const uint8_t* in, uint32_t* out, size_t n, int bits,
+                uint32_t base) {
+    __m256i vbase = _mm256_set1_epi32((int)base);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_add_epi32(unpack8_avx2(in, i, bits), vbase);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), v);
+    }
+    for (; i < n; i++)
+        out[i] = base + unpack_one(in, i, bits);
+}
+
+// Prefix sum of eight lanes: log-step within each 128-bit half, then carry
+// the low half's total into the high half and the running total into both
+__attribute__((target("avx2"))) inline void
+decode_delta_avx2(const uint8_t* in, uint32_t* out, size_t n, int bits,
+                  uint32_t first, uint32_t min_delta) {
+    __m256i vmin = _mm256_set1_epi32((int)min_delta);
+    __m256i carry = _mm256_set1_epi32((int)first);
+    const __m256i last_of_low = _mm256_set1_epi32(3);
+    const __m256i last = _mm256_set1_epi32(7);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_add_epi32(unpack8_avx2(in, i, bits), vmin);
+        x = _mm256_add_epi32(x, _mm256_slli_si256(x, 4));
+        x = _mm256_add_epi32(x, _mm256_slli_si256(x, 8));
+        __m256i low = _mm256_permutevar8x32_epi32(x, last_of_low);
+        x = _mm256_add_epi32(
+            x, _mm256_blend_epi32(_mm256_setzero_si256(), low, 0xF0));
+        x = _mm256_add_epi32(x, carry);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), x);
+        carry = _mm256_permutevar8x32_epi32(x, last);
+    }
+    uint32_t v = i ? out[i - 1] : first;
+    for (; i < n; i++) {
+        v += unpack_one(in, i, bits) + min_delta;
+        out[i] = v;
+    }
+}
+
+__attribute__((target("avx2"))) inline void
+decode_dict_avx2(const uint8_t* in, uint32_t* out, size_t n, int bits,
+                 const uint32_t* dict) {
+    const int* table = reinterpret_cast<const int*>(dict);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_i32gather_epi32(table, unpack8_avx2(in, i, bits), 4);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), v);
+    }
+    for (; i < n; i++)
+        out[i] = dict[unpack_one(in, i, bits)];
+}
+
+// ---------------- writer ----------------
+
+template <typename T>
+inline uint32_t to_bits(T v) {
+    uint32_t u;
+    memcpy(&u, &v, 4);
+    return u;
+}
+
+// Encode one chunk, choosing the smallest encoding that applies
+template <typename T>
+ChunkMeta encode_chunk(const T* v, size_t n, std::vector<uint8_t>& out) {
+    ChunkMeta m{};
+    m.count = (uint32_t)n;
+    m.min = m.max = (double)v[0];
+    for (size_t i = 0; i < n; i++) {
+        m.min = (double)v[i] < m.min ? (double)v[i] : m.min;
+        m.max = (double)v[i] > m.max ? (double)v[i] : m.max;
+        m.sum += (double)v[i];
+    }
+
+    std::vector<uint32_t> codes(n);
+    size_t best = n * sizeof(T);
+    m.encoding = Encoding::Raw;
+
+    int for_bits = 32, delta_bits = 32;
+    int64_t min_delta = 0;
+    if constexpr (std::is_integral_v<T>) {
+        for_bits = bits_needed((uint32_t)((int64_t)m.max - (int64_t)m.min));
+        int64_t lo = 0, hi = 0;
+        for (size_t i = 1; i < n; i++) {
+            int64_t d = (int64_t)v[i] - v[i - 1];
+            lo = i == 1 || d < lo ? d : lo;
+            hi = i == 1 || d > hi ? d : hi;
+        }
+        if (hi - lo <= UINT32_MAX) {
+            delta_bits = bits_needed((uint32_t)(hi - lo));
+            min_delta = lo;
+        }
+    }
+
+    std::unordered_map<uint32_t, uint32_t> dict;
+    for (size_t i = 0; i < n && dict.size() <= COLUMN_MAX_DICT; i++)
+        dict.emplace(to_bits(v[i]), (uint32_t)dict.size());
+    int dict_bits = 32;
+    if (dict.size() <= COLUMN_MAX_DICT)
+        dict_bits = bits_needed((uint32_t)dict.size() - 1);
+
+    auto fits = [&](int bits, size_t extra) {
+        size_t size = packed_bytes(n, bits) + extra;
+        if (bits >= 32 || size >= best)
+            return false;
+        best = size;
+        return true;
+    };
+    if (fits(for_bits, 0))
+        m.encoding = Encoding::For;
+    if (fits(delta_bits, 0))
+        m.encoding = Encoding::Delta;
+    if (fits(dict_bits, dict.size() * 4))
+        m.encoding = Encoding::Dict;
+
+    switch (m.encoding) {
+    case Encoding::Raw: {
+        size_t start = out.size();
+        out.resize(start + n * sizeof(T));
+        memcpy(out.data() + start, v, n * sizeof(T));
+        break;
+    }
+    case Encoding::For:
+        m.base = to_bits(static_cast<T>(m.min));
+        for (size_t i = 0; i < n; i++)
+            codes[i] = to_bits(v[i]) - m.base;
+        m.bits = (uint8_t)for_bits;
+        bitpack(codes.data(), n, for_bits, out);
+        break;
+    case Encoding::Delta:
+        // The first code restores v[0] from base, so base is v[0] - delta
+        m.min_delta = (uint32_t)min_delta;
+        m.base = to_bits(v[0]) - m.min_delta;
+        codes[0] = 0;
+        for (size_t i = 1; i < n; i++)
+            codes[i] = to_bits(v[i]) - to_bits(v[i - 1]) - m.min_delta;
+        m.bits = (uint8_t)delta_bits;
+        bitpack(codes.data(), n, delta_bits, out);
+        break;
+    case Encoding::Dict: {
+        std::vector<uint32_t> entries(dict.size());
+        for (auto& [value, index] : dict)
+            entries[index] = value;
+        size_t start = out.size();
+        out.resize(start + entries.size() * 4);
+        memcpy(out.data() + start, entries.data(), entries.size() * 4);
+        for (size_t i = 0; i < n; i++)
+            codes[i] = dict[to_bits(v[i])];
+        m.dict_size = (uint16_t)entries.size();
+        m.bits = (uint8_t)dict_bits;
+        bitpack(codes.data(), n, dict_bits, out);
+        break;
+    }
+    }
+    return m;
+}
+
+// Write v to path in chunks of chunk_elems values
+template <typename T>
+void column_write(const char* path, const Vector<T>& v,
+                  size_t chunk_elems = 32768) {
+    static_assert(sizeof(T) == 4, "columns hold 32-bit values");
+    FILE* f = fopen(path, "wb");
+    if (!f)
+        throw std::system_error(errno, std::generic_category(), path);
+
+    std::vector<uint8_t> buf(COLUMN_ALIGN, 0); // header
+    uint32_t header[4] = {COLUMN_MAGIC, 1, std::is_integral_v<T> ? 0u : 1u,
+                          (uint32_t)chunk_elems};
+    memcpy(buf.data(), header, sizeof(header));
+
+    std::vector<ChunkMeta> metas;
+    uint64_t offset = 0;
+    const T* data = v.get_start();
+    for (size_t start = 0; start < v.length(); start += chunk_elems) {
+        size_t n = std::min(chunk_elems, v.length() - start);
+        buf.resize(
+            (buf.size() + COLUMN_ALIGN - 1) & ~(size_t)(COLUMN_ALIGN - 1), 0);
+        size_t begin = buf.size();
+        ChunkMeta m = encode_chunk(data + start, n, buf);
+        m.offset = offset + begin;
+        m.bytes = (uint32_t)(buf.size() - begin);
+        metas.push_back(m);
+        // Flush whole aligned prefix, keep offsets relative to file start
+        if (buf.size() > (4 << 20)) {
+            size_t keep = buf.size() & (COLUMN_ALIGN - 1);
+            size_t flush = buf.size() - keep;
+            fwrite(buf.data(), 1, flush, f);
+            offset += flush;
+            buf.erase(buf.begin(), buf.begin() + flush);
+        }
+    }
+
+    // Footer entries hold doubles, keep them aligned
+    buf.resize((buf.size() + COLUMN_ALIGN - 1) & ~(size_t)(COLUMN_ALIGN - 1),
+               0);
+    ColumnTrailer t{offset + buf.size(), metas.size(), v.length(),
+                    (uint32_t)chunk_elems, COLUMN_MAGIC};
+    fwrite(buf.data(), 1, buf.size(), f);
+    fwrite(metas.data(), sizeof(ChunkMeta), metas.size(), f);
+    fwrite(&t, sizeof(t), 1, f);
+    if (fclose(f) != 0)
+        throw std::system_error(errno, std::generic_category(), path);
+}
+
+// ---------------- reader ----------------
+
+template <typename T>
+class ColumnReader {
+private:
+    const uint8_t* map = nullptr;
+    size_t map_len = 0;
+    const ChunkMeta* metas = nullptr;
+    ColumnTrailer trailer{};
+    bool simd = __builtin_cpu_supports("avx2");
+    Vector<T> chunk_buf; // decode target for full chunks
+    Vector<T> tail_buf;  // and for a shorter last chunk
+
+    // Everything the decoders trust comes from the file; check it against
+    // the mapping so a truncated or corrupt file throws instead of reading
+    // past the end. Sizes are compared by subtraction to avoid overflow.
+    void validate(const char* path) {
+        auto corrupt = [&](const char* what) {
+            return std::runtime_error(std::string(path) +
+                                      ": corrupt column file (" + what + ")");
+        };
+        uint32_t header[4];
+        memcpy(header, map, sizeof(header));
+        size_t trailer_at = map_len - sizeof(trailer);
+        memcpy(&trailer, map + trailer_at, sizeof(trailer));
+        if (header[0] != COLUMN_MAGIC || trailer.magic != COLUMN_MAGIC ||
+            header[2] != (std::is_integral_v<T> ? 0u : 1u))
+            throw std::runtime_error(std::string(path) +
+                                     ": not a column file of this type");
+
+        if (trailer.footer_offset < COLUMN_ALIGN ||
+            trailer.footer_offset > trailer_at ||
+            trailer.footer_offset % alignof(ChunkMeta))
+            throw corrupt("footer offset");
+        if (trailer.num_chunks >
+            (trailer_at - trailer.footer_offset) / sizeof(ChunkMeta))
+            throw corrupt("chunk count");
+        if (trailer.num_chunks && trailer.chunk_elems == 0)
+            throw corrupt("chunk size");
+        metas = reinterpret_cast<const ChunkMeta*>(map + trailer.footer_offset);
+
+        uint64_t total = 0;
+        for (size_t c = 0; c < trailer.num_chunks; c++) {
+            const ChunkMeta& m = metas[c];
+            // load() picks its buffer by count: only the last may be short
+            bool last = c + 1 == trailer.num_chunks;
+            if (m.count == 0 || m.count > trailer.chunk_elems ||
+                (!last && m.count != trailer.chunk_elems))
+                throw corrupt("chunk length");
+            total += m.count;
+
+            if (m.offset < COLUMN_ALIGN || m.offset % COLUMN_ALIGN ||
+                m.offset > trailer.footer_offset ||
+                m.bytes > trailer.footer_offset - m.offset)
+                throw corrupt("chunk bounds");
+
+            // Bytes the decoder will read, including the unpacking slack
+            size_t need;
+            switch (m.encoding) {
+            case Encoding::Raw:
+                need = (size_t)m.count * sizeof(T);
+                break;
+            case Encoding::For:
+            case Encoding::Delta:
+                if (m.bits > 32)
+                    throw corrupt("code width");
+                need = packed_bytes(m.count, m.bits);
+                break;
+            case Encoding::Dict:
+                // Codes up to 2^bits - 1 index the dictionary; that many
+                // entries must lie inside the mapping even if the file
+                // claims fewer
+                if (m.dict_size == 0 || m.dict_size > COLUMN_MAX_DICT ||
+                    m.bits > bits_needed(COLUMN_MAX_DICT - 1) ||
+                    (4ull << m.bits) > map_len - m.offset)
+                    throw corrupt("dictionary");
+                need = (size_t)m.dict_size * 4 + packed_bytes(m.count, m.bits);
+                break;
+            default:
+                throw corrupt("encoding");
+            }
+            if (need > m.bytes)
+                throw corrupt("chunk payload");
+        }
+        if (total != trailer.total_count)
+            throw corrupt("total count");
+    }
+
+public:
+    struct QueryStats {
+        size_t skipped = 0;    // min/max outside the range
+        size_t from_stats = 0; // whole chunk inside, answered from the footer
+        size_t decoded = 0;
+    };
+
+    explicit ColumnReader(const char* path) : chunk_buf(0), tail_buf(0) {
+        int fd = open(path, O_RDONLY);
+        if (fd < 0)
+            throw std::system_error(errno, std::generic_category(), path);
+        struct stat st;
+        if (fstat(fd, &st) < 0) {
+            int err = errno;
+            close(fd);
+            throw std::system_error(err, std::generic_category(), path);
+        }
+        if ((size_t)st.st_size < COLUMN_ALIGN + sizeof(ColumnTrailer)) {
+            close(fd);
+            throw std::runtime_error(std::string(path) +
+                                     ": too short for a column file");
+        }
+        map_len = st.st_size;
+        void* p = mmap(nullptr, map_len, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED)
+            throw std::system_error(errno, std::generic_category(), path);
+        map = static_cast<const uint8_t*>(p);
+
+        // The destructor does not run when a constructor throws
+        try {
+            validate(path);
+            chunk_buf = Vector<T>(trailer.chunk_elems, no_init);
+            size_t last = num_chunks() ? metas[num_chunks() - 1].count : 0;
+            if (last != trailer.chunk_elems)
+                tail_buf = Vector<T>(last, no_init);
+        } catch (...) {
+            munmap(const_cast<uint8_t*>(map), map_len);
+            throw;
+        }
+    }
+
+    ColumnReader(const ColumnReader&) = delete;
+    ColumnReader& operator=(const ColumnReader&) = delete;
+
+    ~ColumnReader() { munmap(const_cast<uint8_t*>(map), map_len); }
+
+    size_t length() const { return trailer.total_count; }
+    size_t num_chunks() const { return trailer.num_chunks; }
+    size_t file_bytes() const { return map_len; }
+    const ChunkMeta& chunk(size_t c) const { return metas[c]; }
+
+    // Use the AVX2 decoders when the CPU has them (default) or force scalar
+    void set_simd(bool on) { simd = on && __builtin_cpu_supports("avx2"); }
+
+    // Decode chunk c into out, which must hold chunk(c).count values
+    void decode(size_t c, T* out) const {
+        const ChunkMeta& m = metas[c];
+        const uint8_t* in = map + m.offset;
+        uint32_t* o = reinterpret_cast<uint32_t*>(out);
+        switch (m.encoding) {
+        case Encoding::Raw:
+            memcpy(out, in, m.count * sizeof(T));
+            break;
+        case Encoding::For:
+            if (simd)
+                decode_for_avx2(in, o, m.count, m.bits, m.base);
+            else
+                decode_for_scalar(in, o, m.count, m.bits, m.base);
+            break;
+        case Encoding::Delta:
+            if (simd)
+                decode_delta_avx2(in, o, m.count, m.bits, m.base, m.min_delta);
+            else
+                decode_delta_scalar(in, o, m.count, m.bits, m.base,
+                                    m.min_delta);
+            break;
+        case Encoding::Dict: {
+            // Entries are 4-aligned: the chunk is aligned and each is 4 bytes
+            const uint32_t* dict = reinterpret_cast<const uint32_t*>(in);
+            in += m.dict_size * 4;
+            if (simd)
+                decode_dict_avx2(in, o, m.count, m.bits, dict);
+            else
+                decode_dict_scalar(in, o, m.count, m.bits, dict);
+            break;
+        }
+        }
+    }
+
+    // Decode chunk c into the reusable chunk buffer
+    const Vector<T>& load(size_t c) {
+        Vector<T>& buf =
+            metas[c].count == chunk_buf.length() ? chunk_buf : tail_buf;
+        decode(c, buf.get_start());
+        return buf;
+    }
+
+    // Run a combine kernel chunk by chunk and fold the partial results
+    T reduce(const CombineFunction<T>& kernel, char op) {
+        T acc = (op == '+') ? T(0) : T(1);
+        for (size_t c = 0; c < num_chunks(); c++) {
+            T part;
+            kernel(load(c), part, op);
+            acc = (op == '+') ? acc + part : acc * part;
+        }
+        return acc;
+    }
+
+    // Sum of the values in [lo, hi], using chunk statistics where possible
+    double sum_between(T lo, T hi, QueryStats* qs = nullptr) {
+        QueryStats local;
+        QueryStats& s = qs ? *qs : local;
+        double sum = 0;
+        for (size_t c = 0; c < num_chunks(); c++) {
+            const ChunkMeta& m = metas[c];
+            if (m.max < (double)lo || m.min > (double)hi) {
+                s.skipped++;
+            } else if (m.min >= (double)lo && m.max <= (double)hi) {
+                s.from_stats++;
+                sum += m.sum;
+            } else {
+                s.decoded++;
+                const Vector<T>& v = load(c);
+                const T* p = v.get_start();
+                for (size_t i = 0; i < v.length(); i++)
+                    sum += (p[i] >= lo && p[i] <= hi) ? (double)p[i] : 0.0;
+            }
+        }
+        return sum;
+    }
+};
+
+#endif
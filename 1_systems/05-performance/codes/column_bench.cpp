@@ -0,0 +1,153 @@
+#include <cinttypes>
+#include <cstdio>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "column.hpp"
+
+// Column file benchmark: encode a few typical columns, then compare
+// reading the raw array back and reducing it against decoding the column
+// file chunk by chunk into the same combine kernel, scalar and AVX2.
+// Finishes with a range query that skips chunks by their statistics.
+//
+// Build: g++ -std=c++20 -O2 column_bench.cpp -o column_bench
+// Usage: ./column_bench [elems]
+
+static double now_sec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+template <typename T>
+static void write_raw(const char* path, const Vector<T>& v) {
+    FILE* f = fopen(path, "wb");
+    fwrite(v.get_start(), sizeof(T), v.length(), f);
+    fclose(f);
+}
+
+template <typename T>
+static Vector<T> read_raw(const char* path, size_t n) {
+    Vector<T> v(n, no_init);
+    FILE* f = fopen(path, "rb");
+    size_t got = fread(v.get_start(), sizeof(T), n, f);
+    fclose(f);
+    if (got != n)
+        fprintf(stderr, "%s: short read\n", path);
+    return v;
+}
+
+// Integer sums wrap the same way in both paths and compare exactly; a float
+// sum over millions of elements rounds differently when folded per chunk
+template <typename T>
+static bool same(T a, T b) {
+    if constexpr (std::is_integral_v<T>)
+        return a == b;
+    else
+        return a == b || ((a - b) / b < 1e-2 && (b - a) / b < 1e-2);
+}
+
+template <typename T>
+static void bench(const char* name, const Vector<T>& v) {
+    const char* raw_path = "column_bench.raw";
+    const char* col_path = "column_bench.col";
+    write_raw(raw_path, v);
+    column_write(col_path, v);
+
+    ColumnReader<T> col(col_path);
+    size_t counts[4] = {};
+    for (size_t c = 0; c < col.num_chunks(); c++)
+        counts[static_cast<int>(col.chunk(c).encoding)]++;
+    size_t raw_bytes = v.length() * sizeof(T);
+    printf("%-10s %7.1f MB -> %7.1f MB (%4.1fx)  chunks:", name,
+           raw_bytes / 1e6, col.file_bytes() / 1e6,
+           (double)raw_bytes / col.file_bytes());
+    for (int e = 0; e < 4; e++) {
+        if (counts[e])
+            printf(" %s %zu", encoding_name(static_cast<Encoding>(e)),
+                   counts[e]);
+    }
+    printf("\n");
+
+    // Reference: read the raw file into one Vector, reduce it
+    double t0 = now_sec();
+    Vector<T> all = read_raw<T>(raw_path, v.length());
+    T expect;
+    combine6(all, expect, '+');
+    double raw_t = now_sec() - t0;
+
+    double best[2] = {1e9, 1e9};
+    bool ok = true;
+    for (int r = 0; r < 5; r++) {
+        for (int simd = 0; simd < 2; simd++) {
+            col.set_simd(simd);
+            double t = now_sec();
+            T got = col.reduce(combine6<T>, '+');
+            t = now_sec() - t;
+            best[simd] = t < best[simd] ? t : best[simd];
+            ok &= same(got, expect);
+        }
+    }
+    printf("           raw read+reduce %6.1f ms | column decode+reduce: "
+           "scalar %6.1f ms, avx2 %6.1f ms (%.2f Gelem/s) %s\n",
+           raw_t * 1e3, best[0] * 1e3, best[1] * 1e3,
+           v.length() / best[1] / 1e9, ok ? "ok" : "MISMATCH");
+
+    unlink(raw_path);
+    unlink(col_path);
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? strtoul(argv[1], nullptr, 10) : (16 << 20);
+    std::mt19937 gen(42);
+
+    // Monotonic timestamps with small jitter: delta-friendly
+    Vector<int> ts(n, no_init);
+    int t = 1700000000;
+    for (size_t i = 0; i < n; i++)
+        ts[i] = t += 1 + gen() % 16;
+
+    // Sensor readings in a narrow band: frame of reference
+    Vector<int> sensor(n, no_init);
+    for (size_t i = 0; i < n; i++)
+        sensor[i] = 20000 + (int)(gen() % 1000) - (int)((i >> 20) * 37);
+
+    // Product categories: low cardinality
+    Vector<int> category(n, no_init);
+    for (size_t i = 0; i < n; i++)
+        category[i] = (int)(gen() % 200) * 7919;
+
+    // Prices from a small price list, and plain random floats
+    Vector<float> price(n, no_init);
+    for (size_t i = 0; i < n; i++)
+        price[i] = 0.99f + (float)(gen() % 300);
+    Vector<float> noise(n);
+    noise.fill_random(0.0f, 1.0f);
+
+    printf("%zu elements per column, AVX2 %s\n\n", n,
+           __builtin_cpu_supports("avx2") ? "yes" : "no");
+    bench("timestamp", ts);
+    bench("sensor", sensor);
+    bench("category", category);
+    bench("price", price);
+    bench("noise", noise);
+
+    // Range query on the timestamps: most chunks skipped or from stats
+    column_write("column_bench.col", ts);
+    ColumnReader<int> col("column_bench.col");
+    int lo = ts[n / 3] + 5, hi = ts[n / 3 + n / 10];
+    ColumnReader<int>::QueryStats qs;
+    double t0 = now_sec();
+    double sum = col.sum_between(lo, hi, &qs);
+    double qt = now_sec() - t0;
+    double expect = 0;
+    for (size_t i = 0; i < n; i++)
+        expect += (ts[i] >= lo && ts[i] <= hi) ? ts[i] : 0;
+    printf("\nrange query on timestamp: %.3f ms, %zu chunks skipped, %zu "
+           "from stats, %zu decoded, %s\n",
+           qt * 1e3, qs.skipped, qs.from_stats, qs.decoded,
+           sum == expect ? "ok" : "MISMATCH");
+    unlink("column_bench.col");
+    return 0;
+}
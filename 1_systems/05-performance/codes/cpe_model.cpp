@@ -0,0 +1,270 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "vec.hpp"
+
+// Static CPE model for the combine kernels (5.7, 5.12).
+//
+// 1. Measure the host: latency and reciprocal throughput of add/mul for
+//    int/float/double, store-to-load forwarding and the cost of one loop
+//    iteration (a taken branch), with inline-asm chains of dependent or
+//    independent instructions. One dependent integer add is
+//    taken as exactly one cycle, which calibrates the clock without knowing
+//    the frequency (and follows turbo).
+// 2. Predict each combineN's CPE lower bound as the larger of
+//      - the latency bound: cycles on the loop-carried chain per element
+//      - the throughput bound: ops, loads, stores and loop iterations per
+//        element, each times its issue cost
+// 3. Measure each kernel and report predicted vs measured CPE, flagging
+//    kernels far above their bound (worth optimizing) and those below it
+//    (the compiler did something the model does not know about, usually
+//    vectorization).
+//
+// Build: g++ -std=c++20 -O2 cpe_model.cpp -o cpe_model
+// x86-64 only (inline assembly, AT&T syntax)
+
+#define CHAIN_OPS 100 // instructions per asm block
+#define PROBE_ITERS 200000
+
+using Clock = std::chrono::steady_clock;
+
+// Runs f() PROBE_ITERS times, each executing ops instructions; returns the
+// best of a few runs in ns per instruction. f is a copy, so a mutable lambda
+// keeps its captures in registers across calls.
+template <typename F>
+static double ns_per_op(F f, int ops) {
+    double best = 1e30;
+    for (int rep = 0; rep < 5; rep++) {
+        auto t0 = Clock::now();
+        for (int i = 0; i < PROBE_ITERS; i++)
+            f();
+        std::chrono::duration<double, std::nano> dt = Clock::now() - t0;
+        best = std::min(best, dt.count() / (double(PROBE_ITERS) * ops));
+    }
+    return best;
+}
+
+#define REPT(n, body) ".rept " #n "\n\t" body "\n\t.endr"
+
+// Latency: every instruction depends on the previous one through %0. x is
+// captured, not reset per call: a fresh chain each call would let
+// out-of-order execution overlap consecutive blocks and hide the latency.
+#define LATENCY_GPR(insn)                                                      \
+    [x = 1L, y = 1L]() mutable {                                               \
+        asm volatile(REPT(100, insn " %1, %0") : "+r"(x) : "r"(y));            \
+    }
+#define LATENCY_XMM(insn, T)                                                   \
+    [x = T(1), y = T(1)]() mutable {                                           \
+        asm volatile(REPT(100, insn " %1, %0") : "+x"(x) : "x"(y));            \
+    }
+
+// Throughput: ten independent chains, so latency is hidden and only the
+// issue rate limits
+#define THROUGHPUT_GPR(insn)                                                   \
+    [] {                                                                       \
+        long a = 1, b = 1, c = 1, d = 1, e = 1, f = 1, g = 1, h = 1, i = 1,   \
+             j = 1, y = 1;                                                     \
+        asm volatile(REPT(10, insn " %10, %0\n\t" insn " %10, %1\n\t" insn    \
+                              " %10, %2\n\t" insn " %10, %3\n\t" insn         \
+                              " %10, %4\n\t" insn " %10, %5\n\t" insn         \
+                              " %10, %6\n\t" insn " %10, %7\n\t" insn         \
+                              " %10, %8\n\t" insn " %10, %9")                 \
+                     : "+r"(a), "+r"(b), "+r"(c), "+r"(d), "+r"(e), "+r"(f),   \
+                       "+r"(g), "+r"(h), "+r"(i), "+r"(j)                      \
+                     : "r"(y));                                                \
+    }
+#define THROUGHPUT_XMM(insn, T)                                                \
+    [] {                                                                       \
+        T a = 1, b = 1, c = 1, d = 1, e = 1, f = 1, g = 1, h = 1, i = 1,      \
+          j = 1, y = 1;                                                        \
+        asm volatile(REPT(10, insn " %10, %0\n\t" insn " %10, %1\n\t" insn    \
+                              " %10, %2\n\t" insn " %10, %3\n\t" insn         \
+                              " %10, %4\n\t" insn " %10, %5\n\t" insn         \
+                              " %10, %6\n\t" insn " %10, %7\n\t" insn         \
+                              " %10, %8\n\t" insn " %10, %9")                 \
+                     : "+x"(a), "+x"(b), "+x"(c), "+x"(d), "+x"(e), "+x"(f),   \
+                       "+x"(g), "+x"(h), "+x"(i), "+x"(j)                      \
+                     : "x"(y));                                                \
+    }
+
+// Store a register and load it back, 100 times: the store-forwarding
+// round trip that a value kept in memory pays every iteration. Like the
+// latency chains, x carries the dependency from one call to the next.
+static void store_forward_chain(long& x) {
+    static long slot;
+    asm volatile(REPT(100, "mov %0, %1\n\tmov %1, %0")
+                 : "+r"(x), "+m"(slot));
+}
+
+// An empty counted loop: the floor for any loop iteration, set by how many
+// taken branches the front end can follow per cycle
+static void empty_loop() {
+    long n = CHAIN_OPS;
+    asm volatile("1:\n\tdec %0\n\tjnz 1b" : "+r"(n));
+}
+
+// Operation costs in cycles
+struct OpCost {
+    double latency;
+    double throughput; // cycles per op when independent
+};
+
+struct HostModel {
+    double ns_per_cycle;
+    double store_forward;    // cycles, store then dependent load
+    double loop_iter;        // cycles per iteration of an empty loop
+    OpCost cost[3][2];       // [int/float/double][add/mul]
+    double load_tput = 0.5;  // two load ports
+    double store_tput = 1.0; // one store port
+};
+
+static HostModel measure_host() {
+    HostModel h;
+    h.ns_per_cycle = ns_per_op(LATENCY_GPR("add"), CHAIN_OPS);
+    auto cycles = [&](double ns) { return ns / h.ns_per_cycle; };
+
+    h.store_forward = cycles(ns_per_op(
+        [x = 1L]() mutable { store_forward_chain(x); }, CHAIN_OPS));
+    h.loop_iter = cycles(ns_per_op(empty_loop, CHAIN_OPS));
+    h.cost[0][0] = {1.0, cycles(ns_per_op(THROUGHPUT_GPR("add"), 100))};
+    h.cost[0][1] = {cycles(ns_per_op(LATENCY_GPR("imul"), CHAIN_OPS)),
+                    cycles(ns_per_op(THROUGHPUT_GPR("imul"), 100))};
+    h.cost[1][0] = {cycles(ns_per_op(LATENCY_XMM("addss", float), CHAIN_OPS)),
+                    cycles(ns_per_op(THROUGHPUT_XMM("addss", float), 100))};
+    h.cost[1][1] = {cycles(ns_per_op(LATENCY_XMM("mulss", float), CHAIN_OPS)),
+                    cycles(ns_per_op(THROUGHPUT_XMM("mulss", float), 100))};
+    h.cost[2][0] = {
+        cycles(ns_per_op(LATENCY_XMM("addsd", double), CHAIN_OPS)),
+        cycles(ns_per_op(THROUGHPUT_XMM("addsd", double), 100))};
+    h.cost[2][1] = {
+        cycles(ns_per_op(LATENCY_XMM("mulsd", double), CHAIN_OPS)),
+        cycles(ns_per_op(THROUGHPUT_XMM("mulsd", double), 100))};
+    return h;
+}
+
+// What the model knows about one kernel, per element
+struct KernelShape {
+    const char* name;
+    double chain_ops;    // ops on the loop-carried chain
+    bool chain_via_dest; // accumulates through *dest: + store forwarding
+    double ops;          // combining ops
+    double loads;
+    double stores;
+    double iters; // loop iterations
+};
+
+// combine1-3 write dest on every iteration. dest may alias the data, so the
+// compiler cannot keep it in a register and the chain goes through memory.
+// combine5 still puts both ops of an iteration on the chain; combine6 splits
+// it over two accumulators and combine7 reassociates so only one of the
+// two ops is on it.
+static const KernelShape shapes[] = {
+    {"combine1", 1, true, 1, 2, 1, 1},
+    {"combine2", 1, true, 1, 2, 1, 1},
+    {"combine3", 1, true, 1, 2, 1, 1},
+    {"combine4", 1, false, 1, 1, 0, 1},
+    {"combine5", 1, false, 1, 1, 0, 0.5},
+    {"combine6", 0.5, false, 1, 1, 0, 0.5},
+    {"combine7", 0.5, false, 1, 1, 0, 0.5},
+};
+
+struct Bound {
+    double latency;
+    double throughput;
+    double cpe() const { return std::max(latency, throughput); }
+};
+
+static Bound predict(const HostModel& h, const KernelShape& k, int type,
+                     int op) {
+    const OpCost& c = h.cost[type][op];
+    Bound b;
+    b.latency =
+        k.chain_ops * c.latency + (k.chain_via_dest ? h.store_forward : 0);
+    b.throughput = std::max({k.ops * c.throughput, k.loads * h.load_tput,
+                             k.stores * h.store_tput, k.iters * h.loop_iter});
+    return b;
+}
+
+template <typename T>
+using Kernel = void (*)(const Vector<T>&, T&, char);
+
+// Best-of-several CPE, in the model's cycles
+template <typename T>
+static double measure_cpe(const HostModel& h, Kernel<T> f, const Vector<T>& v,
+                          char op) {
+    T result;
+    double best = 1e30;
+    f(v, result, op); // warm up
+    for (int rep = 0; rep < 7; rep++) {
+        auto t0 = Clock::now();
+        f(v, result, op);
+        std::chrono::duration<double, std::nano> dt = Clock::now() - t0;
+        best = std::min(best, dt.count());
+    }
+    // keep the result alive so the call is not discarded
+    asm volatile("" : : "g"(&result) : "memory");
+    return best / h.ns_per_cycle / v.length();
+}
+
+template <typename T>
+static void report(const HostModel& h, int type, const char* type_name,
+                   size_t len) {
+    static const Kernel<T> kernels[] = {combine1<T>, combine2<T>, combine3<T>,
+                                        combine4<T>, combine5<T>, combine6<T>,
+                                        combine7<T>};
+    Vector<T> v(len);
+    // values near 1 keep products finite and away from subnormals
+    if constexpr (std::is_integral_v<T>)
+        v.fill_random(0, 99);
+    else
+        v.fill_random(T(0.999), T(1.001));
+
+    const char ops[] = {'+', '*'};
+    for (int op = 0; op < 2; op++) {
+        printf("\n%s %c\n", type_name, ops[op]);
+        printf("  %-10s %8s %8s %10s %10s %7s\n", "kernel", "lat", "tput",
+               "predicted", "measured", "ratio");
+        for (size_t k = 0; k < std::size(shapes); k++) {
+            Bound b = predict(h, shapes[k], type, op);
+            double m = measure_cpe(h, kernels[k], v, ops[op]);
+            double ratio = m / b.cpe();
+            const char* flag = "";
+            if (ratio > 1.5)
+                flag = "  <- far from bound";
+            else if (ratio < 0.8)
+                flag = "  <- below bound (compiler beat the model)";
+            printf("  %-10s %8.2f %8.2f %10.2f %10.2f %7.2f%s\n",
+                   shapes[k].name, b.latency, b.throughput, b.cpe(), m, ratio,
+                   flag);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    // 64K elements: fits in L2, so memory does not set the bound
+    size_t len = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1 << 16;
+
+    HostModel h = measure_host();
+    printf("Host (1 cycle = one dependent integer add = %.3f ns, %.2f GHz)\n",
+           h.ns_per_cycle, 1 / h.ns_per_cycle);
+    printf("  %-8s %14s %14s\n", "", "add lat/tput", "mul lat/tput");
+    const char* types[] = {"int", "float", "double"};
+    for (int t = 0; t < 3; t++)
+        printf("  %-8s %6.2f / %5.2f %6.2f / %5.2f\n", types[t],
+               h.cost[t][0].latency, h.cost[t][0].throughput,
+               h.cost[t][1].latency, h.cost[t][1].throughput);
+    printf("  store-forwarding latency %.2f, loop iteration %.2f, load %.2f, "
+           "store %.2f cycles/op\n",
+           h.store_forward, h.loop_iter, h.load_tput, h.store_tput);
+
+    printf("\nCPE per kernel, %zu elements (lat = latency bound, tput = "
+           "throughput bound)\n",
+           len);
+    report<int>(h, 0, "int", len);
+    report<float>(h, 1, "float", len);
+    report<double>(h, 2, "double", len);
+    return 0;
+}
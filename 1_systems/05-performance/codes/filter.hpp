@@ -0,0 +1,335 @@
+#ifndef FILTER_HPP
+#define FILTER_HPP
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <immintrin.h>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#include "vec.hpp"
+
+// Filtered combine: "op over the elements of v where the predicate holds",
+// without copying the matching elements out first.
+//
+// The predicate is either a closed range lo <= x <= hi on the values (one
+// sided ranges and equality are special cases) or a bitmap with bit i
+// selecting element i. Three kernels:
+//   Branchy     if (keep) acc = acc op x; fast when the branch is
+//               predictable (almost nothing or almost everything matches),
+//               a misprediction per element near 50%
+//   Branchless  acc = acc op (keep ? x : identity) as a bit-mask select;
+//               constant cost regardless of selectivity
+//   Simd        AVX2 compare + blend of eight lanes at a time into vector
+//               accumulators (int32 and float; other types use Branchless)
+// Like combine6 the branchless and SIMD kernels use several accumulators,
+// so float results may differ from the branchy one in the last bits.
+
+enum class FilterKernel { Branchy, Branchless, Simd };
+
+inline const char* filter_kernel_name(FilterKernel k) {
+    static const char* names[] = {"branchy", "branchless", "simd"};
+    return names[static_cast<int>(k)];
+}
+
+template <typename T>
+struct Predicate {
+    T lo, hi; // keep lo <= x <= hi
+
+    static Predicate between(T lo, T hi) { return {lo, hi}; }
+    // Open ends are +-infinity for floating types so infinities match
+    static Predicate at_least(T c) { return {c, top()}; }
+    static Predicate at_most(T c) { return {bottom(), c}; }
+    static Predicate equal(T c) { return {c, c}; }
+
+    bool operator()(T x) const { return x >= lo && x <= hi; }
+
+private:
+    using limits = std::numeric_limits<T>;
+    static constexpr T top() {
+        return limits::has_infinity ? limits::infinity() : limits::max();
+    }
+    static constexpr T bottom() {
+        return limits::has_infinity ? -limits::infinity() : limits::lowest();
+    }
+};
+
+// Bit i of the result is p(v[i])
+template <typename T>
+Vector<uint64_t> make_bitmap(const Vector<T>& v, const Predicate<T>& p) {
+    size_t n = v.length();
+    Vector<uint64_t> bits((n + 63) / 64);
+    const T* data = v.get_start();
+    for (size_t i = 0; i < n; i++)
+        bits[i / 64] |= uint64_t(p(data[i])) << (i % 64);
+    return bits;
+}
+
+namespace filter_detail {
+
+template <typename T>
+struct Add {
+    static constexpr T identity = T(0);
+    static T apply(T a, T b) { return a + b; }
+};
+
+template <typename T>
+struct Mul {
+    static constexpr T identity = T(1);
+    static T apply(T a, T b) { return a * b; }
+};
+
+// Calls f with the functor for op
+template <typename T, typename F>
+void with_op(char op, F&& f) {
+    if (op == '*')
+        f(Mul<T>());
+    else
+        f(Add<T>());
+}
+
+// Keep(i, x) says whether element i with value x is selected
+template <typename T, typename Op, typename Keep>
+T branchy(const T* data, size_t n, Keep keep) {
+    T acc = Op::identity;
+    for (size_t i = 0; i < n; i++) {
+        if (keep(i, data[i])) {
+            // keeps GCC from if-converting this into the branchless kernel
+            asm volatile("");
+            acc = Op::apply(acc, data[i]);
+        }
+    }
+    return acc;
+}
+
+// keep ? x : y without a branch. GCC often compiles the plain ternary to a
+// jump, so spell out the mask on the bit patterns.
+template <typename T>
+inline T select(bool keep, T x, T y) {
+    using U = std::conditional_t<sizeof(T) == 8, uint64_t, uint32_t>;
+    static_assert(sizeof(T) == sizeof(U));
+    U m = U(0) - U(keep);
+    U r = (std::bit_cast<U>(x) & m) | (std::bit_cast<U>(y) & ~m);
+    return std::bit_cast<T>(r);
+}
+
+template <typename T, typename Op, typename Keep>
+T branchless(const T* data, size_t n, Keep keep) {
+    T acc0 = Op::identity, acc1 = Op::identity;
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        T x0 = select(keep(i, data[i]), data[i], Op::identity);
+        T x1 = select(keep(i + 1, data[i + 1]), data[i + 1], Op::identity);
+        acc0 = Op::apply(acc0, x0);
+        acc1 = Op::apply(acc1, x1);
+    }
+    for (; i < n; i++)
+        acc0 = Op::apply(acc0, select(keep(i, data[i]), data[i], Op::identity));
+    return Op::apply(acc0, acc1);
+}
+
+// ---------------- AVX2 ----------------
+
+// Eight 32-bit lanes: the range test as a lane mask
+__attribute__((target("avx2"))) inline __m256i
+range_mask(__m256i x, __m256i lo, __m256i hi) {
+    __m256i out = _mm256_or_si256(_mm256_cmpgt_epi32(lo, x),
+                                  _mm256_cmpgt_epi32(x, hi));
+    return _mm256_xor_si256(out, _mm256_set1_epi32(-1));
+}
+
+__attribute__((target("avx2"))) inline __m256 range_mask(__m256 x, __m256 lo,
+                                                         __m256 hi) {
+    return _mm256_and_ps(_mm256_cmp_ps(x, lo, _CMP_GE_OQ),
+                         _mm256_cmp_ps(x, hi, _CMP_LE_OQ));
+}
+
+// Bits 8k..8k+7 of a bitmap word as a lane mask
+__attribute__((target("avx2"))) inline __m256i bits_mask(uint8_t b) {
+    const __m256i lane_bit = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    __m256i x = _mm256_and_si256(_mm256_set1_epi32(b), lane_bit);
+    return _mm256_cmpeq_epi32(x, lane_bit);
+}
+
+template <typename T>
+struct Lanes;
+
+template <>
+struct Lanes<int32_t> {
+    using V = __m256i;
+    __attribute__((target("avx2"))) static V load(const int32_t* p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+    __attribute__((target("avx2"))) static V set1(int32_t x) {
+        return _mm256_set1_epi32(x);
+    }
+    __attribute__((target("avx2"))) static V from_mask(__m256i m) {
+        return m;
+    }
+    __attribute__((target("avx2"))) static V blend(V a, V b, V m) {
+        return _mm256_blendv_epi8(a, b, m);
+    }
+    __attribute__((target("avx2"))) static V apply(Add<int32_t>, V a, V b) {
+        return _mm256_add_epi32(a, b);
+    }
+    __attribute__((target("avx2"))) static V apply(Mul<int32_t>, V a, V b) {
+        return _mm256_mullo_epi32(a, b);
+    }
+    __attribute__((target("avx2"))) static void store(int32_t* p, V v) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+    }
+};
+
+template <>
+struct Lanes<float> {
+    using V = __m256;
+    __attribute__((target("avx2"))) static V load(const float* p) {
+        return _mm256_loadu_ps(p);
+    }
+    __attribute__((target("avx2"))) static V set1(float x) {
+        return _mm256_set1_ps(x);
+    }
+    __attribute__((target("avx2"))) static V from_mask(__m256i m) {
+        return _mm256_castsi256_ps(m);
+    }
+    __attribute__((target("avx2"))) static V blend(V a, V b, V m) {
+        return _mm256_blendv_ps(a, b, m);
+    }
+    __attribute__((target("avx2"))) static V apply(Add<float>, V a, V b) {
+        return _mm256_add_ps(a, b);
+    }
+    __attribute__((target("avx2"))) static V apply(Mul<float>, V a, V b) {
+        return _mm256_mul_ps(a, b);
+    }
+    __attribute__((target("avx2"))) static void store(float* p, V v) {
+        _mm256_storeu_ps(p, v);
+    }
+};
+
+// Lane masks for the eight elements starting at i. They hold only scalars
+// so they can be built outside AVX2 code; the vectors are made inline.
+template <typename T>
+struct RangeMask {
+    T lo, hi;
+    template <typename V>
+    __attribute__((target("avx2"))) V operator()(size_t, V x) const {
+        return range_mask(x, Lanes<T>::set1(lo), Lanes<T>::set1(hi));
+    }
+};
+
+template <typename T>
+struct BitmapMask {
+    const uint8_t* bytes;
+    template <typename V>
+    __attribute__((target("avx2"))) V operator()(size_t i, V) const {
+        return Lanes<T>::from_mask(bits_mask(bytes[i / 8]));
+    }
+};
+
+// Two vector accumulators over 16 elements per iteration
+template <typename T, typename Op, typename Mask>
+__attribute__((target("avx2"))) T simd(const T* data, size_t n, Mask mask) {
+    using L = Lanes<T>;
+    using V = typename L::V;
+    const V id = L::set1(Op::identity);
+    V acc0 = id, acc1 = id;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        V x0 = L::load(data + i);
+        V x1 = L::load(data + i + 8);
+        acc0 = L::apply(Op(), acc0, L::blend(id, x0, mask(i, x0)));
+        acc1 = L::apply(Op(), acc1, L::blend(id, x1, mask(i + 8, x1)));
+    }
+    T lanes[8];
+    L::store(lanes, L::apply(Op(), acc0, acc1));
+    T acc = Op::identity;
+    for (int k = 0; k < 8; k++)
+        acc = Op::apply(acc, lanes[k]);
+    return acc;
+}
+
+template <typename T>
+inline constexpr bool has_simd =
+    std::is_same_v<T, int32_t> || std::is_same_v<T, float>;
+
+template <typename T>
+inline bool simd_ok() {
+    if constexpr (has_simd<T>)
+        return __builtin_cpu_supports("avx2");
+    return false;
+}
+
+} // namespace filter_detail
+
+// dest = op over { v[i] : p(v[i]) }; the identity if nothing matches
+template <typename T>
+void filtered_combine(const Vector<T>& v, const Predicate<T>& p, T& dest,
+                      char op, FilterKernel kernel = FilterKernel::Simd) {
+    using namespace filter_detail;
+    const T* data = v.get_start();
+    size_t n = v.length();
+    auto keep = [p](size_t, T x) { return p(x); };
+    if (kernel == FilterKernel::Simd && !simd_ok<T>())
+        kernel = FilterKernel::Branchless;
+
+    with_op<T>(op, [&](auto o) {
+        using Op = decltype(o);
+        if (kernel == FilterKernel::Branchy) {
+            dest = branchy<T, Op>(data, n, keep);
+            return;
+        }
+        if (kernel == FilterKernel::Branchless) {
+            dest = branchless<T, Op>(data, n, keep);
+            return;
+        }
+        if constexpr (has_simd<T>) {
+            size_t body = n / 16 * 16;
+            T acc = simd<T, Op>(data, body, RangeMask<T>{p.lo, p.hi});
+            T rest = branchless<T, Op>(data + body, n - body, keep);
+            dest = Op::apply(acc, rest);
+        }
+    });
+}
+
+// dest = op over { v[i] : bit i of bitmap is set }; the bitmap must have a
+// bit for every element
+template <typename T>
+void filtered_combine(const Vector<T>& v, const Vector<uint64_t>& bitmap,
+                      T& dest, char op,
+                      FilterKernel kernel = FilterKernel::Simd) {
+    using namespace filter_detail;
+    if (bitmap.length() < (v.length() + 63) / 64)
+        throw std::length_error("filtered_combine: bitmap shorter than data");
+    const T* data = v.get_start();
+    const uint64_t* bits = bitmap.get_start();
+    size_t n = v.length();
+    auto keep = [bits](size_t i, T) { return (bits[i / 64] >> (i % 64)) & 1; };
+    if (kernel == FilterKernel::Simd && !simd_ok<T>())
+        kernel = FilterKernel::Branchless;
+
+    with_op<T>(op, [&](auto o) {
+        using Op = decltype(o);
+        if (kernel == FilterKernel::Branchy) {
+            dest = branchy<T, Op>(data, n, keep);
+            return;
+        }
+        if (kernel == FilterKernel::Branchless) {
+            dest = branchless<T, Op>(data, n, keep);
+            return;
+        }
+        if constexpr (has_simd<T>) {
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(bits);
+            size_t body = n / 16 * 16;
+            T acc = simd<T, Op>(data, body, BitmapMask<T>{bytes});
+            auto rest_keep = [bits, body](size_t i, T) {
+                return (bits[(body + i) / 64] >> ((body + i) % 64)) & 1;
+            };
+            T rest = branchless<T, Op>(data + body, n - body, rest_keep);
+            dest = Op::apply(acc, rest);
+        }
+    });
+}
+
+#endif
@@ -2,13 +2,14 @@
 #include <stdlib.h>
 #include <time.h>
 
+#include "zero.h"
+
+// Build: gcc -O2 -pthread mem.c zero.c -o mem
+
 #define N (1L << 24) // 16 million elements
 
 void clear_array(long* dest, long n) {
-    long i;
-    for (i = 0; i < n; i++) {
-        dest[i] = 0;
-    }
+    zero_bytes(dest, n * sizeof(long), 0);
 }
 
 void write_read(long* src, long* dest, long n) {
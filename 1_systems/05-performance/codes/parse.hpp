@@ -0,0 +1,403 @@
+#ifndef PARSE_HPP
+#define PARSE_HPP
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <immintrin.h>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+#include "vec.hpp"
+
+// Bulk text-to-number ingestion into Vector<T>.
+//
+// Input is decimal numbers separated by any run of delimiters (',', ';',
+// space, tab, CR, LF), i.e. plain CSV or one-number-per-line files.
+//
+// The text is cut into one slice per thread, each boundary moved forward to
+// just past a delimiter so no number straddles two slices. Parsing is two
+// passes over the slices, both in parallel:
+//   1. count: classify 64 bytes at a time into a delimiter bitmask (AVX2)
+//      and popcount the token starts, so the output can be sized exactly
+//   2. parse: walk the token starts again and write each value straight
+//      into its final slot of the pre-sized Vector
+//
+// Integers take 8 digits at a time with SWAR arithmetic. Floats use the
+// exact fast path: when the decimal mantissa and power of ten are both
+// exactly representable, one multiply or divide gives the correctly rounded
+// result. Anything else (long mantissas, large exponents, inf/nan) falls
+// back to std::from_chars, which is also exact, so the result always
+// matches strtof/strtod.
+
+#define PARSE_BLOCK 64
+
+// A malformed or out-of-range number; offset is from the start of the text
+class parse_error : public std::runtime_error {
+public:
+    std::string reason;
+    size_t offset;
+    parse_error(const std::string& reason, size_t offset)
+        : std::runtime_error(reason + " at byte " + std::to_string(offset)),
+          reason(reason), offset(offset) {}
+};
+
+inline bool is_delim(char c) {
+    return c == ',' || c == ';' || c == ' ' || c == '\n' || c == '\r' ||
+           c == '\t';
+}
+
+// Bit i set if p[i] is a delimiter, for n <= 64 bytes
+inline uint64_t delim_mask_scalar(const char* p, size_t n) {
+    uint64_t m = 0;
+    for (size_t i = 0; i < n; i++)
+        m |= uint64_t(is_delim(p[i])) << i;
+    return m;
+}
+
+// Same for a full 64-byte block, with exactly the delimiters of is_delim.
+// Their low nibbles (0, 9, a, d, c, b) are all different, so a shuffle
+// indexed by the low nibble yields the one delimiter a byte could be, and a
+// compare with the byte itself decides. Unused entries hold 0, whose low
+// nibble never matches its index; bytes >= 0x80 shuffle to 0 as well.
+__attribute__((target("avx2"))) inline uint64_t
+delim_mask_avx2(const char* p) {
+    const __m256i table = _mm256_setr_epi8(
+        ' ', 0, 0, 0, 0, 0, 0, 0, 0, '\t', '\n', ';', ',', '\r', 0, 0,
+        ' ', 0, 0, 0, 0, 0, 0, 0, 0, '\t', '\n', ';', ',', '\r', 0, 0);
+    uint64_t m = 0;
+    for (int h = 0; h < 2; h++) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(p + 32 * h));
+        __m256i d = _mm256_cmpeq_epi8(_mm256_shuffle_epi8(table, x), x);
+        m |= uint64_t(uint32_t(_mm256_movemask_epi8(d))) << (32 * h);
+    }
+    return m;
+}
+
+// Token starts in a block: non-delimiters whose previous byte is a
+// delimiter. prev_delim carries bit 63 of the previous block.
+inline uint64_t token_starts(uint64_t delim, uint64_t valid, bool& prev_delim) {
+    uint64_t nd = ~delim & valid;
+    uint64_t starts = nd & ~((nd << 1) | uint64_t(!prev_delim));
+    prev_delim = !(nd >> 63);
+    return starts;
+}
+
+// Calls f(start, end) for every token [start, end) in [0, n), in order.
+// The end comes from the same bitmask unless the token runs past the block.
+template <typename F>
+inline void for_each_token(const char* p, size_t n, bool simd, F&& f) {
+    bool prev_delim = true;
+    for (size_t base = 0; base < n; base += PARSE_BLOCK) {
+        size_t m = std::min<size_t>(PARSE_BLOCK, n - base);
+        uint64_t valid = m == 64 ? ~uint64_t(0) : (uint64_t(1) << m) - 1;
+        uint64_t delim = (simd && m == 64) ? delim_mask_avx2(p + base)
+                                           : delim_mask_scalar(p + base, m);
+        uint64_t starts = token_starts(delim, valid, prev_delim);
+        while (starts) {
+            int bit = std::countr_zero(starts);
+            uint64_t after = delim >> bit;
+            size_t end;
+            if (after) {
+                end = base + bit + std::countr_zero(after);
+            } else {
+                end = base + m;
+                while (end < n && !is_delim(p[end]))
+                    end++;
+            }
+            f(base + bit, end);
+            starts &= starts - 1;
+        }
+    }
+}
+
+inline size_t count_tokens(const char* p, size_t n, bool simd) {
+    size_t count = 0;
+    bool prev_delim = true;
+    for (size_t base = 0; base < n; base += PARSE_BLOCK) {
+        size_t m = std::min<size_t>(PARSE_BLOCK, n - base);
+        uint64_t valid = m == 64 ? ~uint64_t(0) : (uint64_t(1) << m) - 1;
+        uint64_t delim = (simd && m == 64) ? delim_mask_avx2(p + base)
+                                           : delim_mask_scalar(p + base, m);
+        count += std::popcount(token_starts(delim, valid, prev_delim));
+    }
+    return count;
+}
+
+// Eight ASCII digits at p -> their value, or -1 if any byte is not a digit
+inline int64_t parse_8digits(const char* p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    v -= 0x3030303030303030ull;
+    // a byte outside 0..9 now has a high nibble set, before or after +6
+    if ((v | (v + 0x0606060606060606ull)) & 0xf0f0f0f0f0f0f0f0ull)
+        return -1;
+    v = v * 10 + (v >> 8); // pairs of digits
+    v = (((v & 0x000000ff000000ffull) * (100 + (1000000ull << 32))) +
+         (((v >> 16) & 0x000000ff000000ffull) * (1 + (10000ull << 32)))) >>
+        32;
+    return int64_t(v);
+}
+
+// Parses the integer token at [p, end); returns false if malformed or out
+// of range for T
+template <typename T>
+inline bool parse_int_token(const char* p, const char* end, T& out) {
+    bool neg = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        neg = *p == '-';
+        p++;
+    }
+    if (p == end)
+        return false;
+    // leading zeros don't count towards the 19-digit limit
+    while (p < end && *p == '0')
+        p++;
+    const char* digits = p;
+    uint64_t v = 0;
+    // at most 16 digits in blocks of 8, the rest one at a time; 19 digits
+    // always fit in uint64
+    while (end - p >= 8 && p - digits <= 8) {
+        int64_t d8 = parse_8digits(p);
+        if (d8 < 0)
+            break;
+        v = v * 100000000 + uint64_t(d8);
+        p += 8;
+    }
+    for (; p < end; p++) {
+        unsigned d = unsigned(*p - '0');
+        if (d > 9 || p - digits >= 19)
+            return false;
+        v = v * 10 + d;
+    }
+    using U = std::make_unsigned_t<T>;
+    uint64_t limit = uint64_t(std::numeric_limits<T>::max()) + neg;
+    if (std::is_unsigned_v<T>)
+        limit = neg ? 0 : uint64_t(std::numeric_limits<U>::max());
+    if (v > limit)
+        return false;
+    out = neg ? T(U(0) - U(v)) : T(v);
+    return true;
+}
+
+// Exact powers of ten for the fast path
+template <typename T>
+struct FastFloat;
+
+template <>
+struct FastFloat<float> {
+    static constexpr uint64_t max_mantissa = uint64_t(1) << 24;
+    static constexpr int max_pow = 10;
+    static constexpr float pow10[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f,
+                                      1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+};
+
+template <>
+struct FastFloat<double> {
+    static constexpr uint64_t max_mantissa = uint64_t(1) << 53;
+    static constexpr int max_pow = 22;
+    static constexpr double pow10[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+};
+
+template <typename T>
+inline bool parse_float_slow(const char* p, const char* end, T& out) {
+    if (p < end && *p == '+') // from_chars rejects an explicit plus
+        p++;
+    auto [ptr, ec] = std::from_chars(p, end, out);
+    return ec == std::errc() && ptr == end;
+}
+
+// Parses the float token at [p, end): w * 10^e with w and 10^|e| exact in
+// T needs a single rounding, otherwise defer to from_chars
+template <typename T>
+inline bool parse_float_token(const char* p, const char* end, T& out) {
+    const char* start = p;
+    bool neg = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        neg = *p == '-';
+        p++;
+    }
+    uint64_t w = 0;
+    int digits = 0, exp10 = 0;
+    bool any = false;
+    for (; p < end && unsigned(*p - '0') <= 9; p++, any = true) {
+        if (digits < 19) {
+            w = w * 10 + unsigned(*p - '0');
+            digits += w != 0;
+        } else {
+            exp10++;
+            digits = 20; // dropped a digit: not exact
+        }
+    }
+    if (p < end && *p == '.') {
+        for (p++; p < end && unsigned(*p - '0') <= 9; p++, any = true) {
+            if (digits < 19) {
+                w = w * 10 + unsigned(*p - '0');
+                digits += w != 0;
+                exp10--;
+            } else {
+                digits = 20;
+            }
+        }
+    }
+    if (any && p < end && (*p == 'e' || *p == 'E')) {
+        const char* q = p + 1;
+        bool eneg = false;
+        if (q < end && (*q == '-' || *q == '+'))
+            eneg = *q++ == '-';
+        int e = 0;
+        bool edigits = false;
+        for (; q < end && unsigned(*q - '0') <= 9; q++, edigits = true)
+            e = std::min(e * 10 + (*q - '0'), 100000);
+        if (edigits) {
+            exp10 += eneg ? -e : e;
+            p = q;
+        }
+    }
+    using F = FastFloat<T>;
+    if (!any || p != end || digits > 19 || w > F::max_mantissa ||
+        exp10 < -F::max_pow || exp10 > F::max_pow)
+        return parse_float_slow(start, end, out);
+    T v = T(w);
+    v = exp10 < 0 ? v / F::pow10[-exp10] : v * F::pow10[exp10];
+    out = neg ? -v : v;
+    return true;
+}
+
+template <typename T>
+inline bool parse_token(const char* p, const char* end, T& out) {
+    if constexpr (std::is_integral_v<T>)
+        return parse_int_token(p, end, out);
+    else
+        return parse_float_token(p, end, out);
+}
+
+// Parses every token of [p, p + n) into out[0..); returns the number
+// written. Throws parse_error with the offset relative to p.
+template <typename T>
+size_t parse_slice(const char* p, size_t n, T* out, bool simd) {
+    size_t k = 0;
+    for_each_token(p, n, simd, [&](size_t start, size_t end) {
+        if (!parse_token(p + start, p + end, out[k]))
+            throw parse_error("bad number \"" +
+                                  std::string(p + start, p + end) + "\"",
+                              start);
+        k++;
+    });
+    return k;
+}
+
+// Splits [0, n) into up to nslices ranges that all begin right after a
+// delimiter (or at 0) and end right after one (or at n)
+inline std::vector<size_t> slice_bounds(const char* p, size_t n,
+                                        size_t nslices) {
+    std::vector<size_t> b = {0};
+    for (size_t i = 1; i < nslices; i++) {
+        size_t pos = std::max(n * i / nslices, b.back());
+        while (pos < n && !is_delim(p[pos]))
+            pos++;
+        b.push_back(std::min(pos + (pos < n), n));
+    }
+    b.push_back(n);
+    return b;
+}
+
+// Parses [text, text + len) into a Vector sized to the exact number count,
+// with nthreads threads (0: one per hardware thread)
+template <typename T>
+Vector<T> parse_numbers(const char* text, size_t len, unsigned nthreads = 0,
+                        bool simd = true,
+                        std::pmr::memory_resource* mr =
+                            std::pmr::get_default_resource()) {
+    static_assert(std::is_arithmetic_v<T>);
+    simd = simd && __builtin_cpu_supports("avx2");
+    if (nthreads == 0)
+        nthreads = std::max(1u, std::thread::hardware_concurrency());
+    // slices below ~1MB are not worth a thread
+    nthreads = std::max<size_t>(1, std::min<size_t>(nthreads, len >> 20));
+    std::vector<size_t> b = slice_bounds(text, len, nthreads);
+
+    auto run = [&](auto&& body) {
+        std::vector<std::thread> threads;
+        for (unsigned t = 1; t < nthreads; t++)
+            threads.emplace_back(body, t);
+        body(0);
+        for (auto& th : threads)
+            th.join();
+    };
+
+    // Pass 1: count, then turn the counts into output offsets
+    std::vector<size_t> first(nthreads + 1, 0);
+    run([&](unsigned t) {
+        first[t + 1] = count_tokens(text + b[t], b[t + 1] - b[t], simd);
+    });
+    for (unsigned t = 0; t < nthreads; t++)
+        first[t + 1] += first[t];
+
+    // Pass 2: parse into place; the first error (by position) wins
+    Vector<T> v(first[nthreads], no_init, mr);
+    std::vector<std::exception_ptr> errors(nthreads);
+    run([&](unsigned t) {
+        try {
+            parse_slice(text + b[t], b[t + 1] - b[t], v.get_start() + first[t],
+                        simd);
+        } catch (const parse_error& e) {
+            errors[t] = std::make_exception_ptr(
+                parse_error(e.reason, b[t] + e.offset));
+        }
+    });
+    for (auto& e : errors) {
+        if (e)
+            std::rethrow_exception(e);
+    }
+    return v;
+}
+
+// Maps a text file and parses it; throws std::system_error on I/O failure
+template <typename T>
+Vector<T> parse_file(const char* path, unsigned nthreads = 0,
+                     bool simd = true) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        throw std::system_error(errno, std::generic_category(), path);
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        int err = errno;
+        close(fd);
+        throw std::system_error(err, std::generic_category(), path);
+    }
+    size_t len = st.st_size;
+    if (len == 0) {
+        close(fd);
+        return Vector<T>(0);
+    }
+    void* p = mmap(nullptr, len, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    int err = errno;
+    close(fd);
+    if (p == MAP_FAILED)
+        throw std::system_error(err, std::generic_category(), path);
+    try {
+        Vector<T> v = parse_numbers<T>(static_cast<const char*>(p), len,
+                                       nthreads, simd);
+        munmap(p, len);
+        return v;
+    } catch (...) {
+        munmap(p, len);
+        throw;
+    }
+}
+
+#endif
@@ -0,0 +1,186 @@
+#include <charconv>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <sstream>
+#include <string>
+
+#include "parse.hpp"
+
+// Text ingestion benchmark: generate CSV-style text for a few number
+// formats, then parse it back with strtol/strtof, iostreams and
+// parse_numbers (scalar, AVX2 delimiter scan, several threads). Every
+// result is compared bit for bit against strtol/strtof.
+//
+// Build: g++ -std=c++20 -O2 -pthread parse_bench.cpp -o parse_bench
+// Usage: ./parse_bench [numbers] [threads]
+
+static double now_sec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+template <typename T>
+static T strto(const char* p, char** end) {
+    if constexpr (std::is_same_v<T, int32_t>)
+        return T(strtol(p, end, 10));
+    else if constexpr (std::is_same_v<T, int64_t>)
+        return T(strtoll(p, end, 10));
+    else if constexpr (std::is_same_v<T, float>)
+        return strtof(p, end);
+    else
+        return strtod(p, end);
+}
+
+// strtol-family loop; the text is NUL-terminated
+template <typename T>
+static Vector<T> parse_strto(const std::string& text, size_t n) {
+    Vector<T> v(n, no_init);
+    const char* p = text.c_str();
+    for (size_t i = 0; i < n; i++) {
+        char* end;
+        v[i] = strto<T>(p, &end);
+        p = end + 1; // skip the single delimiter
+    }
+    return v;
+}
+
+template <typename T>
+static Vector<T> parse_stream(const std::string& text, size_t n) {
+    Vector<T> v(n, no_init);
+    std::istringstream in(text);
+    for (size_t i = 0; i < n; i++) {
+        in >> v[i];
+        in.get(); // the delimiter
+    }
+    return v;
+}
+
+template <typename T>
+static bool same(const Vector<T>& a, const Vector<T>& b) {
+    return a.length() == b.length() &&
+           memcmp(a.get_start(), b.get_start(), a.length() * sizeof(T)) == 0;
+}
+
+// The parsed values, or the error, as text
+template <typename T>
+static std::string outcome(const std::string& text, bool simd) {
+    try {
+        Vector<T> v = parse_numbers<T>(text.data(), text.size(), 1, simd);
+        std::string s;
+        for (size_t i = 0; i < v.length(); i++)
+            s += std::to_string(v[i]) + " ";
+        return s;
+    } catch (const parse_error& e) {
+        return e.what();
+    }
+}
+
+template <typename T>
+static void run(const char* name, const std::string& text, size_t n,
+                unsigned threads) {
+    double mb = text.size() / 1e6;
+    auto report = [&](const char* how, double t, bool ok) {
+        printf("  %-22s %8.0f MB/s %s\n", how, mb / t, ok ? "" : "MISMATCH");
+    };
+    printf("%s: %zu numbers, %.1f MB\n", name, n, mb);
+
+    double t0 = now_sec();
+    Vector<T> ref = parse_strto<T>(text, n);
+    report("strtol/strtof", now_sec() - t0, true);
+
+    t0 = now_sec();
+    Vector<T> s = parse_stream<T>(text, n);
+    // iostreams reject subnormal floats, so only the fast path is compared
+    report("istringstream", now_sec() - t0,
+           std::is_floating_point_v<T> || same(s, ref));
+
+    t0 = now_sec();
+    Vector<T> a = parse_numbers<T>(text.data(), text.size(), 1, false);
+    report("parse, scalar scan", now_sec() - t0, same(a, ref));
+
+    t0 = now_sec();
+    Vector<T> b = parse_numbers<T>(text.data(), text.size(), 1, true);
+    report("parse, avx2 scan", now_sec() - t0, same(b, ref));
+
+    t0 = now_sec();
+    Vector<T> c = parse_numbers<T>(text.data(), text.size(), threads, true);
+    char how[32];
+    snprintf(how, sizeof(how), "parse, %u threads", threads);
+    report(how, now_sec() - t0, same(c, ref));
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? strtoul(argv[1], nullptr, 10) : 5 << 20;
+    unsigned threads = argc > 2 ? atoi(argv[2]) : 4;
+    std::mt19937_64 gen(42);
+    char buf[64];
+
+    // Integers of every width, one per line
+    std::string ints;
+    for (size_t i = 0; i < n; i++) {
+        int32_t x = int32_t(gen()) >> (gen() % 32);
+        ints.append(buf, snprintf(buf, sizeof(buf), "%d\n", x));
+    }
+    run<int32_t>("int32, newline", ints, n, threads);
+
+    std::string longs;
+    for (size_t i = 0; i < n; i++) {
+        int64_t x = int64_t(gen()) >> (gen() % 64);
+        longs.append(buf, snprintf(buf, sizeof(buf), "%" PRId64 ",", x));
+    }
+    run<int64_t>("int64, comma", longs, n, threads);
+
+    // Prices: few decimals, all on the exact fast path
+    std::uniform_real_distribution<double> price(0, 10000);
+    std::string prices;
+    for (size_t i = 0; i < n; i++)
+        prices.append(buf, snprintf(buf, sizeof(buf), "%.2f,", price(gen)));
+    run<float>("float, %.2f", prices, n, threads);
+
+    // Full precision with exponents: mostly the from_chars fallback
+    std::string sci;
+    for (size_t i = 0; i < n; i++) {
+        double x = std::ldexp(price(gen), int(gen() % 200) - 100);
+        sci.append(buf, snprintf(buf, sizeof(buf), "%.9g\n", x));
+    }
+    run<float>("float, %.9g", sci, n, threads);
+
+    std::string doubles;
+    for (size_t i = 0; i < n; i++)
+        doubles.append(buf, snprintf(buf, sizeof(buf), "%.6f ", price(gen)));
+    run<double>("double, %.6f", doubles, n, threads);
+
+    // Scalar and AVX2 scans must split the same way wherever the bytes land
+    // in a block: a form feed is not a delimiter in either, and leading
+    // zeros don't count as digits
+    for (std::string odd : {"1,2;3 4\t5\r\n00000000000000000006", "12\f34"}) {
+        odd.insert(0, 60, ' ');
+        for (size_t shift = 0; shift < 64; shift++) {
+            std::string a = outcome<int64_t>(odd, false);
+            std::string b = outcome<int64_t>(odd, true);
+            if (a != b) {
+                printf("\nscalar and avx2 scans disagree at shift %zu: "
+                       "%s / %s\n",
+                       shift, a.c_str(), b.c_str());
+                return 1;
+            }
+            odd.insert(0, 1, ' ');
+        }
+    }
+    std::string zeros = "00000000000000000001,-0000000000000000000000042";
+    printf("\n\"%s\": %s\n", zeros.c_str(),
+           outcome<int64_t>(zeros, true).c_str());
+
+    // Errors point at the offending byte
+    std::string bad = "1,2,3,4x,5";
+    try {
+        parse_numbers<int>(bad.data(), bad.size());
+    } catch (const parse_error& e) {
+        printf("\n\"%s\": %s\n", bad.c_str(), e.what());
+    }
+    return 0;
+}
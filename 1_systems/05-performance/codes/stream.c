@@ -0,0 +1,302 @@
+#define _GNU_SOURCE
+#include <float.h>
+#include <immintrin.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * STREAM-style bandwidth suite: copy / scale / add / triad, 1..all cores,
+ * optionally pinned to one NUMA node, with regular and non-temporal stores.
+ *
+ * Build: gcc -O2 -pthread stream.c -o stream
+ * Usage: ./stream [elements per array] [numa node]
+ */
+
+#define NTIMES 10
+#define MAX_CPUS 1024
+
+typedef enum { COPY, SCALE, ADD, TRIAD, NUM_KERNELS } kernel_id;
+
+static const char* kernel_names[] = {"copy", "scale", "add", "triad"};
+/* Arrays touched per element: reads + writes */
+static const int kernel_arrays[] = {2, 2, 3, 3};
+
+static double *a, *b, *c;
+static long array_len;
+static const double scalar = 3.0;
+
+static int cpus[MAX_CPUS];
+static int num_cpus;
+
+static pthread_barrier_t barrier;
+static double times[2][NUM_KERNELS][NTIMES];
+
+typedef struct {
+    int id;
+    int nthreads;
+} worker_arg;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Regular stores, left to the compiler to vectorize */
+static void run_kernel(kernel_id k, long lo, long hi) {
+    long i;
+    switch (k) {
+    case COPY:
+        for (i = lo; i < hi; i++)
+            c[i] = a[i];
+        break;
+    case SCALE:
+        for (i = lo; i < hi; i++)
+            b[i] = scalar * c[i];
+        break;
+    case ADD:
+        for (i = lo; i < hi; i++)
+            c[i] = a[i] + b[i];
+        break;
+    case TRIAD:
+        for (i = lo; i < hi; i++)
+            a[i] = b[i] + scalar * c[i];
+        break;
+    default:
+        break;
+    }
+}
+
+/*
+ * Non-temporal stores skip the read-for-ownership of the destination line,
+ * so they move 2/3 (copy) or 3/4 (add) of the traffic of regular stores.
+ * Slices start on a 32-byte boundary (see slice_bounds).
+ */
+__attribute__((target("avx2"))) static void run_kernel_nt(kernel_id k,
+                                                          long lo, long hi) {
+    __m256d s = _mm256_set1_pd(scalar);
+    long i = lo;
+    switch (k) {
+    case COPY:
+        for (; i + 4 <= hi; i += 4)
+            _mm256_stream_pd(c + i, _mm256_load_pd(a + i));
+        break;
+    case SCALE:
+        for (; i + 4 <= hi; i += 4)
+            _mm256_stream_pd(b + i, _mm256_mul_pd(s, _mm256_load_pd(c + i)));
+        break;
+    case ADD:
+        for (; i + 4 <= hi; i += 4)
+            _mm256_stream_pd(c + i, _mm256_add_pd(_mm256_load_pd(a + i),
+                                                  _mm256_load_pd(b + i)));
+        break;
+    case TRIAD:
+        for (; i + 4 <= hi; i += 4)
+            _mm256_stream_pd(
+                a + i, _mm256_add_pd(_mm256_load_pd(b + i),
+                                     _mm256_mul_pd(s, _mm256_load_pd(c + i))));
+        break;
+    default:
+        break;
+    }
+    _mm_sfence();
+    run_kernel(k, i, hi);
+}
+
+/* Split [0, array_len) into slices aligned to 4 doubles */
+static void slice_bounds(int id, int nthreads, long* lo, long* hi) {
+    long chunk = (array_len / nthreads + 3) & ~3L;
+    *lo = chunk * id;
+    *hi = (id == nthreads - 1) ? array_len : chunk * (id + 1);
+    if (*lo > array_len)
+        *lo = array_len;
+    if (*hi > array_len)
+        *hi = array_len;
+}
+
+static void* worker(void* argp) {
+    worker_arg* arg = (worker_arg*)argp;
+    long lo, hi;
+    slice_bounds(arg->id, arg->nthreads, &lo, &hi);
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpus[arg->id % num_cpus], &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+
+    /* First touch from the owning thread places pages on its node */
+    for (long i = lo; i < hi; i++) {
+        a[i] = 1.0;
+        b[i] = 2.0;
+        c[i] = 0.0;
+    }
+
+    int use_nt = __builtin_cpu_supports("avx2");
+    for (int nt = 0; nt < 2; nt++) {
+        for (int k = 0; k < NUM_KERNELS; k++) {
+            for (int r = 0; r < NTIMES; r++) {
+                double t0 = 0;
+                pthread_barrier_wait(&barrier);
+                if (arg->id == 0)
+                    t0 = now_sec();
+                if (nt && use_nt)
+                    run_kernel_nt(k, lo, hi);
+                else
+                    run_kernel(k, lo, hi);
+                pthread_barrier_wait(&barrier);
+                if (arg->id == 0)
+                    times[nt][k][r] = now_sec() - t0;
+            }
+        }
+    }
+    return NULL;
+}
+
+/* Parse a sysfs cpulist such as "0-3,8-11" */
+static int parse_cpulist(const char* s, int* out, int max) {
+    int n = 0;
+    while (*s && n < max) {
+        char* end;
+        long lo = strtol(s, &end, 10);
+        if (end == s)
+            break;
+        long hi = lo;
+        if (*end == '-')
+            hi = strtol(end + 1, &end, 10);
+        for (long cpu = lo; cpu <= hi && n < max; cpu++)
+            out[n++] = (int)cpu;
+        s = (*end == ',') ? end + 1 : end;
+    }
+    return n;
+}
+
+static int load_cpus(int node) {
+    if (node >= 0) {
+        char path[128], buf[4096];
+        snprintf(path, sizeof(path),
+                 "/sys/devices/system/node/node%d/cpulist", node);
+        FILE* f = fopen(path, "r");
+        if (!f)
+            return 0;
+        int ok = fgets(buf, sizeof(buf), f) != NULL;
+        fclose(f);
+        return ok ? parse_cpulist(buf, cpus, MAX_CPUS) : 0;
+    }
+
+    cpu_set_t set;
+    int n = 0;
+    sched_getaffinity(0, sizeof(set), &set);
+    for (int cpu = 0; cpu < CPU_SETSIZE && n < MAX_CPUS; cpu++) {
+        if (CPU_ISSET(cpu, &set))
+            cpus[n++] = cpu;
+    }
+    return n;
+}
+
+static size_t array_bytes(void) {
+    return (array_len * sizeof(double) + 63) & ~(size_t)63;
+}
+
+/*
+ * Fresh anonymous mappings for every suite: no page is resident until a
+ * worker's first touch, so each thread count gets its own placement
+ * instead of reusing the pages the previous suite placed.
+ */
+static int map_arrays(void) {
+    double** arrays[] = {&a, &b, &c};
+    for (int i = 0; i < 3; i++) {
+        void* p = mmap(NULL, array_bytes(), PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED)
+            return -1;
+        *arrays[i] = p;
+    }
+    return 0;
+}
+
+static void unmap_arrays(void) {
+    double** arrays[] = {&a, &b, &c};
+    for (int i = 0; i < 3; i++) {
+        if (*arrays[i])
+            munmap(*arrays[i], array_bytes());
+        *arrays[i] = NULL;
+    }
+}
+
+static int run_suite(int nthreads) {
+    pthread_t tids[MAX_CPUS];
+    worker_arg args[MAX_CPUS];
+
+    if (map_arrays() < 0) {
+        unmap_arrays();
+        return -1;
+    }
+
+    pthread_barrier_init(&barrier, NULL, nthreads);
+    for (int t = 0; t < nthreads; t++) {
+        args[t].id = t;
+        args[t].nthreads = nthreads;
+        pthread_create(&tids[t], NULL, worker, &args[t]);
+    }
+    for (int t = 0; t < nthreads; t++) {
+        pthread_join(tids[t], NULL);
+    }
+    pthread_barrier_destroy(&barrier);
+    unmap_arrays();
+
+    for (int nt = 0; nt < 2; nt++) {
+        printf("%7d  %-4s", nthreads, nt ? "nt" : "std");
+        for (int k = 0; k < NUM_KERNELS; k++) {
+            /* Like STREAM, skip the first iteration and report the best */
+            double best = DBL_MAX;
+            for (int r = 1; r < NTIMES; r++) {
+                if (times[nt][k][r] < best)
+                    best = times[nt][k][r];
+            }
+            double bytes = (double)kernel_arrays[k] * sizeof(double) *
+                           array_len;
+            printf(" %10.2f", bytes / best / 1e9);
+        }
+        printf("\n");
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    array_len = argc > 1 ? atol(argv[1]) : 1L << 25; /* 256 MB per array */
+    int node = argc > 2 ? atoi(argv[2]) : -1;
+
+    num_cpus = load_cpus(node);
+    if (num_cpus == 0) {
+        fprintf(stderr, "No usable CPUs for node %d\n", node);
+        return 1;
+    }
+
+    printf("array: %ld doubles (%.1f MB each), cpus: %d", array_len,
+           array_bytes() / 1048576.0, num_cpus);
+    if (node >= 0)
+        printf(", node %d", node);
+    printf("\n\n%7s  %-4s %10s %10s %10s %10s  (GB/s)\n", "threads", "st",
+           kernel_names[COPY], kernel_names[SCALE], kernel_names[ADD],
+           kernel_names[TRIAD]);
+
+    /* 1, 2, 4, ... and always the full count */
+    for (int n = 1;; n *= 2) {
+        if (n > num_cpus)
+            n = num_cpus;
+        if (run_suite(n) < 0) {
+            perror("mmap failed");
+            return 1;
+        }
+        if (n == num_cpus)
+            break;
+    }
+    return 0;
+}
@@ -232,7 +232,7 @@ void combine5(vec_ptr v, void* dest, int is_float, int ident_val, char op) {
         }
 
         /* Finish any remaining elements */
-        for (long i = limit - (limit % 2); i < length; i++) {
+        for (long i = length - (length % 2); i < length; i++) {
             switch (op) {
             case '+':
                 acc = acc + data[i];
@@ -263,7 +263,7 @@ void combine5(vec_ptr v, void* dest, int is_float, int ident_val, char op) {
         }
 
         /* Finish any remaining elements */
-        for (long i = limit - (limit % 2); i < length; i++) {
+        for (long i = length - (length % 2); i < length; i++) {
             switch (op) {
             case '+':
                 acc = acc + data[i];
@@ -302,7 +302,7 @@ void combine6(vec_ptr v, void* dest, int is_float, int ident_val, char op) {
         }
 
         /* Finish any remaining elements */
-        for (long i = limit - (limit % 2); i < length; i++) {
+        for (long i = length - (length % 2); i < length; i++) {
             switch (op) {
             case '+':
                 acc0 = acc0 + data[i];
@@ -345,7 +345,7 @@ void combine6(vec_ptr v, void* dest, int is_float, int ident_val, char op) {
         }
 
         /* Finish any remaining elements */
-        for (long i = limit - (limit % 2); i < length; i++) {
+        for (long i = length - (length % 2); i < length; i++) {
             switch (op) {
             case '+':
                 acc0 = acc0 + data[i];
@@ -390,7 +390,7 @@ void combine7(vec_ptr v, void* dest, int is_float, int ident_val, char op) {
         }
 
         /* Finish any remaining elements */
-        for (long i = limit - (limit % 2); i < length; i++) {
+        for (long i = length - (length % 2); i < length; i++) {
             switch (op) {
             case '+':
                 acc = acc + data[i];
@@ -421,7 +421,7 @@ void combine7(vec_ptr v, void* dest, int is_float, int ident_val, char op) {
         }
 
         /* Finish any remaining elements */
-        for (long i = limit - (limit % 2); i < length; i++) {
+        for (long i = length - (length % 2); i < length; i++) {
             switch (op) {
             case '+':
                 acc = acc + data[i];
@@ -0,0 +1,336 @@
+#ifndef VEC_HPP
+#define VEC_HPP
+
+#include <cstddef>
+#include <functional>
+#include <memory_resource>
+#include <new>
+#include <random>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Allocator that default-initializes on resize() instead of value-initializing,
+// so Vector(len, no_init) leaves trivial elements unwritten
+template <typename T>
+class default_init_allocator : public std::pmr::polymorphic_allocator<T> {
+public:
+    using std::pmr::polymorphic_allocator<T>::polymorphic_allocator;
+
+    default_init_allocator() = default;
+
+    template <typename U>
+    default_init_allocator(const default_init_allocator<U>& other) noexcept
+        : std::pmr::polymorphic_allocator<T>(other.resource()) {}
+
+    // Copies go back to the default resource, like std::pmr containers
+    default_init_allocator select_on_container_copy_construction() const {
+        return default_init_allocator();
+    }
+
+    template <typename U>
+    void construct(U* p) noexcept(std::is_nothrow_default_constructible_v<U>) {
+        ::new (static_cast<void*>(p)) U;
+    }
+
+    template <typename U, typename... Args>
+    void construct(U* p, Args&&... args) {
+        std::pmr::polymorphic_allocator<T>::construct(
+            p, std::forward<Args>(args)...);
+    }
+};
+
+// Tag for constructing a Vector without initializing its elements
+struct no_init_t {
+    explicit no_init_t() = default;
+};
+inline constexpr no_init_t no_init{};
+
+// Template Vector class to replace the C-style vec_rec struct
+template <typename T>
+class Vector {
+public:
+    using allocator_type = default_init_allocator<T>;
+
+private:
+    std::vector<T, allocator_type> data;
+
+public:
+    // Constructor to create a vector of specified length, elements are
+    // value-initialized; storage comes from mr (the heap by default)
+    explicit Vector(size_t len, std::pmr::memory_resource* mr =
+                                    std::pmr::get_default_resource())
+        : data(len, T(), allocator_type(mr)) {}
+
+    // Same, but leaves the elements uninitialized for callers that
+    // overwrite every element anyway
+    Vector(size_t len, no_init_t,
+           std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+        : data(allocator_type(mr)) {
+        data.resize(len);
+    }
+
+    // Get vector element at index
+    bool get_element(size_t index, T& dest) const {
+        if (index >= data.size())
+            return false;
+        dest = data[index];
+        return true;
+    }
+
+    // Return length of vector
+    size_t length() const { return data.size(); }
+
+    // Get pointer to the start of the vector data
+    T* get_start() { return data.data(); }
+
+    // Access vector data directly
+    const T* get_start() const { return data.data(); }
+
+    // Memory resource backing this vector
+    std::pmr::memory_resource* resource() const {
+        return data.get_allocator().resource();
+    }
+
+    // Fill vector with random values
+    void fill_random(T min, T max) {
+        std::random_device rd;
+        std::mt19937 gen(rd());
+
+        if constexpr (std::is_integral<T>::value) {
+            std::uniform_int_distribution<T> dist(min, max);
+            for (auto& val : data) {
+                val = dist(gen);
+            }
+        } else {
+            std::uniform_real_distribution<T> dist(min, max);
+            for (auto& val : data) {
+                val = dist(gen);
+            }
+        }
+    }
+
+    // Get element directly
+    T& operator[](size_t index) { return data[index]; }
+
+    // Get element directly (const version)
+    const T& operator[](size_t index) const { return data[index]; }
+};
+
+// Template function type for combine operations
+template <typename T>
+using CombineFunction = std::function<void(const Vector<T>&, T&, char)>;
+
+// Combine implementations - each is now a template function
+
+// Original implementation
+template <typename T>
+void combine1(const Vector<T>& v, T& dest, char op) {
+    // Initialize with identity value based on operation
+    dest = (op == '+') ? T(0) : T(1);
+
+    for (size_t i = 0; i < v.length(); i++) {
+        T val;
+        v.get_element(i, val);
+
+        // Apply operation
+        switch (op) {
+        case '+':
+            dest = dest + val;
+            break;
+        case '*':
+            dest = dest * val;
+            break;
+        }
+    }
+}
+
+// Eliminating Loop Inefficiencies
+template <typename T>
+void combine2(const Vector<T>& v, T& dest, char op) {
+    // Initialize with identity value based on operation
+    dest = (op == '+') ? T(0) : T(1);
+
+    size_t length = v.length();
+    for (size_t i = 0; i < length; i++) {
+        T val;
+        v.get_element(i, val);
+
+        switch (op) {
+        case '+':
+            dest = dest + val;
+            break;
+        case '*':
+            dest = dest * val;
+            break;
+        }
+    }
+}
+
+// Reducing Procedure Calls
+template <typename T>
+void combine3(const Vector<T>& v, T& dest, char op) {
+    // Initialize with identity value based on operation
+    dest = (op == '+') ? T(0) : T(1);
+
+    size_t length = v.length();
+    const T* data = v.get_start();
+
+    for (size_t i = 0; i < length; i++) {
+        switch (op) {
+        case '+':
+            dest = dest + data[i];
+            break;
+        case '*':
+            dest = dest * data[i];
+            break;
+        }
+    }
+}
+
+// Eliminating Unneeded Memory References
+template <typename T>
+void combine4(const Vector<T>& v, T& dest, char op) {
+    size_t length = v.length();
+    const T* data = v.get_start();
+
+    // Use accumulator to avoid repeated memory references
+    T acc = (op == '+') ? T(0) : T(1);
+
+    for (size_t i = 0; i < length; i++) {
+        switch (op) {
+        case '+':
+            acc = acc + data[i];
+            break;
+        case '*':
+            acc = acc * data[i];
+            break;
+        }
+    }
+
+    dest = acc;
+}
+
+// 2 x 1 loop unrolling
+template <typename T>
+void combine5(const Vector<T>& v, T& dest, char op) {
+    size_t length = v.length();
+    size_t limit = length > 0 ? length - 1 : 0; // size_t: no wraparound
+    const T* data = v.get_start();
+
+    // Use accumulator
+    T acc = (op == '+') ? T(0) : T(1);
+
+    // Combine 2 elements at a time
+    for (size_t i = 0; i < limit; i += 2) {
+        switch (op) {
+        case '+':
+            acc = (acc + data[i]) + data[i + 1];
+            break;
+        case '*':
+            acc = (acc * data[i]) * data[i + 1];
+            break;
+        }
+    }
+
+    // Handle remaining elements
+    for (size_t i = length - (length % 2); i < length; i++) {
+        switch (op) {
+        case '+':
+            acc = acc + data[i];
+            break;
+        case '*':
+            acc = acc * data[i];
+            break;
+        }
+    }
+
+    dest = acc;
+}
+
+// 2 x 2 loop unrolling
+template <typename T>
+void combine6(const Vector<T>& v, T& dest, char op) {
+    size_t length = v.length();
+    size_t limit = length > 0 ? length - 1 : 0; // size_t: no wraparound
+    const T* data = v.get_start();
+
+    // Use two accumulators
+    T acc0 = (op == '+') ? T(0) : T(1);
+    T acc1 = (op == '+') ? T(0) : T(1);
+
+    // Combine 2 elements at a time with 2 accumulators
+    for (size_t i = 0; i < limit; i += 2) {
+        switch (op) {
+        case '+':
+            acc0 = acc0 + data[i];
+            acc1 = acc1 + data[i + 1];
+            break;
+        case '*':
+            acc0 = acc0 * data[i];
+            acc1 = acc1 * data[i + 1];
+            break;
+        }
+    }
+
+    // Handle remaining elements
+    for (size_t i = length - (length % 2); i < length; i++) {
+        switch (op) {
+        case '+':
+            acc0 = acc0 + data[i];
+            break;
+        case '*':
+            acc0 = acc0 * data[i];
+            break;
+        }
+    }
+
+    // Combine accumulators
+    switch (op) {
+    case '+':
+        dest = acc0 + acc1;
+        break;
+    case '*':
+        dest = acc0 * acc1;
+        break;
+    }
+}
+
+// 2 x 1a loop unrolling
+template <typename T>
+void combine7(const Vector<T>& v, T& dest, char op) {
+    size_t length = v.length();
+    size_t limit = length > 0 ? length - 1 : 0; // size_t: no wraparound
+    const T* data = v.get_start();
+
+    // Use accumulator
+    T acc = (op == '+') ? T(0) : T(1);
+
+    // Combine 2 elements at a time
+    for (size_t i = 0; i < limit; i += 2) {
+        switch (op) {
+        case '+':
+            acc = acc + (data[i] + data[i + 1]);
+            break;
+        case '*':
+            acc = acc * (data[i] * data[i + 1]);
+            break;
+        }
+    }
+
+    // Handle remaining elements
+    for (size_t i = length - (length % 2); i < length; i++) {
+        switch (op) {
+        case '+':
+            acc = acc + data[i];
+            break;
+        case '*':
+            acc = acc * data[i];
+            break;
+        }
+    }
+
+    dest = acc;
+}
+
+#endif
@@ -0,0 +1,510 @@
+#ifndef VIEW_HPP
+#define VIEW_HPP
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+#include <stdexcept>
+#include <type_traits>
+
+#include "filter.hpp"
+#include "vec.hpp"
+
+// Non-owning views for reducing data that is not one contiguous Vector,
+// without copying it into a fresh Vector first:
+//   ContiguousView  elements [start, start + n) of a Vector or array
+//   StridedView     n elements stride bytes apart, e.g. one field of an
+//                   array of row-major records (see column_of)
+//   IndexedView     base[idx[0]], base[idx[1]], ... for an index list
+//
+// combine4 and combine6 accept any view directly. gather_combine is the
+// fast path for strided and indexed views: AVX2 (8 lanes) or AVX-512
+// (16 lanes) gathers for int32 and float, with software prefetching
+// `prefetch` elements ahead (0 turns it off). Strided access where the
+// hardware prefetcher already keeps up gains little from it; random index
+// lists over data larger than the cache gain the most. Like combine6 the
+// SIMD kernels use several accumulators, so float results may differ in
+// the last bits.
+
+#define VIEW_PREFETCH 64 // default distance, in elements
+#define VIEW_LINE 64
+
+template <typename V>
+concept VectorView = requires(const V& v, size_t i) {
+    typename V::value_type;
+    { v.length() } -> std::convertible_to<size_t>;
+    { v[i] } -> std::convertible_to<typename V::value_type>;
+    { v.address(i) } -> std::convertible_to<const typename V::value_type*>;
+};
+
+template <typename T>
+class ContiguousView {
+private:
+    const T* data;
+    size_t n;
+
+public:
+    using value_type = T;
+
+    ContiguousView(const T* data, size_t n) : data(data), n(n) {}
+    ContiguousView(const Vector<T>& v) : data(v.get_start()), n(v.length()) {}
+    // v[start .. start + n), clamped to v
+    ContiguousView(const Vector<T>& v, size_t start, size_t n)
+        : data(v.get_start() + std::min(start, v.length())),
+          n(std::min(n, v.length() - std::min(start, v.length()))) {}
+
+    size_t length() const { return n; }
+    // Elements from k on
+    ContiguousView tail(size_t k) const { return {data + k, n - k}; }
+    const T& operator[](size_t i) const { return data[i]; }
+    const T* address(size_t i) const { return data + i; }
+};
+
+template <typename T>
+class StridedView {
+private:
+    const char* base;
+    size_t n;
+    ptrdiff_t stride; // bytes
+
+    // Elements of v[start], v[start + step], ... inside a vector of len
+    static size_t count(size_t len, size_t start, size_t step) {
+        if (step == 0)
+            throw std::invalid_argument("StridedView: step must be positive");
+        return start < len ? (len - start + step - 1) / step : 0;
+    }
+
+public:
+    using value_type = T;
+
+    StridedView(const T* first, size_t n, ptrdiff_t stride_bytes)
+        : base(reinterpret_cast<const char*>(first)), n(n),
+          stride(stride_bytes) {}
+
+    // v[start], v[start + step], ... while inside v; empty (pointing at the
+    // end of v) when start is past the end
+    StridedView(const Vector<T>& v, size_t start, size_t step)
+        : StridedView(v.get_start() + std::min(start, v.length()),
+                      count(v.length(), start, step),
+                      ptrdiff_t(step * sizeof(T))) {}
+
+    size_t length() const { return n; }
+    ptrdiff_t stride_bytes() const { return stride; }
+    StridedView tail(size_t k) const { return {address(k), n - k, stride}; }
+    const T* address(size_t i) const {
+        return reinterpret_cast<const T*>(base + ptrdiff_t(i) * stride);
+    }
+    const T& operator[](size_t i) const { return *address(i); }
+};
+
+// Field `field` of recs[0 .. n): a column of row-major records
+template <typename R, typename T>
+StridedView<T> column_of(const R* recs, size_t n, T R::*field) {
+    return StridedView<T>(&(recs->*field), n, ptrdiff_t(sizeof(R)));
+}
+
+template <typename T>
+class IndexedView {
+private:
+    const T* base;
+    const uint32_t* idx;
+    size_t n;
+
+public:
+    using value_type = T;
+
+    IndexedView(const T* base, const uint32_t* idx, size_t n)
+        : base(base), idx(idx), n(n) {}
+    // v[idx[0]], v[idx[1]], ...; every index must be below v.length()
+    IndexedView(const Vector<T>& v, const Vector<uint32_t>& idx)
+        : base(v.get_start()), idx(idx.get_start()), n(idx.length()) {}
+
+    size_t length() const { return n; }
+    IndexedView tail(size_t k) const { return {base, idx + k, n - k}; }
+    const T* data() const { return base; }
+    const uint32_t* indices() const { return idx; }
+    const T* address(size_t i) const { return base + idx[i]; }
+    const T& operator[](size_t i) const { return base[idx[i]]; }
+};
+
+// The combine kernels on views: same code as for Vector, element access
+// through the view
+template <VectorView V>
+void combine4(const V& v, typename V::value_type& dest, char op) {
+    using T = typename V::value_type;
+    size_t length = v.length();
+    T acc = (op == '+') ? T(0) : T(1);
+    for (size_t i = 0; i < length; i++) {
+        switch (op) {
+        case '+':
+            acc = acc + v[i];
+            break;
+        case '*':
+            acc = acc * v[i];
+            break;
+        }
+    }
+    dest = acc;
+}
+
+template <VectorView V>
+void combine6(const V& v, typename V::value_type& dest, char op) {
+    using T = typename V::value_type;
+    size_t length = v.length();
+    size_t limit = length > 0 ? length - 1 : 0; // size_t: no wraparound
+    T acc0 = (op == '+') ? T(0) : T(1);
+    T acc1 = (op == '+') ? T(0) : T(1);
+    for (size_t i = 0; i < limit; i += 2) {
+        switch (op) {
+        case '+':
+            acc0 = acc0 + v[i];
+            acc1 = acc1 + v[i + 1];
+            break;
+        case '*':
+            acc0 = acc0 * v[i];
+            acc1 = acc1 * v[i + 1];
+            break;
+        }
+    }
+    for (size_t i = length - (length % 2); i < length; i++) {
+        switch (op) {
+        case '+':
+            acc0 = acc0 + v[i];
+            break;
+        case '*':
+            acc0 = acc0 * v[i];
+            break;
+        }
+    }
+    switch (op) {
+    case '+':
+        dest = acc0 + acc1;
+        break;
+    case '*':
+        dest = acc0 * acc1;
+        break;
+    }
+}
+
+enum class GatherKernel { Scalar, Avx2, Avx512 };
+
+inline const char* gather_kernel_name(GatherKernel k) {
+    static const char* names[] = {"scalar", "avx2", "avx512"};
+    return names[static_cast<int>(k)];
+}
+
+namespace view_detail {
+
+using filter_detail::Add;
+using filter_detail::Lanes;
+using filter_detail::Mul;
+using filter_detail::with_op;
+
+inline void prefetch(const void* p) {
+    _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+}
+
+// Prefetch elements [i, i + count) of a strided view, one hint per cache
+// line when several elements share one. Prefetches never fault, so reaching
+// past the end is harmless.
+inline void prefetch_strided(const char* base, ptrdiff_t stride, size_t i,
+                             size_t count) {
+    size_t per_line =
+        std::max<size_t>(1, VIEW_LINE / std::max<ptrdiff_t>(1, stride));
+    for (size_t k = 0; k < count; k += per_line)
+        prefetch(base + ptrdiff_t(i + k) * stride);
+}
+
+inline void prefetch_indexed(const void* base, size_t size,
+                             const uint32_t* idx, size_t count) {
+    const char* b = static_cast<const char*>(base);
+    for (size_t k = 0; k < count; k++)
+        prefetch(b + size_t(idx[k]) * size);
+}
+
+// Two accumulators, any T, any view
+template <typename Op, VectorView V>
+typename V::value_type scalar(const V& v, size_t dist) {
+    using T = typename V::value_type;
+    size_t n = v.length();
+    T acc0 = Op::identity, acc1 = Op::identity;
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        if (dist && i + dist + 2 <= n) {
+            prefetch(v.address(i + dist));
+            prefetch(v.address(i + dist + 1));
+        }
+        acc0 = Op::apply(acc0, v[i]);
+        acc1 = Op::apply(acc1, v[i + 1]);
+    }
+    if (i < n)
+        acc0 = Op::apply(acc0, v[i]);
+    return Op::apply(acc0, acc1);
+}
+
+// ---------------- gathers ----------------
+
+// Scale is the byte multiplier of the offsets: 1 for byte offsets (strided),
+// sizeof(T) for element indices
+template <typename T>
+struct Gather;
+
+template <>
+struct Gather<int32_t> {
+    template <int Scale>
+    __attribute__((target("avx2"))) static __m256i g8(const int32_t* base,
+                                                      __m256i off) {
+        return _mm256_i32gather_epi32(reinterpret_cast<const int*>(base), off,
+                                      Scale);
+    }
+    template <int Scale>
+    __attribute__((target("avx512f"))) static __m512i g16(const int32_t* base,
+                                                          __m512i off) {
+        // the masked form with an explicit source: the plain one trips
+        // GCC's -Wmaybe-uninitialized inside the intrinsic header
+        return _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), 0xffff,
+                                           off, base, Scale);
+    }
+};
+
+template <>
+struct Gather<float> {
+    template <int Scale>
+    __attribute__((target("avx2"))) static __m256 g8(const float* base,
+                                                     __m256i off) {
+        return _mm256_i32gather_ps(base, off, Scale);
+    }
+    template <int Scale>
+    __attribute__((target("avx512f"))) static __m512 g16(const float* base,
+                                                         __m512i off) {
+        return _mm512_mask_i32gather_ps(_mm512_setzero_ps(), 0xffff, off,
+                                        base, Scale);
+    }
+};
+
+// Sixteen lanes: the AVX-512 counterpart of Lanes
+template <typename T>
+struct Lanes16;
+
+template <>
+struct Lanes16<int32_t> {
+    using V = __m512i;
+    __attribute__((target("avx512f"))) static V set1(int32_t x) {
+        return _mm512_set1_epi32(x);
+    }
+    __attribute__((target("avx512f"))) static V apply(Add<int32_t>, V a,
+                                                      V b) {
+        return _mm512_add_epi32(a, b);
+    }
+    __attribute__((target("avx512f"))) static V apply(Mul<int32_t>, V a,
+                                                      V b) {
+        return _mm512_mullo_epi32(a, b);
+    }
+    __attribute__((target("avx512f"))) static void store(int32_t* p, V v) {
+        _mm512_storeu_si512(p, v);
+    }
+};
+
+template <>
+struct Lanes16<float> {
+    using V = __m512;
+    __attribute__((target("avx512f"))) static V set1(float x) {
+        return _mm512_set1_ps(x);
+    }
+    __attribute__((target("avx512f"))) static V apply(Add<float>, V a, V b) {
+        return _mm512_add_ps(a, b);
+    }
+    __attribute__((target("avx512f"))) static V apply(Mul<float>, V a, V b) {
+        return _mm512_mul_ps(a, b);
+    }
+    __attribute__((target("avx512f"))) static void store(float* p, V v) {
+        _mm512_storeu_ps(p, v);
+    }
+};
+
+template <typename T, typename Op, size_t N>
+T fold(const T (&lanes)[N]) {
+    T acc = Op::identity;
+    for (size_t k = 0; k < N; k++)
+        acc = Op::apply(acc, lanes[k]);
+    return acc;
+}
+
+// The kernels below handle whole groups of 16 (AVX2) or 32 (AVX-512)
+// elements with two vector accumulators and return how many they did;
+// the caller finishes the tail with the scalar kernel.
+
+template <typename T, typename Op>
+__attribute__((target("avx2"))) T gather_avx2(const StridedView<T>& v,
+                                               size_t dist, size_t& done) {
+    using L = Lanes<T>;
+    using V = typename L::V;
+    const char* base = reinterpret_cast<const char*>(v.address(0));
+    ptrdiff_t s = v.stride_bytes();
+    const __m256i off = _mm256_mullo_epi32(
+        _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(int(s)));
+    const V id = L::set1(Op::identity);
+    V acc0 = id, acc1 = id;
+    size_t n = v.length() / 16 * 16;
+    for (size_t i = 0; i < n; i += 16) {
+        if (dist)
+            prefetch_strided(base, s, i + dist, 16);
+        const T* p = reinterpret_cast<const T*>(base + ptrdiff_t(i) * s);
+        const T* q = reinterpret_cast<const T*>(base + ptrdiff_t(i + 8) * s);
+        acc0 = L::apply(Op(), acc0, Gather<T>::template g8<1>(p, off));
+        acc1 = L::apply(Op(), acc1, Gather<T>::template g8<1>(q, off));
+    }
+    T lanes[8];
+    L::store(lanes, L::apply(Op(), acc0, acc1));
+    done = n;
+    return fold<T, Op>(lanes);
+}
+
+template <typename T, typename Op>
+__attribute__((target("avx512f"))) T
+gather_avx512(const StridedView<T>& v, size_t dist, size_t& done) {
+    using L = Lanes16<T>;
+    using V = typename L::V;
+    const char* base = reinterpret_cast<const char*>(v.address(0));
+    ptrdiff_t s = v.stride_bytes();
+    const __m512i off = _mm512_mullo_epi32(
+        _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+                          15),
+        _mm512_set1_epi32(int(s)));
+    const V id = L::set1(Op::identity);
+    V acc0 = id, acc1 = id;
+    size_t n = v.length() / 32 * 32;
+    for (size_t i = 0; i < n; i += 32) {
+        if (dist)
+            prefetch_strided(base, s, i + dist, 32);
+        const T* p = reinterpret_cast<const T*>(base + ptrdiff_t(i) * s);
+        const T* q = reinterpret_cast<const T*>(base + ptrdiff_t(i + 16) * s);
+        acc0 = L::apply(Op(), acc0, Gather<T>::template g16<1>(p, off));
+        acc1 = L::apply(Op(), acc1, Gather<T>::template g16<1>(q, off));
+    }
+    T lanes[16];
+    L::store(lanes, L::apply(Op(), acc0, acc1));
+    done = n;
+    return fold<T, Op>(lanes);
+}
+
+template <typename T, typename Op>
+__attribute__((target("avx2"))) T gather_avx2(const IndexedView<T>& v,
+                                               size_t dist, size_t& done) {
+    using L = Lanes<T>;
+    using V = typename L::V;
+    const T* base = v.data();
+    const uint32_t* idx = v.indices();
+    const V id = L::set1(Op::identity);
+    V acc0 = id, acc1 = id;
+    size_t n = v.length() / 16 * 16;
+    for (size_t i = 0; i < n; i += 16) {
+        // the index list itself is read sequentially; only the data needs
+        // a hint, and only while the indices to read it from exist
+        if (dist && i + dist + 16 <= v.length())
+            prefetch_indexed(base, sizeof(T), idx + i + dist, 16);
+        __m256i i0 = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(idx + i));
+        __m256i i1 = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(idx + i + 8));
+        acc0 = L::apply(Op(), acc0,
+                        Gather<T>::template g8<sizeof(T)>(base, i0));
+        acc1 = L::apply(Op(), acc1,
+                        Gather<T>::template g8<sizeof(T)>(base, i1));
+    }
+    T lanes[8];
+    L::store(lanes, L::apply(Op(), acc0, acc1));
+    done = n;
+    return fold<T, Op>(lanes);
+}
+
+template <typename T, typename Op>
+__attribute__((target("avx512f"))) T
+gather_avx512(const IndexedView<T>& v, size_t dist, size_t& done) {
+    using L = Lanes16<T>;
+    using V = typename L::V;
+    const T* base = v.data();
+    const uint32_t* idx = v.indices();
+    const V id = L::set1(Op::identity);
+    V acc0 = id, acc1 = id;
+    size_t n = v.length() / 32 * 32;
+    for (size_t i = 0; i < n; i += 32) {
+        if (dist && i + dist + 32 <= v.length())
+            prefetch_indexed(base, sizeof(T), idx + i + dist, 32);
+        __m512i i0 = _mm512_loadu_si512(idx + i);
+        __m512i i1 = _mm512_loadu_si512(idx + i + 16);
+        acc0 = L::apply(Op(), acc0,
+                        Gather<T>::template g16<sizeof(T)>(base, i0));
+        acc1 = L::apply(Op(), acc1,
+                        Gather<T>::template g16<sizeof(T)>(base, i1));
+    }
+    T lanes[16];
+    L::store(lanes, L::apply(Op(), acc0, acc1));
+    done = n;
+    return fold<T, Op>(lanes);
+}
+
+template <typename T>
+inline constexpr bool has_gather =
+    std::is_same_v<T, int32_t> || std::is_same_v<T, float>;
+
+// The best kernel at most as wide as asked for that this CPU and T support
+template <typename T>
+GatherKernel usable(GatherKernel k) {
+    if constexpr (!has_gather<T>)
+        return GatherKernel::Scalar;
+    if (k == GatherKernel::Avx512 && !__builtin_cpu_supports("avx512f"))
+        k = GatherKernel::Avx2;
+    if (k == GatherKernel::Avx2 && !__builtin_cpu_supports("avx2"))
+        k = GatherKernel::Scalar;
+    return k;
+}
+
+// SIMD head, then the tail (or everything) with the scalar kernel
+template <typename View>
+typename View::value_type run(const View& v, char op, GatherKernel kernel,
+                              size_t dist) {
+    using T = typename View::value_type;
+    T dest{};
+    with_op<T>(op, [&](auto o) {
+        using Op = decltype(o);
+        size_t done = 0;
+        T head = Op::identity;
+        if constexpr (has_gather<T>) {
+            if (kernel == GatherKernel::Avx512)
+                head = gather_avx512<T, Op>(v, dist, done);
+            else if (kernel == GatherKernel::Avx2)
+                head = gather_avx2<T, Op>(v, dist, done);
+        }
+        dest = Op::apply(head, scalar<Op>(v.tail(done), dist));
+    });
+    return dest;
+}
+
+} // namespace view_detail
+
+// dest = op over the view's elements, prefetching `prefetch` elements ahead
+template <typename T>
+void gather_combine(const StridedView<T>& v, T& dest, char op,
+                    GatherKernel kernel = GatherKernel::Avx512,
+                    size_t prefetch = VIEW_PREFETCH) {
+    kernel = view_detail::usable<T>(kernel);
+    // lane offsets are 32-bit byte offsets from the group's first element
+    ptrdiff_t s = v.stride_bytes();
+    if (s <= 0 || s > (ptrdiff_t(1) << 31) / 32)
+        kernel = GatherKernel::Scalar;
+    dest = view_detail::run(v, op, kernel, prefetch);
+}
+
+// Indices must be below 2^31: the gathers treat them as signed
+template <typename T>
+void gather_combine(const IndexedView<T>& v, T& dest, char op,
+                    GatherKernel kernel = GatherKernel::Avx512,
+                    size_t prefetch = VIEW_PREFETCH) {
+    kernel = view_detail::usable<T>(kernel);
+    dest = view_detail::run(v, op, kernel, prefetch);
+}
+
+#endif
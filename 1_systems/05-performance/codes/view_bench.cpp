@@ -0,0 +1,157 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <random>
+
+#include "view.hpp"
+
+// Reducing data that is not one contiguous Vector: copying it into a fresh
+// Vector and running combine6 (what we do without views) against combine6
+// on a view and the gather kernels at several prefetch distances.
+//   column   an int32 field of row-major records, records of 16 / 64 /
+//            256 bytes
+//   index    a random index list selecting a quarter of a large int32
+//            Vector, and a sorted one
+// Every result is compared with the copy + combine6 result.
+//
+// Build: g++ -std=c++20 -O2 view_bench.cpp -o view_bench
+// Usage: ./view_bench [MB of data]
+
+static double now_sec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Best of three, in ns per element
+template <typename F>
+static double time_ns(F f, size_t n) {
+    double best = 1e30;
+    for (int rep = 0; rep < 3; rep++) {
+        double t0 = now_sec();
+        f();
+        best = std::min(best, now_sec() - t0);
+    }
+    return best * 1e9 / n;
+}
+
+// The old way: materialize the elements, then reduce
+template <VectorView V>
+static typename V::value_type copy_then_combine(const V& v) {
+    using T = typename V::value_type;
+    Vector<T> tmp(v.length(), no_init);
+    for (size_t i = 0; i < v.length(); i++)
+        tmp[i] = v[i];
+    T result;
+    combine6(tmp, result, '+');
+    return result;
+}
+
+static const size_t distances[] = {0, 16, 64, 256};
+static const GatherKernel kernels[] = {
+    GatherKernel::Scalar, GatherKernel::Avx2, GatherKernel::Avx512};
+
+static void header(const char* what) {
+    printf("\n%s, ns/element\n%-22s %9s %9s", what, "case", "copy+comb",
+           "combine6");
+    for (GatherKernel k : kernels)
+        for (size_t d : distances)
+            printf(" %6s/%-3zu", gather_kernel_name(k), d);
+    printf("\n");
+}
+
+template <typename View>
+static bool row(const char* name, const View& v) {
+    using T = typename View::value_type;
+    size_t n = v.length();
+    T ref = 0, r = 0;
+    bool ok = true;
+    printf("%-22s %9.2f", name,
+           time_ns([&] { ref = copy_then_combine(v); }, n));
+    printf(" %9.2f", time_ns([&] { combine6(v, r, '+'); }, n));
+    ok &= r == ref;
+    for (GatherKernel k : kernels)
+        for (size_t d : distances) {
+            printf(" %10.2f",
+                   time_ns([&] { gather_combine(v, r, '+', k, d); }, n));
+            ok &= r == ref;
+        }
+    printf("\n");
+    return ok;
+}
+
+template <size_t Bytes>
+struct Record {
+    int32_t key;
+    int32_t value;
+    char payload[Bytes - 8];
+};
+
+template <size_t Bytes>
+static bool column(size_t mb, std::mt19937& rng) {
+    size_t n = (mb << 20) / Bytes;
+    Vector<Record<Bytes>> recs(n);
+    for (size_t i = 0; i < n; i++)
+        recs[i].value = int32_t(rng() % 100);
+    char name[32];
+    snprintf(name, sizeof(name), "%zu B records", Bytes);
+    return row(name, column_of(recs.get_start(), n, &Record<Bytes>::value));
+}
+
+int main(int argc, char** argv) {
+    size_t mb = argc > 1 ? strtoul(argv[1], nullptr, 10) : 256;
+    std::mt19937 rng(7);
+    bool ok = true;
+
+    header("column of records");
+    ok &= column<16>(mb, rng);
+    ok &= column<64>(mb, rng);
+    ok &= column<256>(mb, rng);
+
+    header("index list");
+    Vector<int32_t> data((mb << 20) / sizeof(int32_t));
+    data.fill_random(0, 99);
+    Vector<uint32_t> idx(data.length() / 4);
+    for (size_t i = 0; i < idx.length(); i++)
+        idx[i] = uint32_t(rng() % data.length());
+    ok &= row("random, 1/4 of data", IndexedView<int32_t>(data, idx));
+    std::sort(idx.get_start(), idx.get_start() + idx.length());
+    ok &= row("sorted, 1/4 of data", IndexedView<int32_t>(data, idx));
+
+    // Small exact cases around the SIMD group sizes, strided and indexed,
+    // float and both ops: 1 2 3 1 2 3 ... so 2 appears (n + 1) / 3 times
+    for (size_t len : {0, 1, 15, 16, 17, 31, 32, 33, 100}) {
+        Vector<float> f(2 * len + 1);
+        Vector<uint32_t> ix(len);
+        for (size_t i = 0; i < len; i++) {
+            f[2 * i] = float(1 + i % 3);
+            ix[i] = uint32_t(2 * i);
+        }
+        size_t twos = (len + 1) / 3;
+        float sum = float(len / 3 * 6 + (len % 3 >= 1) + (len % 3 == 2) * 2);
+        StridedView<float> s(f, 0, 2);
+        IndexedView<float> x(f, ix);
+        for (GatherKernel k : kernels) {
+            float r;
+            gather_combine(s, r, '+', k, 4);
+            ok &= r == sum;
+            gather_combine(x, r, '+', k, 4);
+            ok &= r == sum;
+            // exact while the product fits in a float's mantissa
+            if (len <= 33) {
+                gather_combine(x, r, '*', k, 4);
+                float threes = std::pow(3.0f, float(len / 3));
+                ok &= r == float(uint64_t(1) << twos) * threes;
+            }
+        }
+        // the odd positions are 0
+        float r;
+        combine4(ContiguousView<float>(f), r, '+');
+        ok &= r == sum;
+    }
+
+    printf("results %s\n", ok ? "agree" : "DIFFER");
+    return ok ? 0 : 1;
+}
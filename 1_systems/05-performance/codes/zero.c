@@ -0,0 +1,310 @@
+#define _GNU_SOURCE
+#include "zero.h"
+
+#include <immintrin.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_THREADS 64
+
+static const char* strategy_names[] = {"simd", "nt", "mt", "discard"};
+
+/* Crossover points, overwritten by zero_calibrate() */
+static size_t nt_threshold = 4UL << 20;       /* use NT stores above this */
+static size_t mt_threshold = 64UL << 20;      /* use threads above this */
+static size_t discard_threshold = 16UL << 20; /* use madvise above this */
+static int num_threads = 1;
+static long page_size = 4096;
+static pthread_once_t host_once = PTHREAD_ONCE_INIT;
+
+static void host_init(void) {
+    page_size = sysconf(_SC_PAGESIZE);
+    num_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (num_threads < 1)
+        num_threads = 1;
+    if (num_threads > MAX_THREADS)
+        num_threads = MAX_THREADS;
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+const char* zero_strategy_name(zero_strategy s) {
+    return s < ZERO_NUM_STRATEGIES ? strategy_names[s] : "?";
+}
+
+/* Head and tail bytes that are not a full vector are cleared with memset */
+__attribute__((target("avx2"))) static void zero_simd_avx2(char* p,
+                                                           size_t n) {
+    size_t head = (32 - ((uintptr_t)p & 31)) & 31;
+    if (head > n)
+        head = n;
+    memset(p, 0, head);
+    p += head;
+    n -= head;
+
+    __m256i z = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 128 <= n; i += 128) {
+        _mm256_store_si256((__m256i*)(p + i), z);
+        _mm256_store_si256((__m256i*)(p + i + 32), z);
+        _mm256_store_si256((__m256i*)(p + i + 64), z);
+        _mm256_store_si256((__m256i*)(p + i + 96), z);
+    }
+    for (; i + 32 <= n; i += 32) {
+        _mm256_store_si256((__m256i*)(p + i), z);
+    }
+    memset(p + i, 0, n - i);
+}
+
+__attribute__((target("avx2"))) static void zero_nt_avx2(char* p, size_t n) {
+    size_t head = (32 - ((uintptr_t)p & 31)) & 31;
+    if (head > n)
+        head = n;
+    memset(p, 0, head);
+    p += head;
+    n -= head;
+
+    __m256i z = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 128 <= n; i += 128) {
+        _mm256_stream_si256((__m256i*)(p + i), z);
+        _mm256_stream_si256((__m256i*)(p + i + 32), z);
+        _mm256_stream_si256((__m256i*)(p + i + 64), z);
+        _mm256_stream_si256((__m256i*)(p + i + 96), z);
+    }
+    for (; i + 32 <= n; i += 32) {
+        _mm256_stream_si256((__m256i*)(p + i), z);
+    }
+    /* NT stores are weakly ordered; fence before anyone reads the region */
+    _mm_sfence();
+    memset(p + i, 0, n - i);
+}
+
+/* SSE2 versions, always available on x86-64 */
+static void zero_nt_sse2(char* p, size_t n) {
+    size_t head = (16 - ((uintptr_t)p & 15)) & 15;
+    if (head > n)
+        head = n;
+    memset(p, 0, head);
+    p += head;
+    n -= head;
+
+    __m128i z = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        _mm_stream_si128((__m128i*)(p + i), z);
+        _mm_stream_si128((__m128i*)(p + i + 16), z);
+        _mm_stream_si128((__m128i*)(p + i + 32), z);
+        _mm_stream_si128((__m128i*)(p + i + 48), z);
+    }
+    _mm_sfence();
+    memset(p + i, 0, n - i);
+}
+
+void zero_simd(void* p, size_t n) {
+    if (__builtin_cpu_supports("avx2"))
+        zero_simd_avx2(p, n);
+    else
+        memset(p, 0, n);
+}
+
+void zero_nt(void* p, size_t n) {
+    if (__builtin_cpu_supports("avx2"))
+        zero_nt_avx2(p, n);
+    else
+        zero_nt_sse2(p, n);
+}
+
+typedef struct {
+    char* start;
+    size_t len;
+} zero_task;
+
+static void* zero_worker(void* arg) {
+    zero_task* t = (zero_task*)arg;
+    zero_nt(t->start, t->len);
+    return NULL;
+}
+
+/* Split the region into page-aligned slices, one per thread */
+void zero_mt(void* p, size_t n, int threads) {
+    pthread_once(&host_once, host_init);
+    if (threads > MAX_THREADS)
+        threads = MAX_THREADS;
+    if (threads <= 1) {
+        zero_nt(p, n);
+        return;
+    }
+
+    pthread_t tids[MAX_THREADS];
+    zero_task tasks[MAX_THREADS];
+    size_t chunk = (n / threads + page_size - 1) & ~(size_t)(page_size - 1);
+    char* base = (char*)p;
+    int started = 0;
+
+    /* Workers take the leading slices, the calling thread the rest */
+    while (started < threads - 1 && chunk * (started + 1) < n) {
+        tasks[started].start = base + chunk * started;
+        tasks[started].len = chunk;
+        if (pthread_create(&tids[started], NULL, zero_worker,
+                           &tasks[started]) != 0)
+            break;
+        started++;
+    }
+
+    size_t done = chunk * started;
+    zero_nt(base + done, n - done);
+
+    for (int t = 0; t < started; t++) {
+        pthread_join(tids[t], NULL);
+    }
+}
+
+/*
+ * Drop the physical pages behind the page-aligned middle of the region.
+ * Only valid on private anonymous mappings: the next touch faults in a
+ * fresh zero page. Returns 0 if nothing could be discarded.
+ */
+int zero_discard(void* p, size_t n) {
+    pthread_once(&host_once, host_init);
+    uintptr_t start =
+        ((uintptr_t)p + page_size - 1) & ~(uintptr_t)(page_size - 1);
+    uintptr_t end = ((uintptr_t)p + n) & ~(uintptr_t)(page_size - 1);
+    if (end <= start)
+        return 0;
+
+    if (madvise((void*)start, end - start, MADV_DONTNEED) != 0)
+        return 0;
+
+    zero_simd(p, start - (uintptr_t)p);
+    zero_simd((void*)end, (uintptr_t)p + n - end);
+    return 1;
+}
+
+zero_strategy zero_choose(size_t n, int flags) {
+    pthread_once(&host_once, host_init);
+    if ((flags & ZERO_MAY_DISCARD) && !(flags & ZERO_KEEP_CACHED) &&
+        n >= discard_threshold)
+        return ZERO_DISCARD;
+    if ((flags & ZERO_KEEP_CACHED) || n < nt_threshold)
+        return ZERO_SIMD;
+    if (num_threads > 1 && n >= mt_threshold)
+        return ZERO_MT;
+    return ZERO_NT;
+}
+
+void zero_with(zero_strategy s, void* p, size_t n) {
+    pthread_once(&host_once, host_init);
+    switch (s) {
+    case ZERO_SIMD:
+        zero_simd(p, n);
+        break;
+    case ZERO_NT:
+        zero_nt(p, n);
+        break;
+    case ZERO_MT:
+        zero_mt(p, n, num_threads);
+        break;
+    case ZERO_DISCARD:
+        if (!zero_discard(p, n))
+            zero_simd(p, n);
+        break;
+    default:
+        memset(p, 0, n);
+    }
+}
+
+void zero_bytes(void* p, size_t n, int flags) {
+    zero_with(zero_choose(n, flags), p, n);
+}
+
+static void* map_region(size_t n) {
+    void* p = mmap(NULL, n, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return p == MAP_FAILED ? NULL : p;
+}
+
+/* Write every long once, the way a job reuses its scratch buffer */
+static long touch(long* p, size_t n) {
+    long sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        sum += p[i];
+        p[i] = (long)i;
+    }
+    return sum;
+}
+
+/*
+ * Measure zero + re-touch time of one strategy on a dirty buffer.
+ * Returns seconds, the re-touch part is stored in *touch_sec.
+ */
+static double measure(zero_strategy s, long* buf, size_t bytes,
+                      double* touch_sec) {
+    size_t n = bytes / sizeof(long);
+    touch(buf, n); /* make every page resident and dirty */
+
+    double t0 = now_sec();
+    zero_with(s, buf, bytes);
+    double t1 = now_sec();
+    volatile long sink = touch(buf, n);
+    double t2 = now_sec();
+    (void)sink;
+
+    *touch_sec = t2 - t1;
+    return t2 - t0;
+}
+
+/* Pick crossover sizes from zero+touch cost measured on this host */
+void zero_calibrate(void) {
+    pthread_once(&host_once, host_init);
+    size_t sizes[] = {1UL << 20, 4UL << 20, 16UL << 20, 64UL << 20};
+    int nsizes = sizeof(sizes) / sizeof(sizes[0]);
+    long* buf = map_region(sizes[nsizes - 1]);
+    if (!buf)
+        return;
+
+    size_t nt = 0, mt = 0, discard = 0;
+    for (int i = nsizes - 1; i >= 0; i--) {
+        double tt, cost[ZERO_NUM_STRATEGIES];
+        for (int s = 0; s < ZERO_NUM_STRATEGIES; s++) {
+            cost[s] = measure(s, buf, sizes[i], &tt);
+        }
+        if (cost[ZERO_NT] < cost[ZERO_SIMD])
+            nt = sizes[i];
+        if (num_threads > 1 && cost[ZERO_MT] < cost[ZERO_NT])
+            mt = sizes[i];
+        if (cost[ZERO_DISCARD] < cost[ZERO_SIMD] &&
+            cost[ZERO_DISCARD] < cost[ZERO_NT])
+            discard = sizes[i];
+    }
+    nt_threshold = nt ? nt : SIZE_MAX;
+    mt_threshold = mt ? mt : SIZE_MAX;
+    discard_threshold = discard ? discard : SIZE_MAX;
+    munmap(buf, sizes[nsizes - 1]);
+}
+
+size_t zero_threshold(zero_strategy s) {
+    switch (s) {
+    case ZERO_NT:
+        return nt_threshold;
+    case ZERO_MT:
+        return mt_threshold;
+    case ZERO_DISCARD:
+        return discard_threshold;
+    default:
+        return 0;
+    }
+}
+
+int zero_threads(void) {
+    pthread_once(&host_once, host_init);
+    return num_threads;
+}
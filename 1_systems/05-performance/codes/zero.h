@@ -0,0 +1,63 @@
+#ifndef ZERO_H
+#define ZERO_H
+
+#include <stddef.h>
+
+/*
+ * Bulk zeroing engine: a replacement for a one-long-at-a-time clear loop
+ * that picks one of several strategies by size and by the cost measured
+ * on this host.
+ *
+ * - simd: regular AVX2 stores (memset without AVX2), data stays in cache
+ * - nt: non-temporal stores, bypass the cache
+ * - mt: non-temporal stores split over page-aligned slices, one per CPU
+ * - discard: madvise(MADV_DONTNEED), the kernel maps zero pages lazily;
+ *   only for private anonymous mappings
+ *
+ * The default crossover sizes are guesses; zero_calibrate() replaces them
+ * with the sizes where each strategy wins on zero + re-touch cost.
+ */
+
+/* Flags accepted by zero_bytes */
+#define ZERO_MAY_DISCARD 0x1 /* region is private anonymous mmap memory */
+#define ZERO_KEEP_CACHED 0x2 /* caller will touch the region right away */
+
+typedef enum {
+    ZERO_SIMD,
+    ZERO_NT,
+    ZERO_MT,
+    ZERO_DISCARD,
+    ZERO_NUM_STRATEGIES
+} zero_strategy;
+
+const char* zero_strategy_name(zero_strategy s);
+
+/* Entry point: zero n bytes at p using the cheapest known strategy */
+void zero_bytes(void* p, size_t n, int flags);
+
+/* The strategy zero_bytes would use for n bytes */
+zero_strategy zero_choose(size_t n, int flags);
+
+/* Zero with a given strategy; discard falls back to simd if it can't */
+void zero_with(zero_strategy s, void* p, size_t n);
+
+void zero_simd(void* p, size_t n);
+void zero_nt(void* p, size_t n);
+void zero_mt(void* p, size_t n, int threads);
+
+/*
+ * Drop the physical pages behind the page-aligned middle of the region
+ * and clear the ragged ends. Returns 0 if nothing could be discarded.
+ */
+int zero_discard(void* p, size_t n);
+
+/* Set the crossover sizes from zero + re-touch cost (takes ~1 s) */
+void zero_calibrate(void);
+
+/* Smallest size at which nt, mt or discard is used; SIZE_MAX for never */
+size_t zero_threshold(zero_strategy s);
+
+/* Number of threads zero_mt is given by zero_bytes */
+int zero_threads(void);
+
+#endif
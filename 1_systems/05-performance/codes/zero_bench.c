@@ -0,0 +1,119 @@
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "zero.h"
+
+/*
+ * Zero + re-touch cost of every strategy of zero.h against the original
+ * clear_array loop (mem.c), from 256 KB to 128 MB, then the calibrated
+ * crossover sizes and the engine on the mem.c workload.
+ *
+ * Build: gcc -O2 -pthread zero.c zero_bench.c -o zero_bench
+ */
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* The original one-long-at-a-time loop, kept as the baseline */
+static void clear_loop(long* dest, long n) {
+    long i;
+    for (i = 0; i < n; i++) {
+        dest[i] = 0;
+    }
+}
+
+static void* map_region(size_t n) {
+    void* p = mmap(NULL, n, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return p == MAP_FAILED ? NULL : p;
+}
+
+/* Write every long once, the way a job reuses its scratch buffer */
+static long touch(long* p, size_t n) {
+    long sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        sum += p[i];
+        p[i] = (long)i;
+    }
+    return sum;
+}
+
+/*
+ * Zero + re-touch time of one strategy (ZERO_NUM_STRATEGIES: the loop) on
+ * a dirty buffer. Returns seconds, the re-touch part goes to *touch_sec.
+ */
+static double measure(zero_strategy s, long* buf, size_t bytes,
+                      double* touch_sec) {
+    size_t n = bytes / sizeof(long);
+    touch(buf, n); /* make every page resident and dirty */
+
+    double t0 = now_sec();
+    if (s == ZERO_NUM_STRATEGIES)
+        clear_loop(buf, n);
+    else
+        zero_with(s, buf, bytes);
+    double t1 = now_sec();
+    volatile long sink = touch(buf, n);
+    double t2 = now_sec();
+    (void)sink;
+
+    *touch_sec = t2 - t1;
+    return t2 - t0;
+}
+
+static void print_threshold(zero_strategy s) {
+    size_t t = zero_threshold(s);
+    if (t == SIZE_MAX)
+        printf("  %-8s never\n", zero_strategy_name(s));
+    else
+        printf("  %-8s >= %zu KB\n", zero_strategy_name(s), t >> 10);
+}
+
+int main() {
+    size_t max_bytes = 128UL << 20; /* same 128 MB as mem.c */
+    long* buf = map_region(max_bytes);
+    if (!buf) {
+        perror("mmap failed");
+        return 1;
+    }
+
+    printf("threads: %d, page size: %ld\n", zero_threads(),
+           sysconf(_SC_PAGESIZE));
+    printf("%10s %-8s %10s %10s %10s\n", "size", "method", "zero ms",
+           "touch ms", "GB/s");
+
+    for (size_t bytes = 256UL << 10; bytes <= max_bytes; bytes <<= 2) {
+        for (int s = 0; s <= ZERO_NUM_STRATEGIES; s++) {
+            double tt;
+            double total = measure(s, buf, bytes, &tt);
+            const char* name =
+                s == ZERO_NUM_STRATEGIES ? "loop" : zero_strategy_name(s);
+            printf("%8zuKB %-8s %10.3f %10.3f %10.2f\n", bytes >> 10, name,
+                   (total - tt) * 1e3, tt * 1e3, bytes / (total - tt) / 1e9);
+        }
+    }
+
+    zero_calibrate();
+    printf("\ncalibrated thresholds (zero + re-touch cost):\n");
+    print_threshold(ZERO_NT);
+    print_threshold(ZERO_MT);
+    print_threshold(ZERO_DISCARD);
+
+    /* The engine on the mem.c workload */
+    double t0 = now_sec();
+    zero_bytes(buf, max_bytes, ZERO_MAY_DISCARD);
+    double t1 = now_sec();
+    printf("\nzero_bytes(128 MB): %s, %.3f ms\n",
+           zero_strategy_name(zero_choose(max_bytes, ZERO_MAY_DISCARD)),
+           (t1 - t0) * 1e3);
+
+    munmap(buf, max_bytes);
+    return 0;
+}
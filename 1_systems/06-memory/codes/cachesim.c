@@ -0,0 +1,355 @@
+#include "cachesim.h"
+
+#include <immintrin.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NIBBLES_1 0x1111111111111111ull
+#define NIBBLES_8 0x8888888888888888ull
+#define VALID 1ull
+#define DIRTY 2ull
+
+static int is_pow2(unsigned x) {
+    return x && !(x & (x - 1));
+}
+
+/* ---------------- 替换策略 ---------------- */
+
+/*
+ * LRU: order 的第 0 个 4 位是最近使用的路, 第 ways-1 个是最久未用的。
+ * 用"含零半字节"技巧找到 w 的位置 p, 把 0..p-1 整体左移一格, 再把 w
+ * 放到第 0 格
+ */
+static inline void lru_touch(uint64_t* order, unsigned w) {
+    uint64_t o = *order;
+    uint64_t x = o ^ (NIBBLES_1 * w);
+    uint64_t z = (x - NIBBLES_1) & ~x & NIBBLES_8;
+    unsigned p = (unsigned)__builtin_ctzll(z) >> 2;
+    uint64_t below = (1ull << (4 * p)) - 1;
+    uint64_t above = p == 15 ? 0 : ~0ull << (4 * p + 4);
+    *order = (o & above) | ((o & below) << 4) | w;
+}
+
+static inline unsigned lru_victim(uint64_t order, unsigned ways) {
+    return (unsigned)(order >> (4 * (ways - 1))) & 15;
+}
+
+/*
+ * 伪 LRU: ways - 1 个节点的二叉树, 节点 k 的孩子是 2k 和 2k+1 (根是 1),
+ * 节点的位指向该去淘汰的那一半; 访问时让路径上的位都指向另一半
+ */
+static inline void plru_touch(uint64_t* order, unsigned w, unsigned ways) {
+    uint64_t o = *order;
+    unsigned node = 1;
+    for (unsigned half = ways >> 1; half; half >>= 1) {
+        unsigned right = (w & half) != 0;
+        if (right)
+            o &= ~(1ull << node);
+        else
+            o |= 1ull << node;
+        node = 2 * node + right;
+    }
+    *order = o;
+}
+
+static inline unsigned plru_victim(uint64_t order, unsigned ways) {
+    unsigned node = 1;
+    while (node < ways)
+        node = 2 * node + (unsigned)((order >> node) & 1);
+    return node - ways;
+}
+
+static inline void touch(cache_level* c, uint64_t set, unsigned w) {
+    if (c->cfg.repl == REPL_LRU)
+        lru_touch(&c->order[set], w);
+    else if (c->cfg.repl == REPL_PLRU)
+        plru_touch(&c->order[set], w, c->cfg.ways);
+}
+
+static inline unsigned victim(cache_level* c, uint64_t set) {
+    switch (c->cfg.repl) {
+    case REPL_LRU:
+        return lru_victim(c->order[set], c->cfg.ways);
+    case REPL_PLRU:
+        return plru_victim(c->order[set], c->cfg.ways);
+    default:
+        c->rng ^= c->rng << 13;
+        c->rng ^= c->rng >> 7;
+        c->rng ^= c->rng << 17;
+        return (unsigned)(((c->rng >> 32) * c->cfg.ways) >> 32);
+    }
+}
+
+/* ---------------- 访问 ---------------- */
+
+/* 访问的种类; 写回是上一级淘汰的整行, 不命中时分配但不读入 */
+enum { ACC_READ, ACC_WRITE, ACC_WRITEBACK };
+
+/*
+ * 一组里 (w & ~DIRTY) == key 的路 (命中) 和 == 0 的路 (空闲) 的位图。
+ * AVX2 一条比较查 4 路; 组的末尾可能多读几路, 分配时留了余量,
+ * 多出的位被 all 屏蔽
+ */
+__attribute__((target("avx2"))) static unsigned
+match_ways_avx2(const uint64_t* w, unsigned ways, uint64_t key,
+                unsigned* empty) {
+    const __m256i k = _mm256_set1_epi64x((long long)key);
+    const __m256i clean = _mm256_set1_epi64x((long long)~DIRTY);
+    const __m256i zero = _mm256_setzero_si256();
+    unsigned hit = 0, e = 0;
+    for (unsigned j = 0; j < ways; j += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(w + j));
+        __m256d h = _mm256_castsi256_pd(
+            _mm256_cmpeq_epi64(_mm256_and_si256(v, clean), k));
+        __m256d z = _mm256_castsi256_pd(_mm256_cmpeq_epi64(v, zero));
+        hit |= (unsigned)_mm256_movemask_pd(h) << j;
+        e |= (unsigned)_mm256_movemask_pd(z) << j;
+    }
+    unsigned all = (1u << ways) - 1;
+    *empty = e & all;
+    return hit & all;
+}
+
+static inline unsigned match_ways_scalar(const uint64_t* w, unsigned ways,
+                                         uint64_t key, unsigned* empty) {
+    unsigned hit = 0, e = 0;
+    for (unsigned j = 0; j < ways; j++) {
+        hit |= (unsigned)((w[j] & ~DIRTY) == key) << j;
+        e |= (unsigned)(w[j] == 0) << j;
+    }
+    *empty = e;
+    return hit;
+}
+
+static uint64_t* level_access(cache_sim* s, int i, uint64_t addr, int kind);
+
+/*
+ * 第 i 级之下: 下一级或主存。第 i 级的行比下一级的短时, 写回只盖住
+ * 下一级的一部分, 按普通的写处理 (不命中时要读入)
+ */
+static void below(cache_sim* s, int i, uint64_t addr, int kind) {
+    if (i + 1 < s->nlevels) {
+        if (kind == ACC_WRITEBACK &&
+            s->lv[i].line_bits < s->lv[i + 1].line_bits)
+            kind = ACC_WRITE;
+        level_access(s, i + 1, addr, kind);
+    } else if (kind != ACC_READ) {
+        s->mem_writes++;
+    } else {
+        s->mem_reads++;
+    }
+}
+
+/* 返回这次访问留在第 i 级的那一路; 写直达的写不命中不分配, 返回 NULL */
+static uint64_t* level_access(cache_sim* s, int i, uint64_t addr, int kind) {
+    cache_level* c = &s->lv[i];
+    uint64_t line = addr >> c->line_bits;
+    uint64_t set = line & c->set_mask;
+    uint64_t* w = c->ways + set * c->cfg.ways;
+    uint64_t key = (line << 2) | VALID;
+    int write = kind != ACC_READ;
+    unsigned hit, empty;
+
+    c->st.accesses[write]++;
+    hit = s->avx2 ? match_ways_avx2(w, c->cfg.ways, key, &empty)
+                  : match_ways_scalar(w, c->cfg.ways, key, &empty);
+    if (hit) {
+        unsigned k = (unsigned)__builtin_ctz(hit);
+        touch(c, set, k);
+        if (!c->cfg.write_through) {
+            w[k] |= (uint64_t)write << 1; /* DIRTY */
+        } else if (write) {
+            c->st.writebacks++;
+            below(s, i, addr, kind);
+        }
+        return &w[k];
+    }
+
+    c->st.misses[write]++;
+    if (c->cfg.write_through && write) {
+        c->st.writebacks++;
+        below(s, i, addr, kind);
+        return NULL;
+    }
+
+    unsigned v = empty ? (unsigned)__builtin_ctz(empty) : victim(c, set);
+    uint64_t old = w[v];
+    c->st.evictions += old != 0;
+    if (old & DIRTY) {
+        c->st.writebacks++;
+        below(s, i, (old >> 2) << c->line_bits, ACC_WRITEBACK);
+    }
+    if (kind != ACC_WRITEBACK)
+        below(s, i, line << c->line_bits, ACC_READ);
+    w[v] = key | ((uint64_t)write << 1);
+    touch(c, set, v);
+    return &w[v];
+}
+
+/*
+ * 第一级的一行。和上一次是同一行时它已经是最近使用的, LRU 和 PLRU
+ * 的状态都不会变, 只需计数 (和置脏位)
+ */
+static inline void access_line(cache_sim* s, uint64_t addr, int write) {
+    cache_level* l1 = &s->lv[0];
+    uint64_t line = addr >> l1->line_bits;
+    if (line == s->last_line) {
+        l1->st.accesses[write]++;
+        if (!l1->cfg.write_through) {
+            *s->last_way |= (uint64_t)write << 1;
+        } else if (write) {
+            l1->st.writebacks++;
+            below(s, 0, addr, ACC_WRITE);
+        }
+        return;
+    }
+    uint64_t* w = level_access(s, 0, addr, write ? ACC_WRITE : ACC_READ);
+    s->last_line = w ? line : ~0ull;
+    s->last_way = w;
+}
+
+void cache_access(cache_sim* s, uint64_t addr, unsigned size, int write) {
+    unsigned lb = s->lv[0].line_bits;
+    uint64_t first = addr >> lb;
+    uint64_t last = (addr + (size ? size : 1) - 1) >> lb;
+    access_line(s, addr, write);
+    for (uint64_t l = first + 1; l <= last; l++)
+        access_line(s, l << lb, write);
+}
+
+void cache_run(cache_sim* s, const uint64_t* recs, size_t n) {
+    unsigned lb = s->lv[0].line_bits;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t r = recs[i];
+        uint64_t addr = r & TRACE_ADDR_MASK;
+        unsigned size = (unsigned)(r >> 56) & 0x7f;
+        int write = (int)(r >> 63);
+        /* 绝大多数访问不跨行 */
+        if (((addr & ((1u << lb) - 1)) + size) <= (1u << lb))
+            access_line(s, addr, write);
+        else
+            cache_access(s, addr, size, write);
+    }
+}
+
+/* ---------------- 配置 ---------------- */
+
+int cache_parse(const char* spec, cache_config* cfgs, int max_levels) {
+    int n = 0;
+    const char* p = spec;
+    while (*p) {
+        if (n == max_levels)
+            return -1;
+        cache_config* c = &cfgs[n];
+        char* end;
+        memset(c, 0, sizeof(*c));
+        c->sets = (unsigned)strtoul(p, &end, 10);
+        if (*end != ':')
+            return -1;
+        c->ways = (unsigned)strtoul(end + 1, &end, 10);
+        if (*end != ':')
+            return -1;
+        c->line = (unsigned)strtoul(end + 1, &end, 10);
+        p = end;
+        while (*p == ':') {
+            p++;
+            size_t len = strcspn(p, ":,");
+            if (len == 3 && !strncmp(p, "lru", 3))
+                c->repl = REPL_LRU;
+            else if (len == 4 && !strncmp(p, "plru", 4))
+                c->repl = REPL_PLRU;
+            else if (len == 6 && !strncmp(p, "random", 6))
+                c->repl = REPL_RANDOM;
+            else if (len == 2 && !strncmp(p, "wt", 2))
+                c->write_through = 1;
+            else
+                return -1;
+            p += len;
+        }
+        if (*p == ',')
+            p++;
+        else if (*p)
+            return -1;
+        n++;
+    }
+    return n;
+}
+
+int cache_init(cache_sim* s, const cache_config* cfgs, int nlevels) {
+    memset(s, 0, sizeof(*s));
+    if (nlevels < 1 || nlevels > CACHE_MAX_LEVELS)
+        return -1;
+    for (int i = 0; i < nlevels; i++) {
+        const cache_config* cfg = &cfgs[i];
+        if (!is_pow2(cfg->sets) || !is_pow2(cfg->line) || cfg->ways == 0 ||
+            cfg->ways > CACHE_MAX_WAYS ||
+            (cfg->repl == REPL_PLRU && !is_pow2(cfg->ways)))
+            return -1;
+        /* below() 一次只读入 / 写回下一级的一行 */
+        if (i > 0 && cfgs[i - 1].line > cfg->line)
+            return -1;
+    }
+    s->nlevels = nlevels;
+    s->last_line = ~0ull;
+    s->avx2 = __builtin_cpu_supports("avx2");
+    for (int i = 0; i < nlevels; i++) {
+        cache_level* c = &s->lv[i];
+        c->cfg = cfgs[i];
+        c->line_bits = (unsigned)__builtin_ctz(c->cfg.line);
+        c->set_mask = c->cfg.sets - 1;
+        /* 多 3 路给 match_ways_avx2 读最后一组时越界的部分 */
+        c->ways = calloc((size_t)c->cfg.sets * c->cfg.ways + 3,
+                         sizeof(uint64_t));
+        c->order = calloc(c->cfg.sets, sizeof(uint64_t));
+        if (!c->ways || !c->order) {
+            cache_free(s);
+            return -1;
+        }
+        c->rng = 0x9e3779b97f4a7c15ull + (uint64_t)i;
+        if (c->cfg.repl == REPL_LRU) {
+            uint64_t init = 0;
+            for (unsigned k = 0; k < c->cfg.ways; k++)
+                init |= (uint64_t)k << (4 * k);
+            for (unsigned set = 0; set < c->cfg.sets; set++)
+                c->order[set] = init;
+        }
+    }
+    return 0;
+}
+
+void cache_free(cache_sim* s) {
+    for (int i = 0; i < CACHE_MAX_LEVELS; i++) {
+        free(s->lv[i].ways);
+        free(s->lv[i].order);
+        s->lv[i].ways = NULL;
+        s->lv[i].order = NULL;
+    }
+}
+
+void cache_report(const cache_sim* s) {
+    static const char* repl[] = {"lru", "plru", "random"};
+    printf("%-4s %-24s %12s %12s %12s %7s %12s %12s\n", "", "config", "reads",
+           "writes", "misses", "miss%", "evictions", "writebacks");
+    for (int i = 0; i < s->nlevels; i++) {
+        const cache_level* c = &s->lv[i];
+        const cache_stats* st = &c->st;
+        char cfg[64];
+        snprintf(cfg, sizeof(cfg), "%uKB %u-way %uB %s%s",
+                 (unsigned)((uint64_t)c->cfg.sets * c->cfg.ways * c->cfg.line
+                            >> 10),
+                 c->cfg.ways, c->cfg.line, repl[c->cfg.repl],
+                 c->cfg.write_through ? " wt" : "");
+        uint64_t acc = st->accesses[0] + st->accesses[1];
+        uint64_t miss = st->misses[0] + st->misses[1];
+        printf("L%-3d %-24s %12llu %12llu %12llu %6.2f%% %12llu %12llu\n",
+               i + 1, cfg, (unsigned long long)st->accesses[0],
+               (unsigned long long)st->accesses[1], (unsigned long long)miss,
+               acc ? 100.0 * miss / acc : 0.0,
+               (unsigned long long)st->evictions,
+               (unsigned long long)st->writebacks);
+    }
+    printf("memory: %llu lines read, %llu lines written\n",
+           (unsigned long long)s->mem_reads,
+           (unsigned long long)s->mem_writes);
+}
@@ -0,0 +1,162 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cachesim.h"
+
+/*
+ * 缓存模拟器的命令行: 读 trace_pack 格式的轨迹 (文件或标准输入),
+ * 按配置模拟, 输出每一级的命中 / 不命中 / 淘汰 / 写回和模拟速度。
+ * -b 不读轨迹, 用合成的访问序列测模拟器本身的吞吐量。
+ *
+ * 编译: gcc -O2 cachesim.c csim.c -o csim
+ * 运行: ./trace_kernels mm-jki 256 | ./csim [-c 配置] -
+ *       ./csim [-c 配置] -b [访问次数]
+ */
+
+/* 默认: 32KB 8 路 L1, 1MB 16 路 L2, 8MB 16 路 L3 */
+static const char* default_spec = "64:8:64:lru,1024:16:64:lru,8192:16:64:plru";
+
+/* 每次 fread 读入的记录数 */
+#define BATCH (1 << 20)
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "usage: %s [-c sets:ways:line[:lru|plru|random][:wt],...] "
+            "<trace|->\n"
+            "       %s [-c ...] -b [accesses]\n",
+            prog, prog);
+    exit(1);
+}
+
+static uint64_t xorshift(uint64_t* s) {
+    *s ^= *s << 13;
+    *s ^= *s >> 7;
+    *s ^= *s << 17;
+    return *s;
+}
+
+/*
+ * 合成轨迹: 顺序读一个 64MB 的 int 数组 (像 combine4), 以及在同样大小
+ * 的范围里随机读写 8 字节 (最坏情况, 几乎每次都走完所有级)
+ */
+static void bench(const cache_config* cfgs, int nlevels, size_t total) {
+    uint64_t* recs = malloc(BATCH * sizeof(uint64_t));
+    if (!recs) {
+        perror("malloc failed");
+        exit(1);
+    }
+    const uint64_t base = 1ull << 32, span = 64ull << 20;
+    uint64_t rng = 88172645463325252ull;
+
+    for (int pattern = 0; pattern < 2; pattern++) {
+        cache_sim s;
+        if (cache_init(&s, cfgs, nlevels) < 0) {
+            fprintf(stderr, "bad cache config\n");
+            exit(1);
+        }
+        uint64_t next = 0;
+        double sim = 0;
+        for (size_t done = 0; done < total; done += BATCH) {
+            size_t n = total - done < BATCH ? total - done : BATCH;
+            for (size_t i = 0; i < n; i++) {
+                if (pattern == 0) {
+                    recs[i] = trace_pack(base + next, 4, 0);
+                    next = (next + 4) % span;
+                } else {
+                    uint64_t r = xorshift(&rng);
+                    recs[i] = trace_pack(base + (r % span & ~7ull), 8, r >> 63);
+                }
+            }
+            double t0 = now_sec();
+            cache_run(&s, recs, n);
+            sim += now_sec() - t0;
+        }
+        printf("\n%s, %zu accesses: %.1f M accesses/s\n",
+               pattern == 0 ? "sequential 4B reads" : "random 8B reads/writes",
+               total, total / sim * 1e-6);
+        cache_report(&s);
+        cache_free(&s);
+    }
+    free(recs);
+}
+
+int main(int argc, char** argv) {
+    const char* spec = default_spec;
+    int bench_mode = 0;
+    size_t bench_n = 200000000;
+    int opt;
+    while ((opt = getopt(argc, argv, "c:b")) != -1) {
+        if (opt == 'c')
+            spec = optarg;
+        else if (opt == 'b')
+            bench_mode = 1;
+        else
+            usage(argv[0]);
+    }
+
+    cache_config cfgs[CACHE_MAX_LEVELS];
+    int nlevels = cache_parse(spec, cfgs, CACHE_MAX_LEVELS);
+    if (nlevels < 1) {
+        fprintf(stderr, "bad cache config: %s\n", spec);
+        return 1;
+    }
+
+    if (bench_mode) {
+        if (optind < argc)
+            bench_n = strtoull(argv[optind], NULL, 10);
+        bench(cfgs, nlevels, bench_n);
+        return 0;
+    }
+
+    if (optind != argc - 1)
+        usage(argv[0]);
+    FILE* in = strcmp(argv[optind], "-") ? fopen(argv[optind], "rb") : stdin;
+    if (!in) {
+        perror(argv[optind]);
+        return 1;
+    }
+
+    cache_sim s;
+    if (cache_init(&s, cfgs, nlevels) < 0) {
+        fprintf(stderr, "bad cache config: %s\n", spec);
+        return 1;
+    }
+    uint64_t* recs = malloc(BATCH * sizeof(uint64_t));
+    if (!recs) {
+        perror("malloc failed");
+        return 1;
+    }
+    size_t total = 0, n;
+    double sim = 0, t_start = now_sec();
+    while ((n = fread(recs, sizeof(uint64_t), BATCH, in)) > 0) {
+        double t0 = now_sec();
+        cache_run(&s, recs, n);
+        sim += now_sec() - t0;
+        total += n;
+    }
+    if (ferror(in)) {
+        perror("read failed");
+        return 1;
+    }
+    double wall = now_sec() - t_start;
+
+    cache_report(&s);
+    printf("%zu accesses, simulated at %.1f M accesses/s "
+           "(%.1f M/s including input)\n",
+           total, sim > 0 ? total / sim * 1e-6 : 0.0,
+           wall > 0 ? total / wall * 1e-6 : 0.0);
+    cache_free(&s);
+    free(recs);
+    if (in != stdin)
+        fclose(in);
+    return 0;
+}
@@ -0,0 +1,413 @@
+#include "matrix.h"
+
+#include <immintrin.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static size_t min_sz(size_t a, size_t b) {
+    return a < b ? a : b;
+}
+
+/* ---------------- 六种循环顺序 ---------------- */
+
+/* 内层沿 A 的行和 B 的列: A 步长 1, B 步长 n */
+void mm_ijk(size_t n, const double* A, const double* B, double* C) {
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++) {
+            double sum = C[i * n + j];
+            for (size_t k = 0; k < n; k++)
+                sum += A[i * n + k] * B[k * n + j];
+            C[i * n + j] = sum;
+        }
+}
+
+void mm_jik(size_t n, const double* A, const double* B, double* C) {
+    for (size_t j = 0; j < n; j++)
+        for (size_t i = 0; i < n; i++) {
+            double sum = C[i * n + j];
+            for (size_t k = 0; k < n; k++)
+                sum += A[i * n + k] * B[k * n + j];
+            C[i * n + j] = sum;
+        }
+}
+
+/* 内层沿列: A 和 C 都是步长 n, 最差 */
+void mm_jki(size_t n, const double* A, const double* B, double* C) {
+    for (size_t j = 0; j < n; j++)
+        for (size_t k = 0; k < n; k++) {
+            double r = B[k * n + j];
+            for (size_t i = 0; i < n; i++)
+                C[i * n + j] += A[i * n + k] * r;
+        }
+}
+
+void mm_kji(size_t n, const double* A, const double* B, double* C) {
+    for (size_t k = 0; k < n; k++)
+        for (size_t j = 0; j < n; j++) {
+            double r = B[k * n + j];
+            for (size_t i = 0; i < n; i++)
+                C[i * n + j] += A[i * n + k] * r;
+        }
+}
+
+/* 内层沿行: B 和 C 都是步长 1, 最好 */
+void mm_kij(size_t n, const double* A, const double* B, double* C) {
+    for (size_t k = 0; k < n; k++)
+        for (size_t i = 0; i < n; i++) {
+            double r = A[i * n + k];
+            for (size_t j = 0; j < n; j++)
+                C[i * n + j] += r * B[k * n + j];
+        }
+}
+
+void mm_ikj(size_t n, const double* A, const double* B, double* C) {
+    for (size_t i = 0; i < n; i++)
+        for (size_t k = 0; k < n; k++) {
+            double r = A[i * n + k];
+            for (size_t j = 0; j < n; j++)
+                C[i * n + j] += r * B[k * n + j];
+        }
+}
+
+/* ---------------- 分块 ---------------- */
+
+/*
+ * bijk: 固定 B 的一个 bs x bs 块, 让 A 的每一行的一小段扫过它;
+ * 这个块被用 n 次, 只要它留在缓存里, B 每个元素只从内存读一次
+ */
+void mm_blocked(size_t n, const double* A, const double* B, double* C,
+                size_t bs) {
+    for (size_t kk = 0; kk < n; kk += bs) {
+        size_t kend = min_sz(kk + bs, n);
+        for (size_t jj = 0; jj < n; jj += bs) {
+            size_t jend = min_sz(jj + bs, n);
+            for (size_t i = 0; i < n; i++)
+                for (size_t k = kk; k < kend; k++) {
+                    double r = A[i * n + k];
+                    for (size_t j = jj; j < jend; j++)
+                        C[i * n + j] += r * B[k * n + j];
+                }
+        }
+    }
+}
+
+/* ---------------- 寄存器分块 ---------------- */
+
+#define MR 4
+#define NR 8
+
+/* C[0..mr)[0..nr) += A[0..mr)[0..kc) * B[0..kc)[0..nr), mr <= MR, nr <= NR */
+static void micro_scalar(size_t kc, const double* A, const double* B,
+                         double* C, size_t n, size_t mr, size_t nr) {
+    double acc[MR][NR] = {{0}};
+    for (size_t k = 0; k < kc; k++)
+        for (size_t r = 0; r < mr; r++) {
+            double a = A[r * n + k];
+            for (size_t c = 0; c < nr; c++)
+                acc[r][c] += a * B[k * n + c];
+        }
+    for (size_t r = 0; r < mr; r++)
+        for (size_t c = 0; c < nr; c++)
+            C[r * n + c] += acc[r][c];
+}
+
+/*
+ * 完整的 4 x 8 子块: 8 个 ymm 累加器放着 C 的 32 个元素, 每个 k
+ * 读两个 B 向量, 广播四个 A 元素, 做 8 次 FMA; C 只在最后读写一次
+ */
+__attribute__((target("avx2,fma"))) static void
+micro_avx2(size_t kc, const double* A, const double* B, double* C, size_t n) {
+    __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+    __m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+    __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+    __m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+    for (size_t k = 0; k < kc; k++) {
+        __m256d b0 = _mm256_loadu_pd(B + k * n);
+        __m256d b1 = _mm256_loadu_pd(B + k * n + 4);
+        __m256d a = _mm256_broadcast_sd(A + k);
+        c00 = _mm256_fmadd_pd(a, b0, c00);
+        c01 = _mm256_fmadd_pd(a, b1, c01);
+        a = _mm256_broadcast_sd(A + n + k);
+        c10 = _mm256_fmadd_pd(a, b0, c10);
+        c11 = _mm256_fmadd_pd(a, b1, c11);
+        a = _mm256_broadcast_sd(A + 2 * n + k);
+        c20 = _mm256_fmadd_pd(a, b0, c20);
+        c21 = _mm256_fmadd_pd(a, b1, c21);
+        a = _mm256_broadcast_sd(A + 3 * n + k);
+        c30 = _mm256_fmadd_pd(a, b0, c30);
+        c31 = _mm256_fmadd_pd(a, b1, c31);
+    }
+    __m256d acc[MR][2] = {{c00, c01}, {c10, c11}, {c20, c21}, {c30, c31}};
+    for (int r = 0; r < MR; r++) {
+        double* c = C + r * n;
+        _mm256_storeu_pd(c, _mm256_add_pd(_mm256_loadu_pd(c), acc[r][0]));
+        _mm256_storeu_pd(c + 4,
+                         _mm256_add_pd(_mm256_loadu_pd(c + 4), acc[r][1]));
+    }
+}
+
+static void micro_full_scalar(size_t kc, const double* A, const double* B,
+                              double* C, size_t n) {
+    micro_scalar(kc, A, B, C, n, MR, NR);
+}
+
+/*
+ * 外两层分块挑出 A 的 mc x kc 块 (留在 L2) 和 B 的 kc 行,
+ * 内层对 B 的每个 kc x 8 面板 (留在 L1) 扫过 A 块的所有 4 行子块
+ */
+void mm_tiled(size_t n, const double* A, const double* B, double* C,
+              mm_tile tile) {
+    void (*micro)(size_t, const double*, const double*, double*, size_t) =
+        micro_full_scalar;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        micro = micro_avx2;
+
+    for (size_t kk = 0; kk < n; kk += tile.kc) {
+        size_t kc = min_sz(tile.kc, n - kk);
+        for (size_t ii = 0; ii < n; ii += tile.mc) {
+            size_t iend = min_sz(ii + tile.mc, n);
+            for (size_t j = 0; j < n; j += NR) {
+                size_t nr = min_sz(NR, n - j);
+                for (size_t i = ii; i < iend; i += MR) {
+                    size_t mr = min_sz(MR, iend - i);
+                    const double* a = A + i * n + kk;
+                    const double* b = B + kk * n + j;
+                    double* c = C + i * n + j;
+                    if (mr == MR && nr == NR)
+                        micro(kc, a, b, c, n);
+                    else
+                        micro_scalar(kc, a, b, c, n, mr, nr);
+                }
+            }
+        }
+    }
+}
+
+/* ---------------- 转置 ---------------- */
+
+/* 读 A 是步长 1, 写 B 是步长 rows: 每写一个元素就可能换一行缓存 */
+void transpose_naive(size_t rows, size_t cols, const double* A, double* B) {
+    for (size_t i = 0; i < rows; i++)
+        for (size_t j = 0; j < cols; j++)
+            B[j * rows + i] = A[i * cols + j];
+}
+
+void transpose_blocked(size_t rows, size_t cols, const double* A, double* B,
+                       size_t bs) {
+    for (size_t ii = 0; ii < rows; ii += bs)
+        for (size_t jj = 0; jj < cols; jj += bs) {
+            size_t iend = min_sz(ii + bs, rows), jend = min_sz(jj + bs, cols);
+            for (size_t i = ii; i < iend; i++)
+                for (size_t j = jj; j < jend; j++)
+                    B[j * rows + i] = A[i * cols + j];
+        }
+}
+
+/* 一直对半切较长的一边, 直到子块小到一定在 L1 里, 每一级缓存都自动合适 */
+#define OBLIVIOUS_BASE 256 /* 元素个数, 16 x 16 */
+
+static void transpose_rec(size_t rows, size_t cols, const double* A,
+                          size_t lda, double* B, size_t ldb) {
+    if (rows * cols <= OBLIVIOUS_BASE) {
+        for (size_t i = 0; i < rows; i++)
+            for (size_t j = 0; j < cols; j++)
+                B[j * ldb + i] = A[i * lda + j];
+    } else if (rows >= cols) {
+        size_t h = rows / 2;
+        transpose_rec(h, cols, A, lda, B, ldb);
+        transpose_rec(rows - h, cols, A + h * lda, lda, B + h, ldb);
+    } else {
+        size_t h = cols / 2;
+        transpose_rec(rows, h, A, lda, B, ldb);
+        transpose_rec(rows, cols - h, A + h, lda, B + h * ldb, ldb);
+    }
+}
+
+void transpose_oblivious(size_t rows, size_t cols, const double* A,
+                         double* B) {
+    transpose_rec(rows, cols, A, cols, B, rows);
+}
+
+/* ---------------- 缓存容量测量 ---------------- */
+
+#define LINE 64
+#define PROBE_MIN (4 << 10)
+
+typedef struct node {
+    struct node* next;
+    char pad[LINE - sizeof(struct node*)];
+} node;
+
+/* 工作集 bytes 上的一条随机环 (Sattolo 算法), 每个节点占一整行 */
+static double chase_ns(node* nodes, size_t bytes, size_t* perm) {
+    size_t count = bytes / LINE;
+    for (size_t i = 0; i < count; i++)
+        perm[i] = i;
+    for (size_t i = count - 1; i > 0; i--) {
+        size_t j = (size_t)rand() % i;
+        size_t t = perm[i];
+        perm[i] = perm[j];
+        perm[j] = t;
+    }
+    for (size_t i = 0; i < count; i++)
+        nodes[perm[i]].next = &nodes[perm[(i + 1) % count]];
+
+    size_t steps = 1 << 21;
+    node* p = &nodes[perm[0]];
+    for (size_t i = 0; i < count; i++) /* 预热 */
+        p = p->next;
+    double t0 = now_sec();
+    for (size_t i = 0; i < steps; i++)
+        p = p->next;
+    double t = now_sec() - t0;
+    /* 让编译器保留整条链 */
+    __asm__ volatile("" : : "r"(p));
+    return t * 1e9 / steps;
+}
+
+static size_t probe_size(int step) {
+    /* 4K, 4K*√2, 8K, ...; 取整到行 */
+    double s = PROBE_MIN * pow(2.0, step / 2.0);
+    return (size_t)s / LINE * LINE;
+}
+
+/*
+ * L1: 延迟仍不超过最小工作集 1.5 倍的最大工作集。
+ * L2: 从 4 倍 L1 开始 (那里 L1 基本不命中) 的延迟作基准, 不超过它
+ *     2 倍的最大工作集; 中间 TLB 不命中带来的缓慢上升不算跳变
+ */
+cache_sizes cache_probe(double* lat_ns) {
+    double lat[CACHE_PROBE_STEPS];
+    size_t max_bytes = probe_size(CACHE_PROBE_STEPS - 1);
+    node* nodes = aligned_alloc(LINE, max_bytes);
+    size_t* perm = malloc(max_bytes / LINE * sizeof(size_t));
+    for (int s = 0; s < CACHE_PROBE_STEPS; s++)
+        lat[s] = chase_ns(nodes, probe_size(s), perm);
+    free(perm);
+    free(nodes);
+    if (lat_ns)
+        memcpy(lat_ns, lat, sizeof(lat));
+
+    cache_sizes cs = {0, 0, 1};
+    int s1 = 0;
+    while (s1 + 1 < CACHE_PROBE_STEPS && lat[s1 + 1] <= 1.5 * lat[0])
+        s1++;
+    cs.l1 = probe_size(s1);
+    int base = s1 + 4 < CACHE_PROBE_STEPS ? s1 + 4 : CACHE_PROBE_STEPS - 1;
+    int s2 = base;
+    while (s2 + 1 < CACHE_PROBE_STEPS && lat[s2 + 1] <= 2 * lat[base])
+        s2++;
+    cs.l2 = probe_size(s2);
+
+    /* 没有明显拐点 (例如虚拟机里测不准) 时退回系统报告的值 */
+    long l1 = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+    long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (s1 == 0 || s2 == CACHE_PROBE_STEPS - 1 || cs.l2 <= cs.l1) {
+        cs.l1 = l1 > 0 ? (size_t)l1 : 32 << 10;
+        cs.l2 = l2 > 0 ? (size_t)l2 : 1 << 20;
+        cs.measured = 0;
+    }
+    return cs;
+}
+
+/* ---------------- 推算和调优 ---------------- */
+
+static size_t round_down(size_t x, size_t m) {
+    return x < m ? m : x / m * m;
+}
+
+/* B 的块占 L2 的四分之一, 给 A, C 的行段和其他数据留出空间 */
+size_t mm_blocked_predict(const cache_sizes* cs) {
+    size_t bs = (size_t)sqrt((double)cs->l2 / 4 / sizeof(double));
+    return round_down(bs, 8);
+}
+
+/*
+ * kc x 8 的 B 面板每个 k 占一整行缓存 (行优先, 步长 n), 占 L1 的一半;
+ * mc x kc 的 A 块占 L2 的一半
+ */
+mm_tile mm_tiled_predict(const cache_sizes* cs) {
+    mm_tile t;
+    t.kc = round_down(cs->l1 / 2 / LINE, 8);
+    t.mc = round_down(cs->l2 / 2 / (t.kc * sizeof(double)), MR);
+    return t;
+}
+
+/* 在随机 n x n 矩阵上跑一次 f, 返回秒数 (两次取快的) */
+typedef void (*mm_run)(size_t n, const double* A, const double* B, double* C,
+                       const void* arg);
+
+static double time_mm(size_t n, mm_run f, const void* arg) {
+    double* A = malloc(n * n * sizeof(double));
+    double* B = malloc(n * n * sizeof(double));
+    double* C = calloc(n * n, sizeof(double));
+    for (size_t i = 0; i < n * n; i++) {
+        A[i] = (double)(i % 7);
+        B[i] = (double)(i % 5);
+    }
+    double best = 1e30;
+    for (int rep = 0; rep < 2; rep++) {
+        double t0 = now_sec();
+        f(n, A, B, C, arg);
+        double t = now_sec() - t0;
+        best = t < best ? t : best;
+    }
+    free(A);
+    free(B);
+    free(C);
+    return best;
+}
+
+static void run_blocked(size_t n, const double* A, const double* B, double* C,
+                        const void* arg) {
+    mm_blocked(n, A, B, C, *(const size_t*)arg);
+}
+
+static void run_tiled(size_t n, const double* A, const double* B, double* C,
+                      const void* arg) {
+    mm_tiled(n, A, B, C, *(const mm_tile*)arg);
+}
+
+size_t mm_blocked_tune(const cache_sizes* cs, size_t n) {
+    size_t pred = mm_blocked_predict(cs);
+    size_t cands[] = {round_down(pred / 4, 8), round_down(pred / 2, 8), pred,
+                      pred * 2};
+    size_t best = pred;
+    double best_t = 1e30;
+    for (size_t c = 0; c < sizeof(cands) / sizeof(cands[0]); c++) {
+        double t = time_mm(n, run_blocked, &cands[c]);
+        if (t < best_t) {
+            best_t = t;
+            best = cands[c];
+        }
+    }
+    return best;
+}
+
+mm_tile mm_tiled_tune(const cache_sizes* cs, size_t n) {
+    mm_tile pred = mm_tiled_predict(cs);
+    mm_tile best = pred;
+    double best_t = 1e30;
+    for (int a = -1; a <= 1; a++)
+        for (int b = -1; b <= 1; b++) {
+            mm_tile t;
+            t.kc = round_down(a < 0 ? pred.kc / 2 : pred.kc << a, 8);
+            t.mc = round_down(b < 0 ? pred.mc / 2 : pred.mc << b, MR);
+            double sec = time_mm(n, run_tiled, &t);
+            if (sec < best_t) {
+                best_t = sec;
+                best = t;
+            }
+        }
+    return best;
+}
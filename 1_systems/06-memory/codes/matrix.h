@@ -0,0 +1,71 @@
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include <stddef.h>
+
+/*
+ * 行优先 n x n double 矩阵的乘法和转置 (6.6 节: 局部性对性能的影响)
+ *
+ * - mm_ijk ... mm_kji: 同一个三重循环的六种嵌套顺序, 区别只在内层循环
+ *   对 A, B, C 的访问步长
+ * - mm_blocked: 分块 (bijk), B 的 bs x bs 块在内层反复使用, 要留在缓存里
+ * - mm_tiled: 分块 + 寄存器分块, 4 x 8 的 C 子块整个放在寄存器里,
+ *   kc 决定 B 的面板能否留在 L1, mc 决定 A 的块能否留在 L2
+ * - transpose_*: 朴素, 分块, 以及不需要知道缓存大小的递归 (cache-oblivious)
+ *
+ * 所有乘法都是 C += A * B, 调用者负责清零 C。
+ */
+
+void mm_ijk(size_t n, const double* A, const double* B, double* C);
+void mm_jik(size_t n, const double* A, const double* B, double* C);
+void mm_jki(size_t n, const double* A, const double* B, double* C);
+void mm_kji(size_t n, const double* A, const double* B, double* C);
+void mm_kij(size_t n, const double* A, const double* B, double* C);
+void mm_ikj(size_t n, const double* A, const double* B, double* C);
+
+void mm_blocked(size_t n, const double* A, const double* B, double* C,
+                size_t bs);
+
+typedef struct {
+    size_t mc; /* A 的行块, mc x kc 留在 L2 */
+    size_t kc; /* 公共维度块, B 的 kc x 8 面板留在 L1 */
+} mm_tile;
+
+/* 有 AVX2 + FMA 时用向量化的微内核, 否则用标量版本 */
+void mm_tiled(size_t n, const double* A, const double* B, double* C,
+              mm_tile tile);
+
+/* B = A^T, A 是 rows x cols, B 是 cols x rows */
+void transpose_naive(size_t rows, size_t cols, const double* A, double* B);
+void transpose_blocked(size_t rows, size_t cols, const double* A, double* B,
+                       size_t bs);
+void transpose_oblivious(size_t rows, size_t cols, const double* A,
+                         double* B);
+
+/* 测得的数据缓存容量, 字节 */
+typedef struct {
+    size_t l1;
+    size_t l2;
+    int measured; /* 0: 没测出拐点, 用的是 sysconf 的值 */
+} cache_sizes;
+
+/*
+ * 指针追逐测量: 工作集从 4KB 到 64MB, 每次乘 √2; 每次随机访问都
+ * 依赖上一次, 平均延迟出现跳变的位置就是一级缓存的容量。
+ * lat_ns 非空时写入每个工作集的延迟 (CACHE_PROBE_STEPS 个)
+ */
+#define CACHE_PROBE_STEPS 29
+cache_sizes cache_probe(double* lat_ns);
+
+/* 由缓存容量推算的分块大小 */
+size_t mm_blocked_predict(const cache_sizes* cs);
+mm_tile mm_tiled_predict(const cache_sizes* cs);
+
+/*
+ * 自动调优: 以推算值为中心, 在 n x n 的矩阵上实测几组候选分块
+ * (减半, 不变, 加倍), 返回最快的一组
+ */
+size_t mm_blocked_tune(const cache_sizes* cs, size_t n);
+mm_tile mm_tiled_tune(const cache_sizes* cs, size_t n);
+
+#endif
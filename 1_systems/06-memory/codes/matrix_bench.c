@@ -0,0 +1,182 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "matrix.h"
+
+/*
+ * 测缓存容量, 据此推算并调优分块大小, 然后随矩阵变大比较各个乘法
+ * 内核的 GFLOP/s 和各个转置的 GB/s; 所有结果都和 ikj 的结果逐个比较
+ *
+ * 编译: gcc -O2 matrix.c matrix_bench.c -o matrix_bench -lm
+ * 运行: ./matrix_bench [最大 n]
+ */
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+typedef enum { K_IJK, K_JIK, K_JKI, K_KJI, K_KIJ, K_IKJ, K_BLOCK, K_TILE } kid;
+static const char* names[] = {"ijk", "jik",     "jki",  "kji",
+                              "kij", "ikj",     "block", "tile"};
+#define NKERNELS 8
+/* 朴素的顺序在大矩阵上太慢, 超过这个 n 就不跑了 */
+#define NAIVE_MAX 512
+
+static size_t block_bs;
+static mm_tile tile;
+
+static void run(kid k, size_t n, const double* A, const double* B,
+                double* C) {
+    switch (k) {
+    case K_IJK:
+        mm_ijk(n, A, B, C);
+        break;
+    case K_JIK:
+        mm_jik(n, A, B, C);
+        break;
+    case K_JKI:
+        mm_jki(n, A, B, C);
+        break;
+    case K_KJI:
+        mm_kji(n, A, B, C);
+        break;
+    case K_KIJ:
+        mm_kij(n, A, B, C);
+        break;
+    case K_IKJ:
+        mm_ikj(n, A, B, C);
+        break;
+    case K_BLOCK:
+        mm_blocked(n, A, B, C, block_bs);
+        break;
+    case K_TILE:
+        mm_tiled(n, A, B, C, tile);
+        break;
+    }
+}
+
+/* 小整数元素: 所有部分和都能精确表示, 不同顺序的结果必须完全相同 */
+static void fill(double* M, size_t n, unsigned seed) {
+    for (size_t i = 0; i < n * n; i++)
+        M[i] = (double)((i * 2654435761u + seed) % 17) - 8;
+}
+
+static int gemm_table(size_t max_n) {
+    int ok = 1;
+    printf("\nGEMM GFLOP/s\n%6s", "n");
+    for (int k = 0; k < NKERNELS; k++)
+        printf(" %7s", names[k]);
+    printf("\n");
+    for (size_t n = 64; n <= max_n; n *= 2) {
+        double* A = malloc(n * n * sizeof(double));
+        double* B = malloc(n * n * sizeof(double));
+        double* C = malloc(n * n * sizeof(double));
+        double* ref = calloc(n * n, sizeof(double));
+        fill(A, n, 1);
+        fill(B, n, 2);
+        mm_ikj(n, A, B, ref);
+
+        printf("%6zu", n);
+        for (int k = 0; k < NKERNELS; k++) {
+            if (k < K_BLOCK && n > NAIVE_MAX) {
+                printf(" %7s", "-");
+                continue;
+            }
+            /* 小矩阵重复几次, 让每次计时至少约 0.1 秒 */
+            double flops = 2.0 * n * n * n;
+            int reps = (int)(2e8 / flops) + 1;
+            double best = 1e30;
+            for (int r = 0; r < reps; r++) {
+                memset(C, 0, n * n * sizeof(double));
+                double t0 = now_sec();
+                run((kid)k, n, A, B, C);
+                double t = now_sec() - t0;
+                best = t < best ? t : best;
+            }
+            printf(" %7.2f", flops / best * 1e-9);
+            fflush(stdout);
+            ok &= memcmp(C, ref, n * n * sizeof(double)) == 0;
+        }
+        printf("\n");
+        free(A);
+        free(B);
+        free(C);
+        free(ref);
+    }
+    return ok;
+}
+
+static int transpose_table(size_t max_n, size_t bs) {
+    int ok = 1;
+    printf("\ntranspose GB/s (read + write)\n%6s %9s %9s %9s\n", "n",
+           "naive", "blocked", "oblivious");
+    for (size_t n = 256; n <= max_n * 4; n *= 2) {
+        /* 故意用 n + 1 列, 避开 2 的幂步长在组相联缓存里的冲突 */
+        size_t rows = n, cols = n + 1;
+        double* A = malloc(rows * cols * sizeof(double));
+        double* B = malloc(rows * cols * sizeof(double));
+        double* ref = malloc(rows * cols * sizeof(double));
+        for (size_t i = 0; i < rows * cols; i++)
+            A[i] = (double)i;
+        transpose_naive(rows, cols, A, ref);
+
+        printf("%6zu", n);
+        double bytes = 2.0 * rows * cols * sizeof(double);
+        for (int v = 0; v < 3; v++) {
+            double best = 1e30;
+            for (int r = 0; r < 3; r++) {
+                memset(B, 0, rows * cols * sizeof(double));
+                double t0 = now_sec();
+                if (v == 0)
+                    transpose_naive(rows, cols, A, B);
+                else if (v == 1)
+                    transpose_blocked(rows, cols, A, B, bs);
+                else
+                    transpose_oblivious(rows, cols, A, B);
+                double t = now_sec() - t0;
+                best = t < best ? t : best;
+            }
+            printf(" %9.2f", bytes / best * 1e-9);
+            ok &= memcmp(B, ref, rows * cols * sizeof(double)) == 0;
+        }
+        printf("\n");
+        free(A);
+        free(B);
+        free(ref);
+    }
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    size_t max_n = argc > 1 ? strtoul(argv[1], NULL, 10) : 1024;
+
+    double lat[CACHE_PROBE_STEPS];
+    cache_sizes cs = cache_probe(lat);
+    printf("pointer-chase latency\n");
+    for (int s = 0; s < CACHE_PROBE_STEPS; s += 2)
+        printf("  %8zu KB %6.2f ns\n", ((size_t)4 << (s / 2)), lat[s]);
+    printf("L1 %zu KB, L2 %zu KB (%s)\n", cs.l1 >> 10, cs.l2 >> 10,
+           cs.measured ? "measured" : "sysconf, no clear knee");
+
+    size_t bs_pred = mm_blocked_predict(&cs);
+    mm_tile tile_pred = mm_tiled_predict(&cs);
+    block_bs = mm_blocked_tune(&cs, 512);
+    tile = mm_tiled_tune(&cs, 512);
+    printf("block: predicted bs %zu, tuned %zu\n", bs_pred, block_bs);
+    printf("tile: predicted mc %zu kc %zu, tuned mc %zu kc %zu\n",
+           tile_pred.mc, tile_pred.kc, tile.mc, tile.kc);
+
+    /* 转置分块: 两个 bs x bs 块留在 L1 */
+    size_t tbs = 8;
+    while (2 * (tbs * 2) * (tbs * 2) * sizeof(double) <= cs.l1)
+        tbs *= 2;
+
+    int ok = gemm_table(max_n);
+    ok &= transpose_table(max_n, tbs);
+    printf("\nresults %s\n", ok ? "identical" : "DIFFER");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,48 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "cachesim.h"
+
+/*
+ * 手工插桩的访存轨迹
+ *
+ * LD(x) 读左值 x, ST(x, v) 把 v 写进左值 x。用 -DTRACE 编译时每次访问
+ * 还会向标准输出写一条 trace_pack 格式的记录 (本机字节序), 否则就是
+ * 普通的读写。x 会被求值两次 (取地址和读写), 不要带副作用。
+ * 只标注真正访问内存的引用, 局部变量当作寄存器。
+ */
+
+#ifdef TRACE
+
+#define TRACE_BUF 65536
+
+static uint64_t trace_buf[TRACE_BUF];
+static size_t trace_len;
+
+static inline void trace_flush(void) {
+    fwrite(trace_buf, sizeof(uint64_t), trace_len, stdout);
+    trace_len = 0;
+}
+
+static inline void trace_rec(const void* p, unsigned size, int write) {
+    trace_buf[trace_len++] = trace_pack((uintptr_t)p, size, write);
+    if (trace_len == TRACE_BUF)
+        trace_flush();
+}
+
+#define LD(x) (trace_rec(&(x), sizeof(x), 0), (x))
+#define ST(x, v) (trace_rec(&(x), sizeof(x), 1), (x) = (v))
+
+#else
+
+static inline void trace_flush(void) {}
+
+#define LD(x) (x)
+#define ST(x, v) ((x) = (v))
+
+#endif
+
+#endif
@@ -0,0 +1,239 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "trace.h"
+
+/*
+ * 第 5 章的 combine 和 copy_array, 以及 matrix.c 的乘法和转置, 每个内存
+ * 引用都用 LD / ST 标注, 运行时把访存轨迹写到标准输出, 交给 csim 模拟:
+ *
+ *   ./trace_kernels combine1 1000000 | ./csim -
+ *   ./trace_kernels mm-jki 256 | ./csim -c 64:8:64,1024:16:64 -
+ *
+ * 编译: gcc -O2 -DTRACE trace_kernels.c -o trace_kernels
+ * 运行: ./trace_kernels <kernel> <n> [分块大小]
+ */
+
+/* ---------------- combine (05-performance/codes/vec.c, int, '+') -------- */
+
+typedef struct {
+    long len;
+    int* data;
+} vec;
+
+static long vec_length(vec* v) {
+    return LD(v->len);
+}
+
+static int get_vec_element(vec* v, long i, int* dest) {
+    if (i < 0 || i >= LD(v->len))
+        return 0;
+    ST(*dest, LD(LD(v->data)[i]));
+    return 1;
+}
+
+/* 每次迭代: 调用 vec_length, 取元素经过 get_vec_element, 读写 *dest */
+static void combine1(vec* v, int* dest) {
+    ST(*dest, 0);
+    for (long i = 0; i < vec_length(v); i++) {
+        int val;
+        get_vec_element(v, i, &val);
+        ST(*dest, LD(*dest) + LD(val));
+    }
+}
+
+/* 长度和起始地址提到循环外, 但累加仍然经过 *dest */
+static void combine3(vec* v, int* dest) {
+    long length = vec_length(v);
+    int* data = LD(v->data);
+    ST(*dest, 0);
+    for (long i = 0; i < length; i++)
+        ST(*dest, LD(*dest) + LD(data[i]));
+}
+
+/* 累加在寄存器里: 每个元素一次读 */
+static void combine4(vec* v, int* dest) {
+    long length = vec_length(v);
+    int* data = LD(v->data);
+    int acc = 0;
+    for (long i = 0; i < length; i++)
+        acc += LD(data[i]);
+    ST(*dest, acc);
+}
+
+/* 2 x 2 展开: 访存和 combine4 一样, 只是顺序上成对出现 */
+static void combine6(vec* v, int* dest) {
+    long length = vec_length(v);
+    int* data = LD(v->data);
+    int acc0 = 0, acc1 = 0;
+    long i;
+    for (i = 0; i + 1 < length; i += 2) {
+        acc0 += LD(data[i]);
+        acc1 += LD(data[i + 1]);
+    }
+    for (; i < length; i++)
+        acc0 += LD(data[i]);
+    ST(*dest, acc0 + acc1);
+}
+
+/* ---------------- copy_array (05-performance/codes/mem.c) ---------------- */
+
+static void copy_array(long* src, long* dest, long n) {
+    for (long i = 0; i < n; i++)
+        ST(dest[i], LD(src[i]));
+}
+
+/* ---------------- 矩阵 (matrix.c) ---------------- */
+
+static void mm_ijk(size_t n, const double* A, const double* B, double* C) {
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++) {
+            double sum = LD(C[i * n + j]);
+            for (size_t k = 0; k < n; k++)
+                sum += LD(A[i * n + k]) * LD(B[k * n + j]);
+            ST(C[i * n + j], sum);
+        }
+}
+
+static void mm_kij(size_t n, const double* A, const double* B, double* C) {
+    for (size_t k = 0; k < n; k++)
+        for (size_t i = 0; i < n; i++) {
+            double r = LD(A[i * n + k]);
+            for (size_t j = 0; j < n; j++)
+                ST(C[i * n + j], LD(C[i * n + j]) + r * LD(B[k * n + j]));
+        }
+}
+
+static void mm_jki(size_t n, const double* A, const double* B, double* C) {
+    for (size_t j = 0; j < n; j++)
+        for (size_t k = 0; k < n; k++) {
+            double r = LD(B[k * n + j]);
+            for (size_t i = 0; i < n; i++)
+                ST(C[i * n + j], LD(C[i * n + j]) + LD(A[i * n + k]) * r);
+        }
+}
+
+static size_t min_sz(size_t a, size_t b) {
+    return a < b ? a : b;
+}
+
+static void mm_blocked(size_t n, const double* A, const double* B, double* C,
+                       size_t bs) {
+    for (size_t kk = 0; kk < n; kk += bs) {
+        size_t kend = min_sz(kk + bs, n);
+        for (size_t jj = 0; jj < n; jj += bs) {
+            size_t jend = min_sz(jj + bs, n);
+            for (size_t i = 0; i < n; i++)
+                for (size_t k = kk; k < kend; k++) {
+                    double r = LD(A[i * n + k]);
+                    for (size_t j = jj; j < jend; j++)
+                        ST(C[i * n + j],
+                           LD(C[i * n + j]) + r * LD(B[k * n + j]));
+                }
+        }
+    }
+}
+
+static void transpose_naive(size_t n, const double* A, double* B) {
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+            ST(B[j * n + i], LD(A[i * n + j]));
+}
+
+static void transpose_blocked(size_t n, const double* A, double* B,
+                              size_t bs) {
+    for (size_t ii = 0; ii < n; ii += bs)
+        for (size_t jj = 0; jj < n; jj += bs) {
+            size_t iend = min_sz(ii + bs, n), jend = min_sz(jj + bs, n);
+            for (size_t i = ii; i < iend; i++)
+                for (size_t j = jj; j < jend; j++)
+                    ST(B[j * n + i], LD(A[i * n + j]));
+        }
+}
+
+/* ---------------- main ---------------- */
+
+static const char* kernels[] = {
+    "combine1", "combine3",  "combine4", "combine6", "copy-fwd", "copy-bwd",
+    "copy-self", "mm-ijk",   "mm-kij",   "mm-jki",   "mm-block", "transpose",
+    "transpose-block"};
+#define NKERNELS (sizeof(kernels) / sizeof(kernels[0]))
+
+static void usage(const char* prog) {
+    fprintf(stderr, "usage: %s <kernel> <n> [block]\nkernels:", prog);
+    for (size_t k = 0; k < NKERNELS; k++)
+        fprintf(stderr, " %s", kernels[k]);
+    fprintf(stderr, "\n");
+    exit(1);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3)
+        usage(argv[0]);
+    const char* name = argv[1];
+    long n = atol(argv[2]);
+    size_t bs = argc > 3 ? strtoul(argv[3], NULL, 10) : 32;
+    if (n <= 0 || bs == 0)
+        usage(argv[0]);
+
+    if (!strncmp(name, "combine", 7)) {
+        vec* v = malloc(sizeof(vec));
+        int* dest = malloc(sizeof(int));
+        if (!v || !dest || !(v->data = calloc(n, sizeof(int)))) {
+            perror("malloc failed");
+            return 1;
+        }
+        v->len = n;
+        if (!strcmp(name, "combine1"))
+            combine1(v, dest);
+        else if (!strcmp(name, "combine3"))
+            combine3(v, dest);
+        else if (!strcmp(name, "combine4"))
+            combine4(v, dest);
+        else if (!strcmp(name, "combine6"))
+            combine6(v, dest);
+        else
+            usage(argv[0]);
+    } else if (!strncmp(name, "copy", 4)) {
+        long* a = calloc(n + 1, sizeof(long));
+        if (!a) {
+            perror("malloc failed");
+            return 1;
+        }
+        /* 和 mem.c 一样: 源和目的错开一个元素, 或者完全重合 */
+        if (!strcmp(name, "copy-fwd"))
+            copy_array(a + 1, a, n);
+        else if (!strcmp(name, "copy-bwd"))
+            copy_array(a, a + 1, n);
+        else if (!strcmp(name, "copy-self"))
+            copy_array(a, a, n);
+        else
+            usage(argv[0]);
+    } else {
+        size_t m = (size_t)n;
+        double* A = calloc(m * m, sizeof(double));
+        double* B = calloc(m * m, sizeof(double));
+        double* C = calloc(m * m, sizeof(double));
+        if (!A || !B || !C) {
+            perror("malloc failed");
+            return 1;
+        }
+        if (!strcmp(name, "mm-ijk"))
+            mm_ijk(m, A, B, C);
+        else if (!strcmp(name, "mm-kij"))
+            mm_kij(m, A, B, C);
+        else if (!strcmp(name, "mm-jki"))
+            mm_jki(m, A, B, C);
+        else if (!strcmp(name, "mm-block"))
+            mm_blocked(m, A, B, C, bs);
+        else if (!strcmp(name, "transpose"))
+            transpose_naive(m, A, B);
+        else if (!strcmp(name, "transpose-block"))
+            transpose_blocked(m, A, B, bs);
+        else
+            usage(argv[0]);
+    }
+    trace_flush();
+    return 0;
+}
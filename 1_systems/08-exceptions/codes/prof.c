@@ -0,0 +1,433 @@
+#define _GNU_SOURCE
+#include "prof.h"
+
+#include <dlfcn.h>
+#include <elf.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <link.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+/* 每个线程的样本缓冲区, 以字为单位: 每个样本是 [深度, PC, 返回地址...] */
+#define PROF_BUF_WORDS (1 << 21)
+
+typedef struct prof_buf {
+    struct prof_buf* next; /* 全局链表, 只增不删 */
+    pid_t tid;
+    timer_t timer;
+    int has_timer;
+    uintptr_t stack_hi; /* 帧指针必须落在 [sp, stack_hi) 内 */
+    uintptr_t* words;
+    _Atomic size_t used;  /* 已发布的字数, 只有本线程的处理程序写 */
+    size_t samples;       /* 以下三项只有处理程序写, 停止后才读 */
+    size_t dropped;
+    uint64_t handler_ns;
+} prof_buf;
+
+static _Atomic(prof_buf*) bufs;
+static atomic_int running;
+static int prof_hz;
+static int use_itimer; /* timer_create 不可用, 整个进程一个 ITIMER_PROF */
+static const char* out_path;
+static atomic_size_t lost; /* 落在没有登记的线程上的信号 */
+static double cpu_start;   /* prof_start 时进程的 CPU 时间 */
+
+static __thread prof_buf* my_buf;
+
+static double cpu_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+/* ---------------- 信号处理程序 ---------------- */
+
+#if defined(__x86_64__)
+#define UC_PC(uc) ((uintptr_t)(uc)->uc_mcontext.gregs[REG_RIP])
+#define UC_SP(uc) ((uintptr_t)(uc)->uc_mcontext.gregs[REG_RSP])
+#define UC_FP(uc) ((uintptr_t)(uc)->uc_mcontext.gregs[REG_RBP])
+#elif defined(__aarch64__)
+#define UC_PC(uc) ((uintptr_t)(uc)->uc_mcontext.pc)
+#define UC_SP(uc) ((uintptr_t)(uc)->uc_mcontext.sp)
+#define UC_FP(uc) ((uintptr_t)(uc)->uc_mcontext.regs[29])
+#else
+#error "prof.c: only x86-64 and AArch64 are supported"
+#endif
+
+/*
+ * 只用异步信号安全的操作: 读寄存器和栈, 写本线程的缓冲区,
+ * clock_gettime。两种架构的栈帧都是 [fp] = 上一帧的 fp,
+ * [fp + 8] = 返回地址; 每一步都检查 fp 对齐, 在栈内且严格向上,
+ * 遇到没有帧指针的代码最多得到一条截断的栈, 不会读到非法地址
+ */
+static void handler(int sig, siginfo_t* si, void* ctx) {
+    (void)sig;
+    (void)si;
+    prof_buf* b = my_buf;
+    if (!b) {
+        atomic_fetch_add_explicit(&lost, 1, memory_order_relaxed);
+        return;
+    }
+    if (!atomic_load_explicit(&running, memory_order_relaxed))
+        return;
+    int saved_errno = errno;
+    uint64_t t0 = now_ns();
+
+    ucontext_t* uc = ctx;
+    size_t used = atomic_load_explicit(&b->used, memory_order_relaxed);
+    b->samples++;
+    if (used + 1 + PROF_MAX_DEPTH > PROF_BUF_WORDS) {
+        b->dropped++;
+    } else {
+        uintptr_t* out = b->words + used + 1;
+        uintptr_t fp = UC_FP(uc), lo = UC_SP(uc), hi = b->stack_hi;
+        size_t depth = 0;
+        out[depth++] = UC_PC(uc);
+        while (depth < PROF_MAX_DEPTH && fp >= lo && fp + 16 <= hi &&
+               !(fp & 7)) {
+            const uintptr_t* frame = (const uintptr_t*)fp;
+            if (!frame[1])
+                break;
+            out[depth++] = frame[1];
+            if (frame[0] <= fp)
+                break;
+            fp = frame[0];
+        }
+        b->words[used] = depth;
+        atomic_store_explicit(&b->used, used + 1 + depth,
+                              memory_order_release);
+    }
+
+    b->handler_ns += now_ns() - t0;
+    errno = saved_errno;
+}
+
+/* ---------------- 登记线程 ---------------- */
+
+static struct timespec period(void) {
+    struct timespec ts = {0, 1000000000L / prof_hz};
+    if (prof_hz == 1)
+        ts = (struct timespec){1, 0};
+    return ts;
+}
+
+static int arm_timer(prof_buf* b) {
+    struct sigevent sev;
+    memset(&sev, 0, sizeof(sev));
+    sev.sigev_notify = SIGEV_THREAD_ID;
+    sev.sigev_signo = SIGPROF;
+    sev._sigev_un._tid = b->tid;
+    if (timer_create(CLOCK_THREAD_CPUTIME_ID, &sev, &b->timer) < 0)
+        return -1;
+    struct itimerspec its = {period(), period()};
+    if (timer_settime(b->timer, 0, &its, NULL) < 0) {
+        timer_delete(b->timer);
+        return -1;
+    }
+    b->has_timer = 1;
+    return 0;
+}
+
+int prof_thread_start(void) {
+    if (my_buf)
+        return 0;
+    prof_buf* b = calloc(1, sizeof(prof_buf));
+    if (!b)
+        return -1;
+    /* 只有真正写到的页才占内存 */
+    b->words = mmap(NULL, PROF_BUF_WORDS * sizeof(uintptr_t),
+                    PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (b->words == MAP_FAILED) {
+        free(b);
+        return -1;
+    }
+    b->tid = (pid_t)syscall(SYS_gettid);
+
+    pthread_attr_t attr;
+    void* stack;
+    size_t size;
+    if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+        if (pthread_attr_getstack(&attr, &stack, &size) == 0)
+            b->stack_hi = (uintptr_t)stack + size;
+        pthread_attr_destroy(&attr);
+    }
+
+    b->next = atomic_load(&bufs);
+    while (!atomic_compare_exchange_weak(&bufs, &b->next, b))
+        ;
+    my_buf = b;
+    if (!use_itimer && arm_timer(b) < 0)
+        return -1;
+    return 0;
+}
+
+void prof_thread_stop(void) {
+    prof_buf* b = my_buf;
+    if (b && b->has_timer) {
+        timer_delete(b->timer);
+        b->has_timer = 0;
+    }
+}
+
+static void write_at_exit(void) {
+    prof_write(out_path);
+}
+
+int prof_start(int hz, const char* out) {
+    if (hz <= 0 || hz > 1000000) {
+        errno = EINVAL;
+        return -1;
+    }
+    prof_hz = hz;
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = handler;
+    sa.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    if (sigaction(SIGPROF, &sa, NULL) < 0)
+        return -1;
+    cpu_start = cpu_sec();
+    atomic_store(&running, 1);
+
+    if (prof_thread_start() < 0) {
+        /* 没有线程 CPU 时钟定时器: 退回进程级的 ITIMER_PROF */
+        use_itimer = 1;
+        struct timespec p = period();
+        struct timeval tv = {p.tv_sec, p.tv_nsec / 1000};
+        struct itimerval it = {tv, tv};
+        if (!my_buf || setitimer(ITIMER_PROF, &it, NULL) < 0)
+            return -1;
+    }
+    if (out) {
+        out_path = out;
+        atexit(write_at_exit);
+    }
+    return 0;
+}
+
+/* ---------------- 符号化 ---------------- */
+
+typedef struct {
+    uintptr_t lo, hi;
+    const char* name;
+} prof_sym;
+
+static prof_sym* syms;
+static size_t nsyms;
+
+static int sym_cmp(const void* a, const void* b) {
+    uintptr_t x = ((const prof_sym*)a)->lo, y = ((const prof_sym*)b)->lo;
+    return (x > y) - (x < y);
+}
+
+/* dl_iterate_phdr 第一个给出的是主程序, dlpi_addr 是 PIE 的装载基址 */
+static int main_base(struct dl_phdr_info* info, size_t size, void* data) {
+    (void)size;
+    *(uintptr_t*)data = info->dlpi_addr;
+    return 1;
+}
+
+/* 读可执行文件的 .symtab (被 strip 时用 .dynsym), 保留所有函数符号 */
+static void load_symbols(void) {
+    uintptr_t base = 0;
+    dl_iterate_phdr(main_base, &base);
+    int fd = open("/proc/self/exe", O_RDONLY);
+    if (fd < 0)
+        return;
+    struct stat st;
+    const char* img = MAP_FAILED;
+    if (fstat(fd, &st) == 0)
+        img = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (img == MAP_FAILED)
+        return;
+
+    const ElfW(Ehdr)* eh = (const ElfW(Ehdr)*)img;
+    if (memcmp(eh->e_ident, ELFMAG, SELFMAG) != 0)
+        return;
+    const ElfW(Shdr)* sh = (const ElfW(Shdr)*)(img + eh->e_shoff);
+    const ElfW(Shdr)* tab = NULL;
+    for (int i = 0; i < eh->e_shnum; i++) {
+        if (sh[i].sh_type == SHT_SYMTAB)
+            tab = &sh[i];
+        else if (sh[i].sh_type == SHT_DYNSYM && !tab)
+            tab = &sh[i];
+    }
+    if (!tab)
+        return;
+
+    const ElfW(Sym)* s = (const ElfW(Sym)*)(img + tab->sh_offset);
+    const char* strtab = img + sh[tab->sh_link].sh_offset;
+    size_t n = tab->sh_size / sizeof(ElfW(Sym));
+    syms = malloc(n * sizeof(prof_sym));
+    if (!syms)
+        return;
+    for (size_t i = 0; i < n; i++) {
+        if (ELF64_ST_TYPE(s[i].st_info) != STT_FUNC || !s[i].st_value ||
+            !s[i].st_size || s[i].st_shndx == SHN_UNDEF)
+            continue;
+        uintptr_t lo = base + s[i].st_value;
+        syms[nsyms++] =
+            (prof_sym){lo, lo + s[i].st_size, strtab + s[i].st_name};
+    }
+    qsort(syms, nsyms, sizeof(prof_sym), sym_cmp);
+}
+
+/* 主程序的符号表, 然后 dladdr (共享库的导出符号), 最后是库名或地址 */
+static const char* symbolize(uintptr_t addr, char* buf, size_t len) {
+    size_t lo = 0, hi = nsyms;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (syms[mid].lo <= addr)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo > 0 && addr < syms[lo - 1].hi)
+        return syms[lo - 1].name;
+
+    Dl_info info;
+    if (dladdr((void*)addr, &info)) {
+        if (info.dli_sname)
+            return info.dli_sname;
+        if (info.dli_fname) {
+            snprintf(buf, len, "[%s]", basename(info.dli_fname));
+            return buf;
+        }
+    }
+    snprintf(buf, len, "0x%lx", (unsigned long)addr);
+    return buf;
+}
+
+/* ---------------- 输出折叠栈 ---------------- */
+
+typedef struct {
+    char* s;
+    size_t len, cap;
+} strbuf;
+
+static int sb_append(strbuf* sb, const char* t) {
+    size_t n = strlen(t);
+    if (sb->len + n + 1 > sb->cap) {
+        size_t cap = sb->cap ? sb->cap * 2 : 256;
+        while (cap < sb->len + n + 1)
+            cap *= 2;
+        char* s = realloc(sb->s, cap);
+        if (!s)
+            return -1;
+        sb->s = s;
+        sb->cap = cap;
+    }
+    memcpy(sb->s + sb->len, t, n + 1);
+    sb->len += n;
+    return 0;
+}
+
+static int str_cmp(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+/* 一个样本: 从最外层调用者到叶子, 用分号连接; 返回地址减 1 落在 call 内 */
+static char* fold(const uintptr_t* frames, size_t depth) {
+    strbuf sb = {0};
+    char buf[64];
+    for (size_t k = depth; k-- > 0;) {
+        uintptr_t addr = k == 0 ? frames[0] : frames[k] - 1;
+        if ((k + 1 < depth && sb_append(&sb, ";") < 0) ||
+            sb_append(&sb, symbolize(addr, buf, sizeof(buf))) < 0) {
+            free(sb.s);
+            return NULL;
+        }
+    }
+    return sb.s;
+}
+
+int prof_write(const char* path) {
+    static atomic_int written;
+    if (atomic_exchange(&written, 1))
+        return 0;
+
+    atomic_store(&running, 0);
+    double cpu = cpu_sec() - cpu_start;
+    if (use_itimer) {
+        struct itimerval off = {{0, 0}, {0, 0}};
+        setitimer(ITIMER_PROF, &off, NULL);
+    }
+    size_t total = 0, samples = 0, dropped = 0, threads = 0;
+    uint64_t handler_ns = 0;
+    for (prof_buf* b = atomic_load(&bufs); b; b = b->next) {
+        if (b->has_timer) {
+            timer_delete(b->timer);
+            b->has_timer = 0;
+        }
+        samples += b->samples;
+        dropped += b->dropped;
+        handler_ns += b->handler_ns;
+        threads++;
+        total += b->samples - b->dropped;
+    }
+
+    load_symbols();
+    char** lines = malloc((total ? total : 1) * sizeof(char*));
+    if (!lines)
+        return -1;
+    size_t n = 0;
+    for (prof_buf* b = atomic_load(&bufs); b; b = b->next) {
+        size_t used = atomic_load_explicit(&b->used, memory_order_acquire);
+        for (size_t w = 0; w < used && n < total; w += 1 + b->words[w]) {
+            char* line = fold(b->words + w + 1, b->words[w]);
+            if (line)
+                lines[n++] = line;
+        }
+    }
+    qsort(lines, n, sizeof(char*), str_cmp);
+
+    FILE* out = strcmp(path, "-") ? fopen(path, "w") : stdout;
+    if (!out) {
+        perror(path);
+        return -1;
+    }
+    for (size_t i = 0; i < n;) {
+        size_t j = i + 1;
+        while (j < n && !strcmp(lines[i], lines[j]))
+            j++;
+        fprintf(out, "%s %zu\n", lines[i], j - i);
+        i = j;
+    }
+    if (out != stdout)
+        fclose(out);
+    else
+        fflush(out);
+
+    /* 实际频率可能低于 prof_hz, 见 prof.h */
+    fprintf(stderr,
+            "prof: %zu samples from %zu threads (%zu dropped, %zu lost) in "
+            "%.2f s CPU = %.0f Hz, handler %.3f ms = %.3f%% of CPU time\n",
+            samples, threads, dropped, atomic_load(&lost), cpu,
+            cpu > 0 ? samples / cpu : 0.0, handler_ns * 1e-6,
+            cpu > 0 ? handler_ns * 1e-9 / cpu * 100 : 0.0);
+    for (size_t i = 0; i < n; i++)
+        free(lines[i]);
+    free(lines);
+    return 0;
+}
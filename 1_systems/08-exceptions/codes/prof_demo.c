@@ -0,0 +1,114 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "prof.h"
+
+/*
+ * 对一个两线程的负载采样: 先不开分析器测一遍, 再以 1 kHz 采样测一遍,
+ * 比较耗时得到开销, 折叠栈写入文件
+ *
+ * 编译: gcc -O2 -fno-omit-frame-pointer -pthread prof.c prof_demo.c -o prof_demo
+ * 运行: ./prof_demo [输出文件, 默认 prof.folded] [采样频率, 默认 1000]
+ * 火焰图: flamegraph.pl prof.folded > prof.svg
+ */
+
+#define ROUNDS 3
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* noinline 保证火焰图里每个函数各占一层 */
+__attribute__((noinline)) static long collatz_steps(long x) {
+    long steps = 0;
+    while (x != 1) {
+        x = (x & 1) ? 3 * x + 1 : x / 2;
+        steps++;
+    }
+    return steps;
+}
+
+__attribute__((noinline)) static long collatz(long n) {
+    long total = 0;
+    for (long i = 1; i < n; i++)
+        total += collatz_steps(i);
+    return total;
+}
+
+static int cmp_int(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+/* qsort 在 libc 里, 火焰图中由 dladdr 给出名字 */
+__attribute__((noinline)) static long sort_random(int n) {
+    int* a = malloc(n * sizeof(int));
+    if (!a)
+        return 0;
+    unsigned s = 1;
+    for (int i = 0; i < n; i++) {
+        s = s * 1103515245 + 12345;
+        a[i] = (int)(s >> 8);
+    }
+    qsort(a, n, sizeof(int), cmp_int);
+    long r = a[n / 2];
+    free(a);
+    return r;
+}
+
+__attribute__((noinline)) static double harmonic(long n) {
+    double h = 0;
+    for (long i = 1; i <= n; i++)
+        h += 1.0 / i;
+    return h;
+}
+
+static volatile long sink;
+
+static void* worker(void* arg) {
+    int profiled = *(int*)arg;
+    if (profiled)
+        prof_thread_start();
+    sink += (long)harmonic(150000000);
+    if (profiled)
+        prof_thread_stop();
+    return NULL;
+}
+
+/* 主线程: collatz 和排序; 另一个线程同时算调和级数 */
+static double workload(int profiled) {
+    double t0 = now_sec();
+    pthread_t th;
+    pthread_create(&th, NULL, worker, &profiled);
+    sink += collatz(1500000);
+    sink += sort_random(3000000);
+    pthread_join(th, NULL);
+    return now_sec() - t0;
+}
+
+int main(int argc, char** argv) {
+    const char* out = argc > 1 ? argv[1] : "prof.folded";
+    int hz = argc > 2 ? atoi(argv[2]) : 1000;
+
+    double base = 1e9, prof = 1e9;
+    for (int r = 0; r < ROUNDS; r++) {
+        double t = workload(0);
+        base = t < base ? t : base;
+    }
+    if (prof_start(hz, NULL) < 0) {
+        perror("prof_start");
+        return 1;
+    }
+    for (int r = 0; r < ROUNDS; r++) {
+        double t = workload(1);
+        prof = t < prof ? t : prof;
+    }
+    printf("best of %d: %.3f s without profiler, %.3f s at %d Hz "
+           "(%+.2f%%)\n",
+           ROUNDS, base, prof, hz, (prof / base - 1) * 100);
+    return prof_write(out) < 0;
+}
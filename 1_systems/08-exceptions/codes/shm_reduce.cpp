@@ -0,0 +1,279 @@
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <new>
+#include <string>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "../../05-performance/codes/vec.hpp"
+
+/*
+ * 多进程归约: Vector 放在 shm_open 的共享内存里, 预先 fork 的
+ * N 个工作进程各用 combine 内核归约一段, 结果写进按缓存行填充的
+ * 共享数组, 用 futex 通知完成。同样的协议换成 N 个线程做对比,
+ * 比较启动开销和归约吞吐。
+ *
+ * 编译: g++ -std=c++20 -O2 -pthread shm_reduce.cpp -o shm_reduce
+ * 运行: ./shm_reduce [MB] [max_workers]
+ */
+
+#define MAX_WORKERS 64
+#define ROUNDS 20
+
+// 在一段 MAP_SHARED 映射里顺序分配, fork 出来的子进程看到同一份数据
+class ShmResource : public std::pmr::memory_resource {
+    char* base;
+    size_t size;
+    size_t used = 0;
+
+protected:
+    void* do_allocate(size_t bytes, size_t align) override {
+        size_t start = (used + align - 1) & ~(align - 1);
+        if (start + bytes > size)
+            throw std::bad_alloc();
+        used = start + bytes;
+        return base + start;
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const
+        noexcept override {
+        return this == &other;
+    }
+
+public:
+    explicit ShmResource(size_t size) : size(size) {
+        // 名字只在 shm_open 和 shm_unlink 之间存在, 映射由 fork 继承
+        std::string name = "/shm_reduce." + std::to_string(getpid());
+        int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0) {
+            perror("shm_open");
+            exit(1);
+        }
+        shm_unlink(name.c_str());
+        if (ftruncate(fd, size) < 0) {
+            perror("ftruncate");
+            exit(1);
+        }
+        void* p =
+            mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) {
+            perror("mmap");
+            exit(1);
+        }
+        base = static_cast<char*>(p);
+    }
+
+    ~ShmResource() override { munmap(base, size); }
+
+    // 记下当前位置, 之后可以整体退回去重新分配
+    size_t mark() const { return used; }
+    void rewind(size_t pos) { used = pos; }
+};
+
+// 每个工作者一条缓存行, 互不伪共享
+struct alignas(64) Slot {
+    long value;
+};
+
+// 控制块也在共享内存里; 三个 futex 各占一条缓存行
+struct Control {
+    alignas(64) std::atomic<uint32_t> job_seq; // 递增表示有新任务
+    int kernel;
+    char op;
+    int quit;
+    alignas(64) std::atomic<uint32_t> done;  // 本轮完成的工作者数
+    alignas(64) std::atomic<uint32_t> ready; // 已就绪的工作者数
+    Slot slots[MAX_WORKERS];
+};
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+
+// 不加 FUTEX_PRIVATE_FLAG: 等待者可能在另一个进程里
+static void futex_wait(std::atomic<uint32_t>* addr, uint32_t val) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAIT, val,
+            nullptr, nullptr, 0);
+}
+
+static void futex_wake(std::atomic<uint32_t>* addr, int n) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAKE, n,
+            nullptr, nullptr, 0);
+}
+
+static const std::pair<CombineFunction<long>, const char*> kernels[] = {
+    {combine4<long>, "combine4"},
+    {combine5<long>, "combine5"},
+    {combine6<long>, "combine6"},
+};
+
+static void worker_loop(Control* c, const std::vector<Vector<long>>& slices,
+                        int id, int nworkers) {
+    uint32_t seen = c->job_seq.load(std::memory_order_acquire);
+    c->ready.fetch_add(1, std::memory_order_release);
+    futex_wake(&c->ready, 1);
+
+    for (;;) {
+        uint32_t s;
+        while ((s = c->job_seq.load(std::memory_order_acquire)) == seen)
+            futex_wait(&c->job_seq, seen);
+        seen = s;
+        if (c->quit)
+            return;
+
+        long r;
+        kernels[c->kernel].first(slices[id], r, c->op);
+        c->slots[id].value = r;
+        if (c->done.fetch_add(1, std::memory_order_acq_rel) + 1 ==
+            (uint32_t)nworkers)
+            futex_wake(&c->done, 1);
+    }
+}
+
+static double now_sec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// 进程池和线程池共用同一个控制块和工作循环, 只是启动方式不同
+class Pool {
+    Control* c;
+    int n;
+    bool processes;
+    std::vector<pid_t> pids;
+    std::vector<std::thread> threads;
+
+    void wait_counter(std::atomic<uint32_t>* counter) {
+        uint32_t v;
+        while ((v = counter->load(std::memory_order_acquire)) < (uint32_t)n)
+            futex_wait(counter, v);
+    }
+
+public:
+    double startup_us;
+
+    Pool(Control* c, const std::vector<Vector<long>>& slices, int n,
+         bool processes)
+        : c(c), n(n), processes(processes) {
+        c->quit = 0;
+        c->ready.store(0);
+        double t0 = now_sec();
+        for (int i = 0; i < n; i++) {
+            if (!processes) {
+                threads.emplace_back(worker_loop, c, std::cref(slices), i, n);
+                continue;
+            }
+            pid_t pid = fork();
+            if (pid < 0) {
+                perror("fork");
+                exit(1);
+            }
+            if (pid == 0) {
+                worker_loop(c, slices, i, n);
+                _exit(0);
+            }
+            pids.push_back(pid);
+        }
+        wait_counter(&c->ready);
+        startup_us = (now_sec() - t0) * 1e6;
+    }
+
+    ~Pool() {
+        c->quit = 1;
+        c->job_seq.fetch_add(1, std::memory_order_release);
+        futex_wake(&c->job_seq, INT_MAX);
+        for (auto& t : threads)
+            t.join();
+        for (pid_t pid : pids)
+            waitpid(pid, nullptr, 0);
+    }
+
+    long reduce(int kernel, char op) {
+        c->kernel = kernel;
+        c->op = op;
+        c->done.store(0, std::memory_order_relaxed);
+        c->job_seq.fetch_add(1, std::memory_order_release);
+        futex_wake(&c->job_seq, INT_MAX);
+        wait_counter(&c->done);
+
+        long sum = 0;
+        for (int i = 0; i < n; i++)
+            sum += c->slots[i].value;
+        return sum;
+    }
+};
+
+int main(int argc, char** argv) {
+    size_t mb = argc > 1 ? strtoul(argv[1], nullptr, 10) : 256;
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    int max_workers = argc > 2 ? atoi(argv[2]) : (int)ncpu;
+    max_workers = std::clamp(max_workers, 1, MAX_WORKERS);
+    size_t total = mb * (1 << 20) / sizeof(long);
+
+    ShmResource shm(sizeof(Control) + mb * (1 << 20) + MAX_WORKERS * 64 +
+                    (1 << 20));
+    void* cmem = shm.allocate(sizeof(Control), alignof(Control));
+    Control* c = new (cmem) Control{};
+
+    printf("%zu MB of long, %ld CPUs, %d rounds per kernel\n\n", mb, ncpu,
+           ROUNDS);
+    printf("%7s %-8s %10s %10s %10s %8s\n", "workers", "mode", "startup",
+           "kernel", "ms/reduce", "GB/s");
+
+    size_t data_start = shm.mark();
+    for (int n = 1;; n = std::min(n * 2, max_workers)) {
+        // 每个工作者一个切片 Vector, 数据都在共享内存里
+        shm.rewind(data_start);
+        std::vector<Vector<long>> slices;
+        size_t base = 0;
+        for (int i = 0; i < n; i++) {
+            size_t len = total / n + ((size_t)i < total % n ? 1 : 0);
+            slices.emplace_back(len, no_init, &shm);
+            for (size_t j = 0; j < len; j++)
+                slices.back()[j] = (long)((base + j) % 1000);
+            base += len;
+        }
+
+        long expect[std::size(kernels)];
+        for (size_t k = 0; k < std::size(kernels); k++) {
+            expect[k] = 0;
+            for (auto& s : slices) {
+                long r;
+                kernels[k].first(s, r, '+');
+                expect[k] += r;
+            }
+        }
+
+        for (bool processes : {true, false}) {
+            Pool pool(c, slices, n, processes);
+            for (size_t k = 0; k < std::size(kernels); k++) {
+                bool ok = true;
+                double t0 = now_sec();
+                for (int r = 0; r < ROUNDS; r++)
+                    ok &= pool.reduce((int)k, '+') == expect[k];
+                double per = (now_sec() - t0) / ROUNDS;
+                printf("%7d %-8s %8.0fus %10s %10.2f %8.2f%s\n", n,
+                       processes ? "process" : "thread", pool.startup_us,
+                       kernels[k].second, per * 1e3,
+                       total * sizeof(long) / per / 1e9,
+                       ok ? "" : "  WRONG");
+            }
+        }
+
+        if (n == max_workers)
+            break;
+    }
+    return 0;
+}
@@ -0,0 +1,152 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <cerrno>
+#include <poll.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <system_error>
+#include <time.h>
+#include <unistd.h>
+
+// 用 fork 给整个进程拍一张写时复制快照 (8.4 进程控制, 9.7 fork 的写时复制)
+//
+// 构造时 fork, 子进程看到的是 fork 那一刻冻结的地址空间, 在里面运行
+// body(fd) 做归约/序列化/落盘, 结果写进 fd (一条管道), 返回值作为退出码。
+// 父进程不做任何拷贝立刻返回继续修改数据, 只在第一次写某一页时
+// 缺页并复制这一页, 这部分开销记在 parent_faults 里。
+//
+// 注意: 子进程里只有调用 fork 的线程, 多线程程序的 body 不能碰
+// 其他线程可能持有的锁 (包括 malloc 的锁)。
+class Snapshot {
+public:
+    struct Stats {
+        double fork_ms;     // fork 本身的耗时 (复制页表)
+        double live_sec;    // 快照从创建到子进程退出的时间
+        long parent_faults; // 快照存活期间父进程的次缺页数, 大多是 COW
+    };
+
+private:
+    pid_t child = -1;
+    int fd = -1; // 结果管道的读端
+    std::string result;
+    int exit_code = -1;
+    long minflt_start = 0;
+    double t_start = 0;
+    Stats stats{};
+
+    static double now_sec() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec + ts.tv_nsec * 1e-9;
+    }
+
+    static long minor_faults() {
+        struct rusage ru;
+        getrusage(RUSAGE_SELF, &ru);
+        return ru.ru_minflt;
+    }
+
+    // 读走管道里已有的数据, 防止子进程写满管道后阻塞
+    void drain(bool block) {
+        char buf[1 << 16];
+        while (fd >= 0) {
+            if (!block) {
+                struct pollfd p = {fd, POLLIN, 0};
+                if (poll(&p, 1, 0) <= 0)
+                    return;
+            }
+            ssize_t n = read(fd, buf, sizeof(buf));
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0) {
+                close(fd);
+                fd = -1;
+                return;
+            }
+            result.append(buf, n);
+        }
+    }
+
+    void finish(int status) {
+        child = -1;
+        stats.live_sec = now_sec() - t_start;
+        stats.parent_faults = minor_faults() - minflt_start;
+        exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    }
+
+public:
+    template <typename F>
+    explicit Snapshot(F&& body) {
+        int p[2];
+        if (pipe(p) < 0)
+            throw std::system_error(errno, std::generic_category(), "pipe");
+
+        t_start = now_sec();
+        pid_t pid = fork();
+        if (pid < 0) {
+            int err = errno;
+            close(p[0]);
+            close(p[1]);
+            throw std::system_error(err, std::generic_category(), "fork");
+        }
+        if (pid == 0) {
+            close(p[0]);
+            int code;
+            try {
+                code = body(p[1]);
+            } catch (...) {
+                code = 1;
+            }
+            close(p[1]);
+            _exit(code); // 不跑父进程注册的 atexit 和析构
+        }
+
+        stats.fork_ms = (now_sec() - t_start) * 1e3;
+        minflt_start = minor_faults();
+        child = pid;
+        close(p[1]);
+        fd = p[0];
+    }
+
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+
+    ~Snapshot() {
+        if (child > 0)
+            wait();
+    }
+
+    // 子进程还在运行吗 (不阻塞)
+    bool running() {
+        if (child <= 0)
+            return false;
+        drain(false);
+        int status;
+        if (waitpid(child, &status, WNOHANG) == 0)
+            return true;
+        drain(true);
+        finish(status);
+        return false;
+    }
+
+    // 等子进程结束, 返回它的退出码 (被信号杀死返回 -1)
+    int wait() {
+        if (child > 0) {
+            drain(true);
+            int status;
+            while (waitpid(child, &status, 0) < 0 && errno == EINTR)
+                ;
+            finish(status);
+        }
+        return exit_code;
+    }
+
+    // 子进程写进管道的全部内容, wait() 之后才完整
+    const std::string& output() const { return result; }
+
+    const Stats& get_stats() const { return stats; }
+};
+
+#endif
@@ -0,0 +1,157 @@
+#define _GNU_SOURCE
+#include "spawn.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define CLONE_STACK_SIZE (64 << 10)
+
+typedef struct {
+    const char* path;
+    char* const* argv;
+    char* const* envp;
+    volatile int err; /* 子进程 exec 失败时写入, 与父进程共享 */
+} exec_args;
+
+const char* spawn_method_name(spawn_method method) {
+    static const char* names[SPAWN_NUM_METHODS] = {"fork", "vfork", "clone",
+                                                   "posix_spawn"};
+    return names[method];
+}
+
+/* exec 失败后子进程已退出, 回收它并把错误交给调用者 */
+static pid_t reap_failed(pid_t pid, int err) {
+    waitpid(pid, NULL, 0);
+    errno = err;
+    return -1;
+}
+
+/* fork: 子进程有独立的地址空间, 用 CLOEXEC 管道传回 exec 的错误 */
+static pid_t spawn_fork(exec_args* a) {
+    int p[2];
+    if (pipe2(p, O_CLOEXEC) < 0)
+        return -1;
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(p[0]);
+        execve(a->path, a->argv, a->envp);
+        int err = errno;
+        ssize_t w = write(p[1], &err, sizeof(err));
+        (void)w;
+        _exit(127);
+    }
+    close(p[1]);
+    if (pid < 0) {
+        close(p[0]);
+        return -1;
+    }
+
+    /* exec 成功时管道随之关闭, 读到 EOF */
+    int err;
+    ssize_t n;
+    while ((n = read(p[0], &err, sizeof(err))) < 0 && errno == EINTR)
+        ;
+    close(p[0]);
+    return n == sizeof(err) ? reap_failed(pid, err) : pid;
+}
+
+/* vfork: 父进程挂起到子进程 exec 或退出, 子进程直接写共享的 err */
+static pid_t spawn_vfork(exec_args* a) {
+    a->err = 0;
+    pid_t pid = vfork();
+    if (pid == 0) {
+        execve(a->path, a->argv, a->envp);
+        a->err = errno;
+        _exit(127);
+    }
+    if (pid < 0)
+        return -1;
+    return a->err ? reap_failed(pid, a->err) : pid;
+}
+
+static int clone_child(void* arg) {
+    exec_args* a = arg;
+    execve(a->path, a->argv, a->envp);
+    a->err = errno;
+    return 127;
+}
+
+/*
+ * clone(CLONE_VM | CLONE_VFORK): 和 vfork 一样, 但子进程用单独的栈。
+ * CLONE_VFORK 只挂起调用线程, 别的线程可能同时在 spawn, 所以栈是每个
+ * 线程一个 (_Thread_local), 第一次用时 mmap, 之后复用: 子进程 exec
+ * 之前调用线程不会再进来, 同一线程的栈不会被两个子进程同时使用。
+ * 每次调用都 mmap/munmap 也正确, 但会把两次系统调用算进 spawn 的开销。
+ * 线程退出时这 64KB 不回收。
+ */
+static pid_t spawn_clone(exec_args* a) {
+    static _Thread_local char* stack;
+    if (!stack) {
+        stack = mmap(NULL, CLONE_STACK_SIZE, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+        if (stack == MAP_FAILED) {
+            stack = NULL;
+            return -1;
+        }
+    }
+
+    a->err = 0;
+    pid_t pid = clone(clone_child, stack + CLONE_STACK_SIZE,
+                      CLONE_VM | CLONE_VFORK | SIGCHLD, a);
+    if (pid < 0)
+        return -1;
+    return a->err ? reap_failed(pid, a->err) : pid;
+}
+
+static pid_t spawn_posix(exec_args* a) {
+    pid_t pid;
+    int err = posix_spawn(&pid, a->path, NULL, NULL, a->argv, a->envp);
+    if (err) {
+        errno = err;
+        return -1;
+    }
+    return pid;
+}
+
+pid_t spawn_exec(spawn_method method, const char* path, char* const argv[],
+                 char* const envp[]) {
+    exec_args a = {path, argv, envp, 0};
+    switch (method) {
+    case SPAWN_FORK:
+        return spawn_fork(&a);
+    case SPAWN_VFORK:
+        return spawn_vfork(&a);
+    case SPAWN_CLONE:
+        return spawn_clone(&a);
+    case SPAWN_POSIX:
+        return spawn_posix(&a);
+    default:
+        errno = EINVAL;
+        return -1;
+    }
+}
+
+int spawn_wait(pid_t pid) {
+    int status;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR)
+            return -1;
+    }
+    return status;
+}
+
+void spawn_report(int status) {
+    if (status != -1 && WIFEXITED(status))
+        printf("Child exited with code %d\n", WEXITSTATUS(status));
+    else
+        printf("Child did not exit normally.\n");
+}
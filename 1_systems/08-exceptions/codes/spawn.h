@@ -0,0 +1,37 @@
+#ifndef SPAWN_H
+#define SPAWN_H
+
+#include <sys/types.h>
+
+/*
+ * 启动子进程并 exec, 不同的创建方式 (8.4 进程控制)
+ *
+ * fork 复制整张页表, 父进程 RSS 越大越慢; vfork 和
+ * clone(CLONE_VM | CLONE_VFORK) 让子进程借用父进程的地址空间直到 exec,
+ * 开销与 RSS 无关; posix_spawn 是 libc 对后者的封装。
+ */
+
+typedef enum {
+    SPAWN_FORK,
+    SPAWN_VFORK,
+    SPAWN_CLONE,
+    SPAWN_POSIX,
+    SPAWN_NUM_METHODS
+} spawn_method;
+
+const char* spawn_method_name(spawn_method method);
+
+/*
+ * 用 method 创建子进程执行 path, 返回子进程 pid。
+ * exec 失败也能在父进程里看到: 返回 -1 并设置 errno, 子进程已被回收
+ */
+pid_t spawn_exec(spawn_method method, const char* path, char* const argv[],
+                 char* const envp[]);
+
+/* 等待 pid 结束, 返回 waitpid 的 status, 出错返回 -1 */
+int spawn_wait(pid_t pid);
+
+/* 和 process_control_demo 一样打印退出状态 */
+void spawn_report(int status);
+
+#endif
@@ -0,0 +1,94 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "spawn.h"
+
+/*
+ * 子进程启动延迟 vs 父进程 RSS: 每种方式反复启动 /bin/true,
+ * 测从开始创建到回收子进程的平均时间
+ *
+ * 编译: gcc -O2 spawn.c spawn_bench.c -o spawn_bench
+ * 运行: ./spawn_bench [max_rss_MB] > spawn.dat
+ * 作图: gnuplot -e "set logscale x; plot for [i=2:5] 'spawn.dat' u 1:i w lp t columnhead"
+ */
+
+#define REPS 50
+
+extern char** environ;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double bench(spawn_method m, char* const argv[]) {
+    double best = 1e9;
+    /* 取最小值, 代表没有被其他进程打断时的开销 */
+    for (int r = 0; r < REPS; r++) {
+        double t0 = now_sec();
+        pid_t pid = spawn_exec(m, argv[0], argv, environ);
+        if (pid < 0) {
+            perror(spawn_method_name(m));
+            exit(1);
+        }
+        int status = spawn_wait(pid);
+        double t = now_sec() - t0;
+        if (status != 0) {
+            spawn_report(status);
+            exit(1);
+        }
+        if (t < best)
+            best = t;
+    }
+    return best * 1e6;
+}
+
+int main(int argc, char** argv) {
+    size_t max_mb = argc > 1 ? strtoul(argv[1], NULL, 10) : 2048;
+    char* child_argv[] = {"/bin/true", NULL};
+
+    /* 先确认 exec 失败能被报告出来 */
+    char* bad_argv[] = {"/nonexistent", NULL};
+    for (int m = 0; m < SPAWN_NUM_METHODS; m++) {
+        if (spawn_exec(m, bad_argv[0], bad_argv, environ) >= 0) {
+            fprintf(stderr, "%s: exec failure not reported\n",
+                    spawn_method_name(m));
+            return 1;
+        }
+    }
+
+    printf("%-8s", "rss_MB");
+    for (int m = 0; m < SPAWN_NUM_METHODS; m++)
+        printf(" %12s", spawn_method_name(m));
+    printf("   (us per spawn+exec+wait, min of %d)\n", REPS);
+
+    /* 父进程的 RSS 分段增长, 每段都写满, 确保页表已经建立 */
+    char* heap = NULL;
+    size_t rss = 0;
+    for (size_t mb = 0; mb <= max_mb; mb = mb ? mb * 2 : 64) {
+        if (mb > rss) {
+            heap = mmap(NULL, (mb - rss) << 20, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (heap == MAP_FAILED) {
+                perror("mmap");
+                return 1;
+            }
+            /* 关掉大页, 模拟一般堆的 4KB 页表 */
+            madvise(heap, (mb - rss) << 20, MADV_NOHUGEPAGE);
+            memset(heap, 1, (mb - rss) << 20);
+            rss = mb;
+        }
+
+        printf("%-8zu", mb);
+        for (int m = 0; m < SPAWN_NUM_METHODS; m++)
+            printf(" %12.1f", bench(m, child_argv));
+        printf("\n");
+        fflush(stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,204 @@
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include <x86intrin.h>
+
+/*
+ * 随机指针追逐 (pointer chasing) 延迟测试
+ *
+ * 每次 load 的地址都来自上一次 load 的结果, CPU 无法并行或预取,
+ * 测到的就是单次访存的真实延迟。随着工作集增大, 依次可以看到
+ * L1 / L2 / LLC / DRAM 以及 dTLB / STLB 未命中带来的台阶。
+ *
+ * 编译: gcc -O2 chase.c -o chase
+ * 用法: ./chase [最大工作集 MB]
+ */
+
+#define LINE 64
+#define SMALL_PAGE 4096UL
+#define HUGE_PAGE (2UL << 20)
+
+typedef enum { PAGE_4K, PAGE_THP, PAGE_HUGETLB } page_mode;
+static const char* mode_names[] = {"4KB", "THP", "hugetlb"};
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// 用 TSC 和单调时钟对比, 估算 TSC 频率 (GHz)
+static double tsc_ghz(void) {
+    double t0 = now_sec();
+    uint64_t c0 = __rdtsc();
+    while (now_sec() - t0 < 0.1)
+        ;
+    uint64_t c1 = __rdtsc();
+    return (c1 - c0) / (now_sec() - t0) / 1e9;
+}
+
+// xorshift 伪随机数, 保证每次运行的链表一致
+static uint64_t rng_state = 88172645463325252ULL;
+static uint64_t next_rand(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+// 按页面模式映射内存, 失败返回 NULL
+static void* map_pages(size_t bytes, page_mode mode) {
+    void* p;
+    if (mode == PAGE_HUGETLB) {
+        p = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        return p == MAP_FAILED ? NULL : p;
+    }
+
+    // 多映射一个大页, 把起点对齐到 2MB, THP 才能整页生效
+    size_t len = bytes + HUGE_PAGE;
+    char* raw = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+        return NULL;
+    char* aligned =
+        (char*)(((uintptr_t)raw + HUGE_PAGE - 1) & ~(HUGE_PAGE - 1));
+    if (aligned > raw)
+        munmap(raw, aligned - raw);
+    munmap(aligned + bytes, raw + len - (aligned + bytes));
+
+    madvise(aligned, bytes, mode == PAGE_THP ? MADV_HUGEPAGE
+                                             : MADV_NOHUGEPAGE);
+    return aligned;
+}
+
+/*
+ * 在 buf 中构造一个随机单环: 每 stride 字节放一个节点,
+ * 节点里存下一个节点的地址。Sattolo 算法保证所有节点在同一个环上。
+ */
+static void** build_chain(char* buf, size_t bytes, size_t stride) {
+    size_t n = bytes / stride;
+    size_t* order = malloc(n * sizeof(size_t));
+    if (!order)
+        return NULL;
+    for (size_t i = 0; i < n; i++)
+        order[i] = i;
+    for (size_t i = n - 1; i > 0; i--) {
+        size_t j = next_rand() % i;
+        size_t tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+
+    // 页内偏移也随机到某一行, 避免所有节点落在同一个 cache set
+    size_t lines = stride / LINE;
+    for (size_t i = 0; i < n; i++) {
+        size_t from = order[i], to = order[(i + 1) % n];
+        size_t off_from = (lines > 1) ? (from * 7 % lines) * LINE : 0;
+        size_t off_to = (lines > 1) ? (to * 7 % lines) * LINE : 0;
+        *(void**)(buf + from * stride + off_from) =
+            buf + to * stride + off_to;
+    }
+    void** start = (void**)(buf + order[0] * stride +
+                            ((lines > 1) ? (order[0] * 7 % lines) * LINE : 0));
+    free(order);
+    return start;
+}
+
+// 追逐 count 次, 返回最终指针防止被优化掉
+static void** chase(void** p, long count) {
+    while (count >= 8) {
+        p = (void**)*p;
+        p = (void**)*p;
+        p = (void**)*p;
+        p = (void**)*p;
+        p = (void**)*p;
+        p = (void**)*p;
+        p = (void**)*p;
+        p = (void**)*p;
+        count -= 8;
+    }
+    while (count--)
+        p = (void**)*p;
+    return p;
+}
+
+// 测一个工作集, 返回每次 load 的纳秒数
+static double measure(char* buf, size_t bytes, size_t stride) {
+    void** start = build_chain(buf, bytes, stride);
+    if (!start)
+        return -1;
+
+    long nodes = bytes / stride;
+    long loads = nodes * 4 < (1L << 22) ? (1L << 22) : nodes * 4;
+
+    // 预热: 走一圈, 填充 cache 和 TLB
+    void** p = chase(start, nodes);
+
+    double best = 1e30;
+    for (int rep = 0; rep < 3; rep++) {
+        double t0 = now_sec();
+        p = chase(p, loads);
+        double t = (now_sec() - t0) / loads;
+        if (t < best)
+            best = t;
+    }
+    if (p == NULL)
+        printf("unreachable\n");
+    return best * 1e9;
+}
+
+static void run_mode(page_mode mode, size_t max_bytes, double ghz) {
+    char* buf = map_pages(max_bytes, mode);
+    if (!buf) {
+        printf("\n[%s] 映射失败, 跳过", mode_names[mode]);
+        if (mode == PAGE_HUGETLB)
+            printf(" (需要先设置 /proc/sys/vm/nr_hugepages)");
+        printf("\n");
+        return;
+    }
+    memset(buf, 1, max_bytes); // 预先触发缺页
+
+    printf("\n[%s]\n%10s %12s %12s %12s %12s\n", mode_names[mode], "size",
+           "line ns", "line cyc", "page ns", "page cyc");
+
+    // 工作集按 2 的幂增长, 中间再插入一个 1.5 倍的采样点
+    for (size_t bytes = 4096; bytes <= max_bytes;) {
+        double line_ns = measure(buf, bytes, LINE);
+        // 每页只访问一行: cache 占用很小, 主要体现 TLB 覆盖范围
+        double page_ns = bytes >= 16 * SMALL_PAGE
+                             ? measure(buf, bytes, SMALL_PAGE)
+                             : 0;
+        if (bytes % (1 << 20) == 0)
+            printf("%8zuMB", bytes >> 20);
+        else
+            printf("%8zuKB", bytes >> 10);
+        printf(" %12.2f %12.1f", line_ns, line_ns * ghz);
+        if (page_ns > 0)
+            printf(" %12.2f %12.1f\n", page_ns, page_ns * ghz);
+        else
+            printf(" %12s %12s\n", "-", "-");
+
+        bytes = (bytes & (bytes - 1)) ? bytes / 3 * 4 : bytes + bytes / 2;
+    }
+    munmap(buf, max_bytes);
+}
+
+int main(int argc, char* argv[]) {
+    size_t max_mb = argc > 1 ? strtoul(argv[1], NULL, 10) : 512;
+    size_t max_bytes = (max_mb << 20);
+    max_bytes = (max_bytes + HUGE_PAGE - 1) & ~(HUGE_PAGE - 1);
+
+    double ghz = tsc_ghz();
+    printf("TSC: %.2f GHz (cycles 按 TSC 频率换算)\n", ghz);
+
+    run_mode(PAGE_4K, max_bytes, ghz);
+    run_mode(PAGE_THP, max_bytes, ghz);
+    run_mode(PAGE_HUGETLB, max_bytes, ghz);
+    return 0;
+}
@@ -0,0 +1,583 @@
+#define _GNU_SOURCE
+#include "gc.h"
+
+#include <pthread.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+
+/*
+ * 堆布局: 所有对象都放在 64KB 对齐的块 (block) 里。
+ * 小对象按大小类分块, 块头部之后是每个对象的颜色数组, 然后是对象本身;
+ * 大对象独占一段对齐的映射, 可能跨越多个 64KB 段。
+ * 段地址 -> 块头部的哈希表用来把任意 (内部) 指针定位到对象。
+ */
+
+#define BLOCK_SIZE (64UL << 10)
+#define BLOCK_MASK (~(uintptr_t)(BLOCK_SIZE - 1))
+#define NUM_CLASSES 14
+#define LARGE_MIN 2049
+#define CHECK_EVERY 32 /* 每处理这么多对象看一次时钟 */
+#define MAX_RESCANS 8  /* 标记终止时重扫根的次数上限 */
+
+/* 对象颜色, FREE 表示这个槽位没有分配 */
+enum { FREE = 0, WHITE, GRAY, BLACK };
+
+typedef enum { IDLE, MARK, SWEEP } gc_phase;
+
+static const size_t class_sizes[NUM_CLASSES] = {
+    16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048};
+
+typedef struct block {
+    struct block* next;       /* 所有块 */
+    struct block* next_class; /* 同一大小类的块 */
+    size_t objsize;
+    size_t nobjs;
+    size_t maplen; /* 映射总长度 */
+    int cls;       /* 大小类, -1 为大对象 */
+    unsigned swept_epoch;
+    char* data;
+    uint8_t color[];
+} block;
+
+typedef struct {
+    char* start;
+    size_t len;
+} root;
+
+static gc_config cfg;
+static gc_stats stats;
+static gc_phase phase = IDLE;
+static unsigned epoch = 1;
+
+static block* blocks;
+static block* class_blocks[NUM_CLASSES];
+static block* class_sweep[NUM_CLASSES]; /* 按需清除的游标 */
+static block** sweep_link;              /* 后台清除的游标 */
+static void* free_lists[NUM_CLASSES];
+
+static uintptr_t heap_min = UINTPTR_MAX, heap_max;
+
+/* 段地址 -> 块, 线性探测, 后移删除 */
+static block** seg_table;
+static uintptr_t* seg_keys;
+static size_t seg_cap, seg_count;
+
+static void** gray;
+static size_t gray_len, gray_cap;
+
+static root* roots;
+static size_t num_roots, roots_cap;
+
+static char* stack_top;
+static size_t bytes_since_cycle, step_debt;
+static int rescans;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* ---------------- 段表 ---------------- */
+
+static inline size_t seg_hash(uintptr_t key) {
+    return (size_t)((key >> 16) * 0x9E3779B97F4A7C15ULL) & (seg_cap - 1);
+}
+
+static void seg_put(uintptr_t key, block* b);
+
+static void seg_grow(void) {
+    size_t old_cap = seg_cap;
+    uintptr_t* old_keys = seg_keys;
+    block** old_table = seg_table;
+
+    seg_cap = old_cap ? old_cap * 2 : 1024;
+    seg_keys = calloc(seg_cap, sizeof(uintptr_t));
+    seg_table = calloc(seg_cap, sizeof(block*));
+    seg_count = 0;
+    for (size_t i = 0; i < old_cap; i++) {
+        if (old_keys[i])
+            seg_put(old_keys[i], old_table[i]);
+    }
+    free(old_keys);
+    free(old_table);
+}
+
+static void seg_put(uintptr_t key, block* b) {
+    if ((seg_count + 1) * 2 > seg_cap)
+        seg_grow();
+    size_t i = seg_hash(key);
+    while (seg_keys[i])
+        i = (i + 1) & (seg_cap - 1);
+    seg_keys[i] = key;
+    seg_table[i] = b;
+    seg_count++;
+}
+
+static block* seg_get(uintptr_t key) {
+    if (!seg_cap)
+        return NULL;
+    for (size_t i = seg_hash(key); seg_keys[i]; i = (i + 1) & (seg_cap - 1)) {
+        if (seg_keys[i] == key)
+            return seg_table[i];
+    }
+    return NULL;
+}
+
+static void seg_del(uintptr_t key) {
+    size_t i = seg_hash(key);
+    while (seg_keys[i] && seg_keys[i] != key)
+        i = (i + 1) & (seg_cap - 1);
+    if (!seg_keys[i])
+        return;
+
+    size_t hole = i;
+    for (size_t j = (i + 1) & (seg_cap - 1); seg_keys[j];
+         j = (j + 1) & (seg_cap - 1)) {
+        size_t home = seg_hash(seg_keys[j]);
+        if (((j - home) & (seg_cap - 1)) >= ((j - hole) & (seg_cap - 1))) {
+            seg_keys[hole] = seg_keys[j];
+            seg_table[hole] = seg_table[j];
+            hole = j;
+        }
+    }
+    seg_keys[hole] = 0;
+    seg_count--;
+}
+
+/* ---------------- 块管理 ---------------- */
+
+/* 映射 len 字节, 起点按 BLOCK_SIZE 对齐 */
+static void* map_aligned(size_t len) {
+    char* raw = mmap(NULL, len + BLOCK_SIZE, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+        return NULL;
+    char* p = (char*)(((uintptr_t)raw + BLOCK_SIZE - 1) & BLOCK_MASK);
+    if (p > raw)
+        munmap(raw, p - raw);
+    munmap(p + len, raw + len + BLOCK_SIZE - (p + len));
+    return p;
+}
+
+/*
+ * 标记期间新建的块算作"未清除", 这样本周期的清除会把其中分配成
+ * 黑色的对象重新染白; 清除或空闲期间新建的块算作已清除
+ */
+static unsigned new_block_epoch(void) {
+    return phase == MARK ? epoch - 1 : epoch;
+}
+
+static void register_block(block* b) {
+    for (size_t off = 0; off < b->maplen; off += BLOCK_SIZE)
+        seg_put((uintptr_t)b + off, b);
+    b->next = blocks;
+    blocks = b;
+    if ((uintptr_t)b < heap_min)
+        heap_min = (uintptr_t)b;
+    if ((uintptr_t)b + b->maplen > heap_max)
+        heap_max = (uintptr_t)b + b->maplen;
+}
+
+static block* new_small_block(int cls) {
+    block* b = map_aligned(BLOCK_SIZE);
+    if (!b)
+        return NULL;
+    size_t objsize = class_sizes[cls];
+    size_t n = (BLOCK_SIZE - sizeof(block)) / (objsize + 1);
+    uintptr_t data = (uintptr_t)b + sizeof(block) + n;
+    data = (data + 15) & ~(uintptr_t)15;
+    while (data + n * objsize > (uintptr_t)b + BLOCK_SIZE)
+        n--;
+
+    b->objsize = objsize;
+    b->nobjs = n;
+    b->maplen = BLOCK_SIZE;
+    b->cls = cls;
+    b->swept_epoch = new_block_epoch();
+    b->data = (char*)data;
+    /* 新映射的内存全是零: 颜色都是 FREE, 对象内容也已清零 */
+
+    /* 倒序入链, 分配时按地址递增取出 */
+    for (size_t i = n; i-- > 0;) {
+        void* obj = b->data + i * objsize;
+        *(void**)obj = free_lists[cls];
+        free_lists[cls] = obj;
+    }
+    b->next_class = class_blocks[cls];
+    class_blocks[cls] = b;
+    register_block(b);
+    return b;
+}
+
+static void unregister_block(block* b) {
+    for (size_t off = 0; off < b->maplen; off += BLOCK_SIZE)
+        seg_del((uintptr_t)b + off);
+}
+
+/* 把任意指针定位到对象, 不是堆对象返回 NULL */
+static inline void* find_object(uintptr_t p, block** out, size_t* idx) {
+    if (p < heap_min || p >= heap_max)
+        return NULL;
+    block* b = seg_get(p & BLOCK_MASK);
+    if (!b || p < (uintptr_t)b->data)
+        return NULL;
+    size_t i = (p - (uintptr_t)b->data) / b->objsize;
+    if (i >= b->nobjs || b->color[i] == FREE)
+        return NULL;
+    *out = b;
+    *idx = i;
+    return b->data + i * b->objsize;
+}
+
+/* ---------------- 标记 ---------------- */
+
+static void gray_push(void* obj) {
+    if (gray_len == gray_cap) {
+        gray_cap = gray_cap ? gray_cap * 2 : 4096;
+        gray = realloc(gray, gray_cap * sizeof(void*));
+    }
+    gray[gray_len++] = obj;
+}
+
+/* 白色对象染灰, 放入待扫描栈 */
+static inline void shade(uintptr_t p) {
+    block* b;
+    size_t i;
+    void* obj = find_object(p, &b, &i);
+    if (obj && b->color[i] == WHITE) {
+        b->color[i] = GRAY;
+        gray_push(obj);
+    }
+}
+
+static void scan_range(char* start, char* end) {
+    uintptr_t* p = (uintptr_t*)(((uintptr_t)start + 7) & ~(uintptr_t)7);
+    for (; (char*)(p + 1) <= end; p++)
+        shade(*p);
+}
+
+/* setjmp 把被调用者保存的寄存器存到栈上, 再从当前位置扫到栈底 */
+__attribute__((noinline)) static void scan_stack(void) {
+    jmp_buf regs;
+    setjmp(regs);
+    char* here = (char*)&regs;
+    char* frame = __builtin_frame_address(0);
+    scan_range(here < frame ? here : frame, stack_top);
+}
+
+static void scan_roots(void) {
+    for (size_t r = 0; r < num_roots; r++)
+        scan_range(roots[r].start, roots[r].start + roots[r].len);
+    scan_stack();
+}
+
+/* 扫描一个灰色对象, 把它染黑 */
+static void blacken(void* obj) {
+    block* b;
+    size_t i;
+    if (!find_object((uintptr_t)obj, &b, &i))
+        return;
+    b->color[i] = BLACK;
+    stats.bytes_marked += b->objsize;
+    scan_range(obj, (char*)obj + b->objsize);
+}
+
+static void start_cycle(void) {
+    epoch++;
+    phase = MARK;
+    rescans = 0;
+    bytes_since_cycle = 0;
+    step_debt = 0;
+    for (int c = 0; c < NUM_CLASSES; c++)
+        class_sweep[c] = class_blocks[c];
+    scan_roots();
+}
+
+/* 增量标记, 返回 1 表示标记完成 */
+static int mark_step(double deadline) {
+    for (;;) {
+        size_t n = 0;
+        while (gray_len > 0) {
+            blacken(gray[--gray_len]);
+            if (++n % CHECK_EVERY == 0 && deadline && now_sec() > deadline)
+                return 0;
+        }
+        /*
+         * 灰色栈空了: 根 (栈和全局变量) 没有写屏障, 需要重扫一遍。
+         * 没有新的灰色对象时标记结束; 重扫次数过多就不再看时间
+         */
+        scan_roots();
+        if (gray_len == 0)
+            return 1;
+        if (++rescans >= MAX_RESCANS)
+            deadline = 0;
+        else if (deadline && now_sec() > deadline)
+            return 0;
+    }
+}
+
+/* ---------------- 清除 ---------------- */
+
+static void sweep_small(block* b) {
+    for (size_t i = 0; i < b->nobjs; i++) {
+        if (b->color[i] == WHITE) {
+            void* obj = b->data + i * b->objsize;
+            b->color[i] = FREE;
+            *(void**)obj = free_lists[b->cls];
+            free_lists[b->cls] = obj;
+            stats.heap_bytes -= b->objsize;
+            stats.bytes_freed += b->objsize;
+        } else if (b->color[i] == BLACK) {
+            b->color[i] = WHITE;
+        }
+    }
+    b->swept_epoch = epoch;
+}
+
+/* 清除 *link 指向的块, 大对象被回收时从链表中摘除 */
+static void sweep_block(block** link) {
+    block* b = *link;
+    if (b->cls >= 0) {
+        sweep_small(b);
+        return;
+    }
+    if (b->color[0] == WHITE) {
+        *link = b->next;
+        stats.heap_bytes -= b->objsize;
+        stats.bytes_freed += b->objsize;
+        unregister_block(b);
+        munmap(b, b->maplen);
+        return;
+    }
+    b->color[0] = WHITE;
+    b->swept_epoch = epoch;
+}
+
+/* 惰性清除, 返回 1 表示本周期清除完成 */
+static int sweep_step(double deadline) {
+    while (*sweep_link) {
+        block* b = *sweep_link;
+        if (b->swept_epoch != epoch) {
+            sweep_block(sweep_link);
+            if (*sweep_link != b) /* 大对象被回收, 游标不动 */
+                continue;
+        }
+        sweep_link = &b->next;
+        if (deadline && now_sec() > deadline)
+            return 0;
+    }
+    return 1;
+}
+
+/* 分配时按需清除本大小类还没清除的块 */
+static void sweep_class(int cls) {
+    while (class_sweep[cls] && !free_lists[cls]) {
+        block* b = class_sweep[cls];
+        class_sweep[cls] = b->next_class;
+        if (b->swept_epoch != epoch)
+            sweep_small(b);
+    }
+}
+
+/* ---------------- 收集调度 ---------------- */
+
+static void record_pause(double t0) {
+    double us = (now_sec() - t0) * 1e6;
+    static const double bounds[GC_PAUSE_BUCKETS - 1] = {
+        10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000};
+    int k = 0;
+    while (k < GC_PAUSE_BUCKETS - 1 && us >= bounds[k])
+        k++;
+    stats.pause_hist[k]++;
+    stats.pauses++;
+    stats.gc_time_sec += us * 1e-6;
+    if (us > stats.pause_max_us)
+        stats.pause_max_us = us;
+}
+
+/* 推进当前周期, deadline 为 0 表示一直做到周期结束 */
+static void advance(double deadline) {
+    if (phase == MARK && mark_step(deadline)) {
+        phase = SWEEP;
+        sweep_link = &blocks;
+    }
+    if (phase == SWEEP && (!deadline || now_sec() < deadline) &&
+        sweep_step(deadline)) {
+        phase = IDLE;
+        stats.cycles++;
+    }
+}
+
+static void full_collect(void) {
+    if (phase != IDLE)
+        advance(0);
+    start_cycle();
+    advance(0);
+}
+
+/* 每次分配前调用: 决定是否开始新周期或做一步增量工作 */
+static void pace(size_t size) {
+    bytes_since_cycle += size;
+    if (phase == IDLE) {
+        if (bytes_since_cycle < cfg.trigger_bytes)
+            return;
+        double t0 = now_sec();
+        if (cfg.incremental) {
+            start_cycle();
+            advance(t0 + cfg.budget_us * 1e-6);
+        } else {
+            full_collect();
+        }
+        record_pause(t0);
+        return;
+    }
+
+    step_debt += size;
+    if (step_debt < cfg.step_bytes)
+        return;
+    step_debt = 0;
+    double t0 = now_sec();
+    advance(t0 + cfg.budget_us * 1e-6);
+    record_pause(t0);
+}
+
+/* 新对象的颜色: 标记期间是黑色; 清除期间, 所在块还没清除也是黑色 */
+static inline uint8_t alloc_color(block* b) {
+    if (phase == MARK || (phase == SWEEP && b->swept_epoch != epoch))
+        return BLACK;
+    return WHITE;
+}
+
+static void* alloc_large(size_t size) {
+    size_t header = (sizeof(block) + 1 + 15) & ~(size_t)15;
+    size_t maplen = (header + size + BLOCK_SIZE - 1) & BLOCK_MASK;
+    block* b = map_aligned(maplen);
+    if (!b)
+        return NULL;
+    b->objsize = size;
+    b->nobjs = 1;
+    b->maplen = maplen;
+    b->cls = -1;
+    b->swept_epoch = new_block_epoch();
+    b->data = (char*)b + header;
+    b->color[0] = alloc_color(b);
+    register_block(b);
+    stats.heap_bytes += size;
+    return b->data;
+}
+
+/* ---------------- 对外接口 ---------------- */
+
+void gc_init(const gc_config* config) {
+    cfg = *config;
+    memset(&stats, 0, sizeof(stats));
+    if (cfg.trigger_bytes == 0)
+        cfg.trigger_bytes = 8 << 20;
+    if (cfg.step_bytes == 0)
+        cfg.step_bytes = 64 << 10;
+
+    pthread_attr_t attr;
+    void* addr;
+    size_t size;
+    pthread_getattr_np(pthread_self(), &attr);
+    pthread_attr_getstack(&attr, &addr, &size);
+    pthread_attr_destroy(&attr);
+    stack_top = (char*)addr + size;
+}
+
+void gc_shutdown(void) {
+    while (blocks) {
+        block* b = blocks;
+        blocks = b->next;
+        munmap(b, b->maplen);
+    }
+    free(seg_keys);
+    free(seg_table);
+    free(gray);
+    free(roots);
+    seg_keys = NULL;
+    seg_table = NULL;
+    gray = NULL;
+    roots = NULL;
+    seg_cap = seg_count = gray_len = gray_cap = num_roots = roots_cap = 0;
+    memset(class_blocks, 0, sizeof(class_blocks));
+    memset(free_lists, 0, sizeof(free_lists));
+    heap_min = UINTPTR_MAX;
+    heap_max = 0;
+    phase = IDLE;
+}
+
+void* gc_alloc(size_t size) {
+    if (size == 0)
+        size = 1;
+    pace(size);
+
+    if (size >= LARGE_MIN)
+        return alloc_large(size);
+
+    int cls = 0;
+    while (class_sizes[cls] < size)
+        cls++;
+
+    if (!free_lists[cls] && phase == SWEEP)
+        sweep_class(cls);
+    if (!free_lists[cls] && !new_small_block(cls))
+        return NULL;
+
+    void* obj = free_lists[cls];
+    free_lists[cls] = *(void**)obj;
+    block* b = (block*)((uintptr_t)obj & BLOCK_MASK);
+    size_t i = ((char*)obj - b->data) / b->objsize;
+    memset(obj, 0, b->objsize);
+    b->color[i] = alloc_color(b);
+    stats.heap_bytes += b->objsize;
+    return obj;
+}
+
+void gc_add_root(void* start, size_t len) {
+    if (num_roots == roots_cap) {
+        roots_cap = roots_cap ? roots_cap * 2 : 16;
+        roots = realloc(roots, roots_cap * sizeof(root));
+    }
+    roots[num_roots].start = start;
+    roots[num_roots].len = len;
+    num_roots++;
+}
+
+void gc_remove_root(void* start) {
+    for (size_t r = 0; r < num_roots; r++) {
+        if (roots[r].start == start) {
+            roots[r] = roots[--num_roots];
+            return;
+        }
+    }
+}
+
+void gc_write(void** slot, void* value) {
+    *slot = value;
+    /* 插入屏障: 标记期间被写入的白色对象立即染灰 */
+    if (phase == MARK)
+        shade((uintptr_t)value);
+}
+
+void gc_collect(void) {
+    double t0 = now_sec();
+    full_collect();
+    record_pause(t0);
+}
+
+void gc_get_stats(gc_stats* out) {
+    *out = stats;
+}
+
+const char* gc_pause_bucket_label(int bucket) {
+    static const char* labels[GC_PAUSE_BUCKETS] = {
+        "<10us",  "<20us", "<50us", "<100us", "<200us", "<500us",
+        "<1ms",   "<2ms",  "<5ms",  "<10ms",  "<20ms",  ">=20ms"};
+    return labels[bucket];
+}
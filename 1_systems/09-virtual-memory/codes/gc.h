@@ -0,0 +1,56 @@
+#ifndef GC_H
+#define GC_H
+
+#include <stddef.h>
+
+/*
+ * 保守式增量三色标记-清除收集器 (9.10 笔记)
+ *
+ * - 根: gc_add_root 注册的区域 + 调用线程的栈和寄存器, 保守扫描
+ * - 标记: 三色增量标记, 每步的暂停不超过 budget_us
+ * - 写屏障: 标记期间向堆对象写指针必须通过 gc_write (Dijkstra 插入屏障)
+ * - 清除: 惰性清除, 分配时按需清除, 其余分摊到之后的步骤
+ *
+ * 只支持单线程 (嵌入的脚本层只在一个线程里运行)。
+ */
+
+typedef struct {
+    int incremental;         /* 0: 每次都 stop-the-world 完整收集 */
+    double budget_us;        /* 每次增量步骤的时间预算 */
+    size_t trigger_bytes;    /* 自上次收集后分配这么多就开始新周期 */
+    size_t step_bytes;       /* 收集周期内每分配这么多做一步 */
+} gc_config;
+
+#define GC_PAUSE_BUCKETS 12
+
+typedef struct {
+    size_t cycles;             /* 完成的收集周期 */
+    size_t pauses;             /* 暂停次数 */
+    size_t pause_hist[GC_PAUSE_BUCKETS]; /* 见 gc_pause_bucket_label */
+    double pause_max_us;
+    double gc_time_sec;        /* 暂停时间总和 */
+    size_t bytes_marked;       /* 标记 (存活) 的字节数, 累计 */
+    size_t bytes_freed;        /* 回收的字节数, 累计 */
+    size_t heap_bytes;         /* 当前已分配对象的总大小 */
+} gc_stats;
+
+void gc_init(const gc_config* config);
+void gc_shutdown(void);
+
+/* 分配清零的对象, 失败返回 NULL */
+void* gc_alloc(size_t size);
+
+/* 注册/注销一段需要扫描的根区域 (比如全局变量) */
+void gc_add_root(void* start, size_t len);
+void gc_remove_root(void* start);
+
+/* 写屏障: 等价于 *slot = value, slot 位于堆对象内 */
+void gc_write(void** slot, void* value);
+
+/* 立即做一次完整 (stop-the-world) 收集 */
+void gc_collect(void);
+
+void gc_get_stats(gc_stats* stats);
+const char* gc_pause_bucket_label(int bucket);
+
+#endif
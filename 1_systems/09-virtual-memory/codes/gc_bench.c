@@ -0,0 +1,127 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "gc.h"
+
+/*
+ * 收集器基准: 一棵长期存活的大树 + 不断生成的短命小树,
+ * 对比 stop-the-world 和增量收集的暂停分布与吞吐
+ *
+ * 编译: gcc -O2 gc.c gc_bench.c -o gc_bench
+ * 运行: ./gc_bench [budget_us]
+ */
+
+#define LONG_DEPTH 17  /* 长寿树, 约 26 万个节点 */
+#define SHORT_DEPTH 10 /* 每轮的短命树 */
+#define ROUNDS 4000
+#define SWAP_DEPTH 6 /* 每轮替换长寿树中这一层以下的一棵子树 */
+
+typedef struct node {
+    struct node* left;
+    struct node* right;
+    long val;
+} node;
+
+/* 长寿树和临时数组挂在全局变量上, 注册为根 */
+static node* long_tree;
+static node** scratch;
+
+/* 节点值只取决于它在树中的位置, 替换子树后校验和不变 */
+static node* make_tree(int depth, long val) {
+    node* n = gc_alloc(sizeof(node));
+    if (!n) {
+        fprintf(stderr, "gc_alloc failed\n");
+        exit(1);
+    }
+    n->val = val;
+    if (depth > 0) {
+        gc_write((void**)&n->left, make_tree(depth - 1, 2 * val));
+        gc_write((void**)&n->right, make_tree(depth - 1, 2 * val + 1));
+    }
+    return n;
+}
+
+static long checksum(const node* n) {
+    if (!n)
+        return 0;
+    return n->val + checksum(n->left) + checksum(n->right);
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void run(const char* label, int incremental, double budget_us) {
+    gc_config cfg = {incremental, budget_us, 16 << 20, 64 << 10};
+    gc_init(&cfg);
+    gc_add_root(&long_tree, sizeof(long_tree));
+    gc_add_root(&scratch, sizeof(scratch));
+
+    long_tree = make_tree(LONG_DEPTH, 1);
+    long expect = checksum(long_tree);
+    unsigned seed = 12345;
+    long short_sum = 0;
+
+    double t0 = now_sec();
+    for (int r = 0; r < ROUNDS; r++) {
+        node* t = make_tree(SHORT_DEPTH, 1);
+        short_sum += checksum(t);
+
+        /* 一个大对象: 指向短命树最左路径上节点的指针数组 */
+        scratch = gc_alloc(512 * sizeof(node*));
+        node* p = t;
+        for (int i = 0; i < 512 && p; i++, p = p->left)
+            gc_write((void**)&scratch[i], p);
+
+        /* 在长寿树里随机挑一棵子树, 换成新建的等价子树 */
+        node* parent = long_tree;
+        long val = 1;
+        for (int d = 0; d < SWAP_DEPTH - 1; d++) {
+            seed = seed * 1103515245 + 12345;
+            int right = (seed >> 16) & 1;
+            parent = right ? parent->right : parent->left;
+            val = 2 * val + right;
+        }
+        seed = seed * 1103515245 + 12345;
+        int right = (seed >> 16) & 1;
+        node* fresh = make_tree(LONG_DEPTH - SWAP_DEPTH, 2 * val + right);
+        gc_write(right ? (void**)&parent->right : (void**)&parent->left, fresh);
+    }
+    double elapsed = now_sec() - t0;
+
+    long got = checksum(long_tree);
+    long short_expect = (long)ROUNDS * checksum(make_tree(SHORT_DEPTH, 1));
+
+    gc_stats s;
+    gc_get_stats(&s);
+    printf("== %s ==\n", label);
+    printf("time %.3f s, gc %.3f s (%.1f%%), cycles %zu, pauses %zu, "
+           "max pause %.1f us\n",
+           elapsed, s.gc_time_sec, 100 * s.gc_time_sec / elapsed, s.cycles,
+           s.pauses, s.pause_max_us);
+    printf("marked %.1f MB, freed %.1f MB, heap %.1f MB, check %s\n",
+           s.bytes_marked / 1e6, s.bytes_freed / 1e6, s.heap_bytes / 1e6,
+           got == expect && short_sum == short_expect ? "ok" : "FAILED");
+    for (int k = 0; k < GC_PAUSE_BUCKETS; k++) {
+        if (s.pause_hist[k])
+            printf("  %-7s %8zu\n", gc_pause_bucket_label(k), s.pause_hist[k]);
+    }
+    printf("\n");
+
+    long_tree = NULL;
+    scratch = NULL;
+    gc_shutdown();
+}
+
+int main(int argc, char** argv) {
+    double budget = argc > 1 ? atof(argv[1]) : 100;
+    char label[64];
+
+    run("stop-the-world", 0, 0);
+    snprintf(label, sizeof(label), "incremental, budget %.0f us", budget);
+    run(label, 1, budget);
+    return 0;
+}
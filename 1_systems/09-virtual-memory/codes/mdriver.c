@@ -0,0 +1,386 @@
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <malloc.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "mm.h"
+
+/*
+ * 分配器 trace 回放测试
+ *
+ * trace 每行一个请求 (与 mtrace_shim.c 的输出格式相同):
+ *   a <id> <size>   分配
+ *   r <id> <size>   重新分配
+ *   f <id>          释放
+ * 以 # 开头的行是注释
+ *
+ * 对每个分配器报告吞吐量 (ops/s)、峰值利用率 (最大有效载荷 / 最大堆大小)
+ * 以及外部碎片随时间的变化。
+ *
+ * 编译: gcc -O2 mdriver.c mm.c -ldl -o mdriver
+ * 用法: ./mdriver -g 1000000 > synth.rep          生成合成 trace
+ *       ./mdriver [-a first,best,libc,./libsegalloc.so] trace.rep ...
+ */
+
+#define ROWS 10       /* 输出的时间线行数 */
+#define SAMPLES 1000  /* 统计堆峰值的采样次数 */
+
+typedef enum { OP_ALLOC, OP_REALLOC, OP_FREE } op_type;
+
+typedef struct {
+    op_type type;
+    int id;
+    size_t size;
+} trace_op;
+
+typedef struct {
+    trace_op* ops;
+    long num_ops;
+    long cap;
+    int num_ids;
+} trace;
+
+/* 被测分配器的统一接口 */
+typedef struct {
+    const char* name;
+    int (*init)(void);
+    void* (*malloc)(size_t);
+    void (*free)(void*);
+    void* (*realloc)(void*, size_t);
+    size_t (*footprint)(void); /* 当前从系统拿到的字节数 */
+    /* 最大空闲块 / 空闲总量, 不支持时为 NULL */
+    void (*free_stats)(size_t*, size_t*);
+    /* 1: footprint 就是被测分配器的堆大小 (mm 的 mem_heapsize), 直接用;
+       0: 包含进程里别的内存, 减去 init 之前的基线 */
+    int own_heap;
+} allocator;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* 驱动自己的大数组直接 mmap, 不污染被测的 libc 堆 */
+static void* map_array(size_t bytes) {
+    void* p = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return p == MAP_FAILED ? NULL : p;
+}
+
+/* ---------------- 被测分配器 ---------------- */
+
+static int init_first(void) {
+    return mm_init(FIT_FIRST);
+}
+
+static int init_best(void) {
+    return mm_init(FIT_BEST);
+}
+
+static int init_none(void) {
+    return 0;
+}
+
+static size_t libc_footprint(void) {
+    struct mallinfo2 mi = mallinfo2();
+    return mi.arena + mi.hblkhd;
+}
+
+/* 通用分配器只能用常驻内存估算占用 */
+static size_t rss_footprint(void) {
+    long pages = 0, resident = 0;
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (f) {
+        if (fscanf(f, "%ld %ld", &pages, &resident) != 2)
+            resident = 0;
+        fclose(f);
+    }
+    return (size_t)resident * (size_t)sysconf(_SC_PAGESIZE);
+}
+
+/* 从共享库加载另一个分配器, 与 libc 在同一进程中对比 */
+static int load_allocator(const char* path, allocator* a) {
+    void* handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+        fprintf(stderr, "dlopen error: %s\n", dlerror());
+        return -1;
+    }
+    a->name = path;
+    a->init = init_none;
+    a->malloc = (void* (*)(size_t))dlsym(handle, "malloc");
+    a->free = (void (*)(void*))dlsym(handle, "free");
+    a->realloc = (void* (*)(void*, size_t))dlsym(handle, "realloc");
+    a->footprint = rss_footprint;
+    a->free_stats = NULL;
+    a->own_heap = 0;
+    if (!a->malloc || !a->free || !a->realloc) {
+        fprintf(stderr, "%s: missing malloc/free/realloc\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+static int parse_allocator(const char* name, allocator* a) {
+    if (strcmp(name, "first") == 0) {
+        *a = (allocator){"implicit first-fit", init_first, mm_malloc,
+                         mm_free, mm_realloc, mem_heapsize, mm_free_stats, 1};
+    } else if (strcmp(name, "best") == 0) {
+        *a = (allocator){"implicit best-fit", init_best, mm_malloc,
+                         mm_free, mm_realloc, mem_heapsize, mm_free_stats, 1};
+    } else if (strcmp(name, "libc") == 0) {
+        *a = (allocator){"libc", init_none, malloc, free, realloc,
+                         libc_footprint, NULL, 0};
+    } else {
+        return load_allocator(name, a);
+    }
+    return 0;
+}
+
+/* ---------------- trace 读取与生成 ---------------- */
+
+static int read_trace(const char* path, trace* t) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+
+    t->cap = 1 << 16;
+    t->ops = map_array(t->cap * sizeof(trace_op));
+    t->num_ops = 0;
+    t->num_ids = 0;
+
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        char type;
+        int id;
+        size_t size = 0;
+        if (line[0] == '#' || sscanf(line, " %c %d %zu", &type, &id, &size) < 2)
+            continue;
+        if (t->num_ops == t->cap) {
+            t->ops = mremap(t->ops, t->cap * sizeof(trace_op),
+                            2 * t->cap * sizeof(trace_op), MREMAP_MAYMOVE);
+            t->cap *= 2;
+        }
+        trace_op* op = &t->ops[t->num_ops++];
+        op->type = type == 'a' ? OP_ALLOC : (type == 'r' ? OP_REALLOC : OP_FREE);
+        op->id = id;
+        op->size = size;
+        if (id + 1 > t->num_ids)
+            t->num_ids = id + 1;
+    }
+    fclose(f);
+    return 0;
+}
+
+/*
+ * 合成 trace: 大小服从近似幂律分布, 偶尔有大块和 realloc 增长,
+ * 存活对象数在一个区间内波动, 形成分配/释放交替的阶段
+ */
+static void generate_trace(long n) {
+    int max_live = 20000;
+    int* live = malloc(max_live * sizeof(int));
+    size_t* sizes = malloc((n + 1) * sizeof(size_t));
+    int num_live = 0, next_id = 0;
+    unsigned long s = 12345;
+
+    printf("# synthetic trace, %ld ops\n", n);
+    for (long i = 0; i < n; i++) {
+        s = s * 6364136223846793005UL + 1442695040888963407UL;
+        unsigned r = (unsigned)(s >> 33);
+        /* 前半段偏向分配, 后半段偏向释放 */
+        int bias = (i / (n / 8 + 1)) % 2 ? 35 : 65;
+        int want_alloc = (int)(r % 100) < bias;
+
+        if (num_live > 0 && (!want_alloc || num_live == max_live)) {
+            int k = (int)((r >> 8) % num_live);
+            int id = live[k];
+            if ((r >> 20) % 8 == 0) {
+                sizes[id] += sizes[id] / 2 + 1;
+                printf("r %d %zu\n", id, sizes[id]);
+            } else {
+                printf("f %d\n", id);
+                live[k] = live[--num_live];
+            }
+            continue;
+        }
+
+        size_t size;
+        int shift = (int)((r >> 7) % 13);
+        size = ((size_t)1 << shift) + (r >> 12) % ((size_t)1 << shift);
+        if ((r >> 24) % 200 == 0)
+            size = 64 * 1024 + (r % (512 * 1024)); /* 偶尔的大块 */
+        sizes[next_id] = size;
+        live[num_live++] = next_id;
+        printf("a %d %zu\n", next_id++, size);
+    }
+    for (int k = 0; k < num_live; k++)
+        printf("f %d\n", live[k]);
+
+    free(live);
+    free(sizes);
+}
+
+/* ---------------- 回放 ---------------- */
+
+/* 每页写一个字节, 让常驻内存能反映分配的真实大小 */
+static void touch(char* p, size_t size) {
+    if (!p)
+        return;
+    for (size_t off = 0; off < size; off += 4096)
+        p[off] = (char)0xA5;
+    if (size)
+        p[size - 1] = (char)0xA5;
+}
+
+static void replay(const allocator* a, const trace* t) {
+    void** ptrs = map_array(t->num_ids * sizeof(void*));
+    size_t* sizes = map_array(t->num_ids * sizeof(size_t));
+    /* 基线在 init 之前取, init 建立的初始堆也算进分母 */
+    size_t base = a->own_heap ? 0 : a->footprint();
+    if (!ptrs || !sizes || a->init() < 0) {
+        fprintf(stderr, "%s: init failed\n", a->name);
+        return;
+    }
+
+    size_t live = 0, peak_live = 0, peak_heap = 0;
+    long interval = t->num_ops / SAMPLES + 1;
+    long row_interval = t->num_ops / ROWS + 1;
+    long next_row = row_interval;
+    double elapsed = 0;
+
+    printf("\n%s\n  %6s %12s %12s %8s %8s\n", a->name, "ops%", "live KB",
+           "heap KB", "util", "extfrag");
+
+    for (long start = 0; start < t->num_ops; start += interval) {
+        long end = start + interval < t->num_ops ? start + interval
+                                                 : t->num_ops;
+        double t0 = now_sec();
+        for (long i = start; i < end; i++) {
+            const trace_op* op = &t->ops[i];
+            switch (op->type) {
+            case OP_ALLOC:
+                ptrs[op->id] = a->malloc(op->size);
+                touch(ptrs[op->id], op->size);
+                live += op->size;
+                sizes[op->id] = op->size;
+                break;
+            case OP_REALLOC:
+                ptrs[op->id] = a->realloc(ptrs[op->id], op->size);
+                touch(ptrs[op->id], op->size);
+                live += op->size - sizes[op->id];
+                sizes[op->id] = op->size;
+                break;
+            case OP_FREE:
+                a->free(ptrs[op->id]);
+                ptrs[op->id] = NULL;
+                live -= sizes[op->id];
+                sizes[op->id] = 0;
+                break;
+            }
+            if (live > peak_live)
+                peak_live = live;
+        }
+        elapsed += now_sec() - t0;
+
+        /* 采样不计入吞吐量 */
+        size_t fp = a->footprint();
+        size_t heap = fp > base ? fp - base : 0;
+        if (heap > peak_heap)
+            peak_heap = heap;
+        if (end < next_row && end < t->num_ops)
+            continue;
+        next_row += row_interval;
+
+        printf("  %5ld%% %12zu %12zu", end * 100 / t->num_ops, live >> 10,
+               heap >> 10);
+        printf(" %7.1f%%", heap ? 100.0 * live / heap : 0.0);
+        /* 外部碎片: 1 - 最大空闲块 / 空闲总量 */
+        if (a->free_stats) {
+            size_t total_free, largest_free;
+            a->free_stats(&total_free, &largest_free);
+            printf(" %7.1f%%",
+                   total_free ? 100.0 * (1 - (double)largest_free / total_free)
+                              : 0.0);
+        } else {
+            printf(" %8s", "-");
+        }
+        printf("\n");
+    }
+
+    for (int id = 0; id < t->num_ids; id++) {
+        if (ptrs[id])
+            a->free(ptrs[id]);
+    }
+    printf("  throughput: %.0f Kops/s, peak utilization: %.1f%%\n",
+           t->num_ops / elapsed / 1e3,
+           peak_heap ? 100.0 * peak_live / peak_heap : 0.0);
+
+    munmap(ptrs, t->num_ids * sizeof(void*));
+    munmap(sizes, t->num_ids * sizeof(size_t));
+}
+
+int main(int argc, char* argv[]) {
+    const char* list = "first,best,libc";
+    int opt;
+
+    while ((opt = getopt(argc, argv, "a:g:")) != -1) {
+        switch (opt) {
+        case 'a':
+            list = optarg;
+            break;
+        case 'g':
+            generate_trace(atol(optarg));
+            return 0;
+        default:
+            fprintf(stderr, "usage: %s [-g n] [-a alloc,...] trace...\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    if (optind >= argc) {
+        fprintf(stderr, "no trace file\n");
+        return 1;
+    }
+
+    char* names[16];
+    int num_allocs = 0;
+    char* list_copy = strdup(list);
+    for (char* tok = strtok(list_copy, ","); tok && num_allocs < 16;
+         tok = strtok(NULL, ","))
+        names[num_allocs++] = tok;
+
+    for (int i = optind; i < argc; i++) {
+        trace t;
+        if (read_trace(argv[i], &t) < 0)
+            continue;
+        printf("=== %s: %ld ops, %d ids ===\n", argv[i], t.num_ops,
+               t.num_ids);
+        /* 每次回放在新的子进程里进行, 各分配器都从干净的堆开始 */
+        for (int k = 0; k < num_allocs; k++) {
+            fflush(stdout);
+            pid_t pid = fork();
+            if (pid == 0) {
+                allocator a;
+                if (parse_allocator(names[k], &a) == 0)
+                    replay(&a, &t);
+                fflush(stdout);
+                _exit(0);
+            }
+            if (pid > 0)
+                waitpid(pid, NULL, 0);
+        }
+        munmap(t.ops, t.cap * sizeof(trace_op));
+    }
+
+    free(list_copy);
+    return 0;
+}
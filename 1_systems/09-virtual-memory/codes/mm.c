@@ -0,0 +1,239 @@
+#include "mm.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+
+/* ---------------- memlib: 用 mmap 预留的区域模拟 sbrk ---------------- */
+
+#define MAX_HEAP (1UL << 32) /* 4GB 虚拟地址, 只预留不提交 */
+
+static char* mem_heap;     /* 堆的第一个字节 */
+static char* mem_brk;      /* 堆的最后一个字节 + 1 */
+static char* mem_max_addr; /* 堆的最大合法地址 + 1 */
+
+int mem_init(void) {
+    if (mem_heap)
+        return 0;
+    mem_heap = mmap(NULL, MAX_HEAP, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mem_heap == MAP_FAILED) {
+        mem_heap = NULL;
+        return -1;
+    }
+    mem_brk = mem_heap;
+    mem_max_addr = mem_heap + MAX_HEAP;
+    return 0;
+}
+
+void mem_deinit(void) {
+    if (mem_heap)
+        munmap(mem_heap, MAX_HEAP);
+    mem_heap = mem_brk = mem_max_addr = NULL;
+}
+
+void* mem_sbrk(ptrdiff_t incr) {
+    char* old_brk = mem_brk;
+    if (incr < 0 || mem_brk + incr > mem_max_addr)
+        return (void*)-1;
+    mem_brk += incr;
+    return old_brk;
+}
+
+size_t mem_heapsize(void) {
+    return (size_t)(mem_brk - mem_heap);
+}
+
+/* ---------------- 隐式空闲链表 ---------------- */
+
+#define WSIZE 8           /* 字和头部/尾部大小 */
+#define DSIZE 16          /* 双字, 也是对齐要求 */
+#define CHUNKSIZE (1 << 12) /* 每次扩展堆的字节数 */
+
+#define MAX(x, y) ((x) > (y) ? (x) : (y))
+
+/* 把大小和分配位打包进一个字 */
+#define PACK(size, alloc) ((size) | (alloc))
+
+#define GET(p) (*(size_t*)(p))
+#define PUT(p, val) (*(size_t*)(p) = (val))
+
+#define GET_SIZE(p) (GET(p) & ~(size_t)0xF)
+#define GET_ALLOC(p) (GET(p) & 0x1)
+
+/* bp 指向有效载荷 */
+#define HDRP(bp) ((char*)(bp) - WSIZE)
+#define FTRP(bp) ((char*)(bp) + GET_SIZE(HDRP(bp)) - DSIZE)
+
+#define NEXT_BLKP(bp) ((char*)(bp) + GET_SIZE(((char*)(bp) - WSIZE)))
+#define PREV_BLKP(bp) ((char*)(bp) - GET_SIZE(((char*)(bp) - DSIZE)))
+
+static char* heap_listp;
+static fit_policy fit;
+
+static void* coalesce(void* bp) {
+    size_t prev_alloc = GET_ALLOC(FTRP(PREV_BLKP(bp)));
+    size_t next_alloc = GET_ALLOC(HDRP(NEXT_BLKP(bp)));
+    size_t size = GET_SIZE(HDRP(bp));
+
+    if (prev_alloc && next_alloc) { /* 情况 1: 前后都已分配 */
+        return bp;
+    } else if (prev_alloc && !next_alloc) { /* 情况 2: 后块空闲 */
+        size += GET_SIZE(HDRP(NEXT_BLKP(bp)));
+        PUT(HDRP(bp), PACK(size, 0));
+        PUT(FTRP(bp), PACK(size, 0));
+    } else if (!prev_alloc && next_alloc) { /* 情况 3: 前块空闲 */
+        size += GET_SIZE(HDRP(PREV_BLKP(bp)));
+        PUT(FTRP(bp), PACK(size, 0));
+        PUT(HDRP(PREV_BLKP(bp)), PACK(size, 0));
+        bp = PREV_BLKP(bp);
+    } else { /* 情况 4: 前后都空闲 */
+        size += GET_SIZE(HDRP(PREV_BLKP(bp))) +
+                GET_SIZE(FTRP(NEXT_BLKP(bp)));
+        PUT(HDRP(PREV_BLKP(bp)), PACK(size, 0));
+        PUT(FTRP(NEXT_BLKP(bp)), PACK(size, 0));
+        bp = PREV_BLKP(bp);
+    }
+    return bp;
+}
+
+static void* extend_heap(size_t words) {
+    /* 保持双字对齐 */
+    size_t size = (words % 2) ? (words + 1) * WSIZE : words * WSIZE;
+    char* bp = mem_sbrk((ptrdiff_t)size);
+    if (bp == (void*)-1)
+        return NULL;
+
+    PUT(HDRP(bp), PACK(size, 0));         /* 空闲块头部 */
+    PUT(FTRP(bp), PACK(size, 0));         /* 空闲块尾部 */
+    PUT(HDRP(NEXT_BLKP(bp)), PACK(0, 1)); /* 新的结尾块 */
+
+    return coalesce(bp);
+}
+
+int mm_init(fit_policy policy) {
+    if (mem_init() < 0)
+        return -1;
+    mem_brk = mem_heap; /* 每次 mm_init 从空堆开始 */
+    fit = policy;
+
+    if ((heap_listp = mem_sbrk(4 * WSIZE)) == (void*)-1)
+        return -1;
+    PUT(heap_listp, 0);                            /* 对齐填充 */
+    PUT(heap_listp + (1 * WSIZE), PACK(DSIZE, 1)); /* 序言块头部 */
+    PUT(heap_listp + (2 * WSIZE), PACK(DSIZE, 1)); /* 序言块尾部 */
+    PUT(heap_listp + (3 * WSIZE), PACK(0, 1));     /* 结尾块 */
+    heap_listp += (2 * WSIZE);
+
+    if (extend_heap(CHUNKSIZE / WSIZE) == NULL)
+        return -1;
+    return 0;
+}
+
+/* 首次适配: 从堆起始位置选第一个足够大的空闲块 */
+static void* find_fit_first(size_t asize) {
+    for (char* bp = heap_listp; GET_SIZE(HDRP(bp)) > 0; bp = NEXT_BLKP(bp)) {
+        if (!GET_ALLOC(HDRP(bp)) && GET_SIZE(HDRP(bp)) >= asize)
+            return bp;
+    }
+    return NULL;
+}
+
+/* 最佳适配: 扫描整个堆, 选最接近请求大小的空闲块 */
+static void* find_fit_best(size_t asize) {
+    char* best_fit = NULL;
+    size_t min_size = SIZE_MAX;
+    for (char* bp = heap_listp; GET_SIZE(HDRP(bp)) > 0; bp = NEXT_BLKP(bp)) {
+        size_t size = GET_SIZE(HDRP(bp));
+        if (!GET_ALLOC(HDRP(bp)) && size >= asize && size < min_size) {
+            min_size = size;
+            best_fit = bp;
+            if (size == asize)
+                break;
+        }
+    }
+    return best_fit;
+}
+
+/* 剩余部分不小于最小块 (2 * DSIZE) 时分割 */
+static void place(void* bp, size_t asize) {
+    size_t csize = GET_SIZE(HDRP(bp));
+
+    if ((csize - asize) >= (2 * DSIZE)) {
+        PUT(HDRP(bp), PACK(asize, 1));
+        PUT(FTRP(bp), PACK(asize, 1));
+        bp = NEXT_BLKP(bp);
+        PUT(HDRP(bp), PACK(csize - asize, 0));
+        PUT(FTRP(bp), PACK(csize - asize, 0));
+    } else {
+        PUT(HDRP(bp), PACK(csize, 1));
+        PUT(FTRP(bp), PACK(csize, 1));
+    }
+}
+
+void* mm_malloc(size_t size) {
+    if (size == 0)
+        return NULL;
+
+    /* 加上头部和尾部, 向上取整到双字 */
+    size_t asize;
+    if (size <= DSIZE)
+        asize = 2 * DSIZE;
+    else
+        asize = DSIZE * ((size + DSIZE + (DSIZE - 1)) / DSIZE);
+
+    char* bp = fit == FIT_BEST ? find_fit_best(asize) : find_fit_first(asize);
+    if (bp != NULL) {
+        place(bp, asize);
+        return bp;
+    }
+
+    size_t extendsize = MAX(asize, CHUNKSIZE);
+    if ((bp = extend_heap(extendsize / WSIZE)) == NULL)
+        return NULL;
+    place(bp, asize);
+    return bp;
+}
+
+void mm_free(void* bp) {
+    if (bp == NULL)
+        return;
+    size_t size = GET_SIZE(HDRP(bp));
+    PUT(HDRP(bp), PACK(size, 0));
+    PUT(FTRP(bp), PACK(size, 0));
+    coalesce(bp);
+}
+
+void* mm_realloc(void* ptr, size_t size) {
+    if (ptr == NULL)
+        return mm_malloc(size);
+    if (size == 0) {
+        mm_free(ptr);
+        return NULL;
+    }
+
+    size_t old = GET_SIZE(HDRP(ptr)) - DSIZE;
+    if (size <= old)
+        return ptr;
+
+    void* newptr = mm_malloc(size);
+    if (newptr == NULL)
+        return NULL;
+    memcpy(newptr, ptr, old);
+    mm_free(ptr);
+    return newptr;
+}
+
+void mm_free_stats(size_t* total_free, size_t* largest_free) {
+    size_t total = 0, largest = 0;
+    for (char* bp = heap_listp; GET_SIZE(HDRP(bp)) > 0; bp = NEXT_BLKP(bp)) {
+        if (!GET_ALLOC(HDRP(bp))) {
+            size_t size = GET_SIZE(HDRP(bp));
+            total += size;
+            if (size > largest)
+                largest = size;
+        }
+    }
+    *total_free = total;
+    *largest_free = largest;
+}
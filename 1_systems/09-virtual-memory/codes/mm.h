@@ -0,0 +1,27 @@
+#ifndef MM_H
+#define MM_H
+
+#include <stddef.h>
+
+/*
+ * 隐式空闲链表参考分配器 (9.8 笔记中的实现)
+ * 堆由 mem_sbrk 模拟, 块带头部和尾部边界标记, 释放时立即合并
+ */
+
+typedef enum { FIT_FIRST, FIT_BEST } fit_policy;
+
+/* 模拟的 sbrk 堆 */
+int mem_init(void);
+void mem_deinit(void);
+void* mem_sbrk(ptrdiff_t incr);
+size_t mem_heapsize(void);
+
+int mm_init(fit_policy policy);
+void* mm_malloc(size_t size);
+void mm_free(void* ptr);
+void* mm_realloc(void* ptr, size_t size);
+
+/* 统计空闲块总字节数与最大空闲块, 用于计算外部碎片 */
+void mm_free_stats(size_t* total_free, size_t* largest_free);
+
+#endif
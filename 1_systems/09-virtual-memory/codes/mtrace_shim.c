@@ -0,0 +1,224 @@
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/*
+ * 记录 malloc/realloc/free 调用序列的 LD_PRELOAD 垫片,
+ * 输出格式可直接交给 mdriver 回放
+ *
+ * 编译: gcc -O2 -fPIC -shared -pthread mtrace_shim.c -o libmtrace.so -ldl
+ * 使用: MTRACE_FILE=job.rep LD_PRELOAD=./libmtrace.so ./job
+ */
+
+#define TABLE_BITS 22 /* 指针 -> id 的开放寻址表, 最多约 400 万个存活块 */
+#define TABLE_SIZE (1UL << TABLE_BITS)
+#define BUF_SIZE (1 << 16)
+
+typedef struct {
+    void* ptr;
+    int id;
+} slot;
+
+static void* (*real_malloc)(size_t);
+static void (*real_free)(void*);
+static void* (*real_realloc)(void*, size_t);
+static void* (*real_calloc)(size_t, size_t);
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static slot* table;
+static int next_id;
+static size_t live_count;
+static int fd = -1;
+static char buf[BUF_SIZE];
+static int buf_len;
+
+/* dlsym 自己会调用 calloc, 初始化期间先用静态缓冲区应付 */
+static char bootstrap[4096];
+static size_t bootstrap_used;
+static int initializing;
+
+/* 本线程正在记录时, 内部调用不再记录 */
+static __thread int in_hook __attribute__((tls_model("initial-exec")));
+
+static void flush_buf(void) {
+    if (fd >= 0 && buf_len > 0 && write(fd, buf, buf_len) < 0)
+        fd = -1;
+    buf_len = 0;
+}
+
+static void init(void) {
+    initializing = 1;
+    real_malloc = dlsym(RTLD_NEXT, "malloc");
+    real_free = dlsym(RTLD_NEXT, "free");
+    real_realloc = dlsym(RTLD_NEXT, "realloc");
+    real_calloc = dlsym(RTLD_NEXT, "calloc");
+
+    table = mmap(NULL, TABLE_SIZE * sizeof(slot), PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (table == MAP_FAILED)
+        table = NULL;
+
+    const char* path = getenv("MTRACE_FILE");
+    fd = open(path ? path : "mtrace.rep", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    initializing = 0;
+}
+
+static inline size_t hash(void* p) {
+    return ((uintptr_t)p * 0x9E3779B97F4A7C15ULL) >> (64 - TABLE_BITS);
+}
+
+static void table_put(void* p, int id) {
+    size_t i = hash(p);
+    while (table[i].ptr)
+        i = (i + 1) & (TABLE_SIZE - 1);
+    table[i].ptr = p;
+    table[i].id = id;
+    live_count++;
+}
+
+/* 表太满时停止记录新块, 避免探测链过长 */
+static int table_insert(void* p) {
+    if (live_count > TABLE_SIZE / 4 * 3)
+        return -1;
+    table_put(p, next_id);
+    return next_id++;
+}
+
+/*
+ * 找到并删除, 不存在 (比如垫片加载前分配的块) 返回 -1。
+ * 线性探测用后移删除, 不留墓碑
+ */
+static int table_remove(void* p) {
+    size_t i = hash(p);
+    while (table[i].ptr && table[i].ptr != p)
+        i = (i + 1) & (TABLE_SIZE - 1);
+    if (!table[i].ptr)
+        return -1;
+
+    int id = table[i].id;
+    size_t hole = i;
+    for (size_t j = (i + 1) & (TABLE_SIZE - 1); table[j].ptr;
+         j = (j + 1) & (TABLE_SIZE - 1)) {
+        /* j 的理想位置不在 (hole, j] 之间时才能挪进空洞 */
+        size_t home = hash(table[j].ptr);
+        if (((j - home) & (TABLE_SIZE - 1)) >=
+            ((j - hole) & (TABLE_SIZE - 1))) {
+            table[hole] = table[j];
+            hole = j;
+        }
+    }
+    table[hole].ptr = NULL;
+    live_count--;
+    return id;
+}
+
+static void emit(char type, int id, size_t size) {
+    if (buf_len > BUF_SIZE - 64)
+        flush_buf();
+    if (type == 'f')
+        buf_len += snprintf(buf + buf_len, 64, "f %d\n", id);
+    else
+        buf_len += snprintf(buf + buf_len, 64, "%c %d %zu\n", type, id, size);
+}
+
+static void record_alloc(void* p, size_t size) {
+    if (!p || !table)
+        return;
+    pthread_mutex_lock(&lock);
+    int id = table_insert(p);
+    if (id >= 0)
+        emit('a', id, size);
+    pthread_mutex_unlock(&lock);
+}
+
+void* malloc(size_t size) {
+    if (!real_malloc)
+        init();
+    if (in_hook)
+        return real_malloc(size);
+    in_hook = 1;
+    void* p = real_malloc(size);
+    record_alloc(p, size);
+    in_hook = 0;
+    return p;
+}
+
+void* calloc(size_t nmemb, size_t size) {
+    if (initializing) {
+        /* dlsym 期间的请求: 从静态缓冲区切, 永不释放 */
+        size_t n = (nmemb * size + 15) & ~(size_t)15;
+        if (bootstrap_used + n > sizeof(bootstrap))
+            return NULL;
+        void* p = bootstrap + bootstrap_used;
+        bootstrap_used += n;
+        return p;
+    }
+    if (!real_calloc)
+        init();
+    if (in_hook)
+        return real_calloc(nmemb, size);
+    in_hook = 1;
+    void* p = real_calloc(nmemb, size);
+    record_alloc(p, nmemb * size);
+    in_hook = 0;
+    return p;
+}
+
+void free(void* p) {
+    if (!p || ((char*)p >= bootstrap && (char*)p < bootstrap + sizeof(bootstrap)))
+        return;
+    if (!real_free)
+        init();
+    if (!in_hook && table) {
+        in_hook = 1;
+        pthread_mutex_lock(&lock);
+        int id = table_remove(p);
+        if (id >= 0)
+            emit('f', id, 0);
+        pthread_mutex_unlock(&lock);
+        in_hook = 0;
+    }
+    real_free(p);
+}
+
+void* realloc(void* p, size_t size) {
+    if (!real_realloc)
+        init();
+    if (in_hook || !table)
+        return real_realloc(p, size);
+    in_hook = 1;
+    void* q = real_realloc(p, size);
+    if (q || size == 0) {
+        pthread_mutex_lock(&lock);
+        int id = p ? table_remove(p) : -1;
+        if (size == 0) {
+            if (id >= 0)
+                emit('f', id, 0);
+        } else if (id >= 0) {
+            /* 同一个 id 换到新地址 */
+            table_put(q, id);
+            emit('r', id, size);
+        } else if ((id = table_insert(q)) >= 0) {
+            emit('a', id, size);
+        }
+        pthread_mutex_unlock(&lock);
+    }
+    in_hook = 0;
+    return q;
+}
+
+__attribute__((destructor)) static void finish(void) {
+    pthread_mutex_lock(&lock);
+    flush_buf();
+    if (fd >= 0)
+        close(fd);
+    fd = -1;
+    pthread_mutex_unlock(&lock);
+}
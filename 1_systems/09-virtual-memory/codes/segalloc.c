@@ -0,0 +1,572 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/*
+ * 分离适配 (segregated fit) 分配器, 可通过 LD_PRELOAD 替换 glibc malloc
+ *
+ * 三层结构:
+ *   1. 小块 (<= 8KB): 按大小类分离的空闲链表, 每个线程有自己的缓存
+ *      (tcache), 缓存空了从中心链表批量取, 满了批量还回去,
+ *      只有批量操作才需要加锁, 避免 arena 锁竞争
+ *   2. 大块: 带边界标记 (header + footer) 的堆, 空闲块按 2 的幂分箱,
+ *      释放时立即与前后空闲块合并
+ *   3. 巨块 (> 4MB): 直接 mmap / munmap
+ *
+ * 编译: gcc -O2 -fPIC -shared -pthread segalloc.c -o libsegalloc.so
+ * 使用: LD_PRELOAD=./libsegalloc.so ./vec
+ */
+
+/* 基本常量和宏, 与 9.8 笔记中的隐式链表写法一致 */
+#define WSIZE 8
+#define DSIZE 16
+#define ALIGNMENT 16
+#define ALIGN(n) (((n) + (ALIGNMENT - 1)) & ~(size_t)(ALIGNMENT - 1))
+
+#define GET(p) (*(size_t*)(p))
+#define PUT(p, val) (*(size_t*)(p) = (val))
+
+/* 头部: 大小 | 类型 << 1 | 分配位, 大小总是 16 的倍数, 低 4 位空闲 */
+#define PACK(size, kind, alloc) ((size) | ((kind) << 1) | (alloc))
+#define GET_SIZE(p) (GET(p) & ~(size_t)0xF)
+#define GET_KIND(p) ((GET(p) >> 1) & 0x3)
+#define GET_ALLOC(p) (GET(p) & 0x1)
+
+/* 块类型: 小块头部的"大小"字段存放大小类编号 */
+#define KIND_SMALL 0
+#define KIND_LARGE 1
+#define KIND_HUGE 2
+#define KIND_OFFSET 3 /* memalign 产生的偏移块, 大小字段是到真实块的距离 */
+
+/* bp 指向有效载荷 */
+#define HDRP(bp) ((char*)(bp) - WSIZE)
+#define FTRP(bp) ((char*)(bp) + GET_SIZE(HDRP(bp)) - DSIZE)
+#define NEXT_BLKP(bp) ((char*)(bp) + GET_SIZE(HDRP(bp)))
+#define PREV_BLKP(bp) ((char*)(bp) - GET_SIZE((char*)(bp) - DSIZE))
+
+/* 空闲大块的有效载荷前两个字存放显式链表指针 */
+#define NEXT_FREE(bp) (*(void**)(bp))
+#define PREV_FREE(bp) (*((void**)(bp) + 1))
+
+#define SMALL_MAX 8192             /* 小块的最大块大小 (含头部) */
+#define NUM_CLASSES 35             /* 32..256 步长 16, 之后每次翻倍分 4 档 */
+#define RUN_SIZE (64UL << 10)      /* 每次为小块切分的大块 */
+#define HUGE_THRESHOLD (4UL << 20) /* 超过则直接 mmap */
+#define ARENA_SIZE (16UL << 20)    /* 大块堆每次扩展的大小 */
+#define MIN_LARGE 32               /* header + 两个指针 + footer */
+#define NUM_BINS 48
+
+/* ---------------- 大小类 ---------------- */
+
+static inline int size_class(size_t need) {
+    if (need <= 256)
+        return (int)(need / 16) - 2;
+    int lg = 63 - __builtin_clzl(need - 1);
+    int idx = (int)((need - 1) >> (lg - 2)) & 3;
+    return 15 + (lg - 8) * 4 + idx;
+}
+
+static inline size_t class_size(int c) {
+    if (c < 15)
+        return (size_t)(c + 2) * 16;
+    int k = c - 15;
+    int lg = 8 + k / 4;
+    return ((size_t)1 << lg) + (size_t)(k % 4 + 1) * ((size_t)1 << (lg - 2));
+}
+
+/* tcache 上限: 大约每类缓存 32KB, 4 到 64 个块之间 */
+static inline int cache_limit(int c) {
+    size_t n = (32UL << 10) / class_size(c);
+    return n < 4 ? 4 : (n > 64 ? 64 : (int)n);
+}
+
+/* ---------------- 大块堆 (边界标记) ---------------- */
+
+static pthread_mutex_t heap_lock = PTHREAD_MUTEX_INITIALIZER;
+static void* bins[NUM_BINS];
+
+static inline int bin_index(size_t size) {
+    int b = 63 - __builtin_clzl(size);
+    return b < NUM_BINS ? b : NUM_BINS - 1;
+}
+
+static void bin_insert(void* bp) {
+    int b = bin_index(GET_SIZE(HDRP(bp)));
+    NEXT_FREE(bp) = bins[b];
+    PREV_FREE(bp) = NULL;
+    if (bins[b])
+        PREV_FREE(bins[b]) = bp;
+    bins[b] = bp;
+}
+
+static void bin_remove(void* bp) {
+    int b = bin_index(GET_SIZE(HDRP(bp)));
+    if (PREV_FREE(bp))
+        NEXT_FREE(PREV_FREE(bp)) = NEXT_FREE(bp);
+    else
+        bins[b] = NEXT_FREE(bp);
+    if (NEXT_FREE(bp))
+        PREV_FREE(NEXT_FREE(bp)) = PREV_FREE(bp);
+}
+
+static void set_block(void* bp, size_t size, int alloc) {
+    PUT(HDRP(bp), PACK(size, KIND_LARGE, alloc));
+    PUT(FTRP(bp), PACK(size, KIND_LARGE, alloc));
+}
+
+/* 合并相邻空闲块, bp 不在任何箱中, 返回合并后的块 */
+static void* coalesce(void* bp) {
+    size_t size = GET_SIZE(HDRP(bp));
+    int prev_alloc = GET_ALLOC((char*)bp - DSIZE);
+    int next_alloc = GET_ALLOC(HDRP(NEXT_BLKP(bp)));
+
+    if (!next_alloc) {
+        void* next = NEXT_BLKP(bp);
+        bin_remove(next);
+        size += GET_SIZE(HDRP(next));
+    }
+    if (!prev_alloc) {
+        void* prev = PREV_BLKP(bp);
+        bin_remove(prev);
+        size += GET_SIZE(HDRP(prev));
+        bp = prev;
+    }
+    set_block(bp, size, 0);
+    return bp;
+}
+
+/*
+ * 新申请一段 arena: 填充字 + 序言块 + 一个大空闲块 + 结尾块,
+ * 每段 arena 各自有序言/结尾块, 合并永远不会跨越 arena
+ */
+static void* extend_heap(size_t asize) {
+    size_t len = ARENA_SIZE;
+    if (asize + 4 * WSIZE > len)
+        len = (asize + 4 * WSIZE + ARENA_SIZE - 1) & ~(ARENA_SIZE - 1);
+
+    char* base = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED)
+        return NULL;
+
+    PUT(base, 0);                                      /* 对齐填充 */
+    PUT(base + WSIZE, PACK(DSIZE, KIND_LARGE, 1));     /* 序言块头部 */
+    PUT(base + 2 * WSIZE, PACK(DSIZE, KIND_LARGE, 1)); /* 序言块尾部 */
+    PUT(base + len - WSIZE, PACK(0, KIND_LARGE, 1));   /* 结尾块 */
+
+    void* bp = base + 4 * WSIZE;
+    set_block(bp, len - 4 * WSIZE, 0);
+    return bp;
+}
+
+/* 分箱内首次适配, 找不到就去更大的箱 */
+static void* find_fit(size_t asize) {
+    for (int b = bin_index(asize); b < NUM_BINS; b++) {
+        for (void* bp = bins[b]; bp; bp = NEXT_FREE(bp)) {
+            if (GET_SIZE(HDRP(bp)) >= asize)
+                return bp;
+        }
+    }
+    return NULL;
+}
+
+/* 放置并在剩余部分足够大时分割 */
+static void place(void* bp, size_t asize) {
+    size_t csize = GET_SIZE(HDRP(bp));
+    bin_remove(bp);
+    if (csize - asize >= MIN_LARGE) {
+        set_block(bp, asize, 1);
+        void* rest = NEXT_BLKP(bp);
+        set_block(rest, csize - asize, 0);
+        bin_insert(rest);
+    } else {
+        set_block(bp, csize, 1);
+    }
+}
+
+static void* large_alloc(size_t asize) {
+    pthread_mutex_lock(&heap_lock);
+    void* bp = find_fit(asize);
+    if (!bp) {
+        bp = extend_heap(asize);
+        if (bp)
+            bin_insert(bp);
+    }
+    if (bp)
+        place(bp, asize);
+    pthread_mutex_unlock(&heap_lock);
+    return bp;
+}
+
+static void large_free(void* bp) {
+    pthread_mutex_lock(&heap_lock);
+    set_block(bp, GET_SIZE(HDRP(bp)), 0);
+    bin_insert(coalesce(bp));
+    pthread_mutex_unlock(&heap_lock);
+}
+
+/* ---------------- 巨块 (mmap) ---------------- */
+
+static void* huge_alloc(size_t size) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t len = (size + DSIZE + page - 1) & ~(page - 1);
+    char* base = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED)
+        return NULL;
+    void* bp = base + DSIZE;
+    PUT(HDRP(bp), PACK(len, KIND_HUGE, 1));
+    return bp;
+}
+
+static void huge_free(void* bp) {
+    munmap((char*)bp - DSIZE, GET_SIZE(HDRP(bp)));
+}
+
+/* ---------------- 小块: 中心链表 + 线程缓存 ---------------- */
+
+typedef struct {
+    pthread_mutex_t lock;
+    void* head;
+} central_list;
+
+typedef struct {
+    void* head[NUM_CLASSES];
+    int count[NUM_CLASSES];
+    int registered;
+} thread_cache;
+
+static central_list central[NUM_CLASSES] = {
+    [0 ... NUM_CLASSES - 1] = {PTHREAD_MUTEX_INITIALIZER, NULL}};
+static pthread_once_t key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t cache_key;
+
+/* initial-exec 模型: 访问 TLS 时不会回调 malloc */
+static __thread thread_cache tcache
+    __attribute__((tls_model("initial-exec")));
+
+/* 把 n 个块组成的链 [first, last] 还给中心链表 */
+static void central_push(int c, void* first, void* last) {
+    pthread_mutex_lock(&central[c].lock);
+    NEXT_FREE(last) = central[c].head;
+    central[c].head = first;
+    pthread_mutex_unlock(&central[c].lock);
+}
+
+/* 把一个大块切成若干同类小块, 返回链表头, 块数写入 *n */
+static void* carve_run(int c, int* n) {
+    size_t bsize = class_size(c);
+    char* run = large_alloc(ALIGN(RUN_SIZE + DSIZE));
+    if (!run)
+        return NULL;
+
+    /* 小块头部位于 8 mod 16 处, 有效载荷才能 16 字节对齐 */
+    char* start = run;
+    char* end = FTRP(run) - WSIZE;
+    void* head = NULL;
+    int count = 0;
+    for (char* hp = end - bsize; hp >= start; hp -= bsize) {
+        void* bp = hp + WSIZE;
+        PUT(hp, PACK((size_t)c << 4, KIND_SMALL, 1));
+        NEXT_FREE(bp) = head;
+        head = bp;
+        count++;
+    }
+    *n = count;
+    return head;
+}
+
+/* 线程缓存为空时, 从中心链表批量取一半上限的块 */
+static void* refill(int c) {
+    int want = cache_limit(c) / 2;
+    void* head;
+    int got = 0;
+
+    pthread_mutex_lock(&central[c].lock);
+    head = central[c].head;
+    void* last = NULL;
+    for (void* bp = head; bp && got < want; bp = NEXT_FREE(bp)) {
+        last = bp;
+        got++;
+    }
+    if (got) {
+        central[c].head = NEXT_FREE(last);
+        NEXT_FREE(last) = NULL;
+    }
+    pthread_mutex_unlock(&central[c].lock);
+
+    if (!got) {
+        head = carve_run(c, &got);
+        if (!head)
+            return NULL;
+        /* 超出的部分放回中心链表 */
+        if (got > want) {
+            void* bp = head;
+            for (int i = 1; i < want; i++)
+                bp = NEXT_FREE(bp);
+            void* rest = NEXT_FREE(bp);
+            void* rest_last = rest;
+            while (NEXT_FREE(rest_last))
+                rest_last = NEXT_FREE(rest_last);
+            NEXT_FREE(bp) = NULL;
+            central_push(c, rest, rest_last);
+            got = want;
+        }
+    }
+
+    /* 取出一个返回, 其余留在线程缓存 */
+    tcache.head[c] = NEXT_FREE(head);
+    tcache.count[c] = got - 1;
+    return head;
+}
+
+/* 线程缓存满时把一半还给中心链表 */
+static void flush(int c, int keep) {
+    int n = tcache.count[c] - keep;
+    if (n <= 0)
+        return;
+    void* first = tcache.head[c];
+    void* last = first;
+    for (int i = 1; i < n; i++)
+        last = NEXT_FREE(last);
+    tcache.head[c] = NEXT_FREE(last);
+    tcache.count[c] = keep;
+    central_push(c, first, last);
+}
+
+/* 线程退出时清空缓存 */
+static void cache_destructor(void* arg) {
+    (void)arg;
+    for (int c = 0; c < NUM_CLASSES; c++)
+        flush(c, 0);
+}
+
+static void make_key(void) {
+    pthread_key_create(&cache_key, cache_destructor);
+}
+
+static void register_cache(void) {
+    tcache.registered = 1;
+    pthread_once(&key_once, make_key);
+    pthread_setspecific(cache_key, &tcache);
+}
+
+static void* small_alloc(int c) {
+    if (!tcache.registered)
+        register_cache();
+    void* bp = tcache.head[c];
+    if (bp) {
+        tcache.head[c] = NEXT_FREE(bp);
+        tcache.count[c]--;
+        return bp;
+    }
+    return refill(c);
+}
+
+static void small_free(void* bp) {
+    if (!tcache.registered)
+        register_cache();
+    int c = (int)(GET_SIZE(HDRP(bp)) >> 4);
+    NEXT_FREE(bp) = tcache.head[c];
+    tcache.head[c] = bp;
+    if (++tcache.count[c] > cache_limit(c))
+        flush(c, cache_limit(c) / 2);
+}
+
+/* ---------------- fork 安全 ---------------- */
+
+static void prepare_fork(void) {
+    for (int c = 0; c < NUM_CLASSES; c++)
+        pthread_mutex_lock(&central[c].lock);
+    pthread_mutex_lock(&heap_lock);
+}
+
+static void parent_fork(void) {
+    pthread_mutex_unlock(&heap_lock);
+    for (int c = NUM_CLASSES - 1; c >= 0; c--)
+        pthread_mutex_unlock(&central[c].lock);
+}
+
+static void child_fork(void) {
+    pthread_mutex_init(&heap_lock, NULL);
+    for (int c = 0; c < NUM_CLASSES; c++)
+        pthread_mutex_init(&central[c].lock, NULL);
+}
+
+__attribute__((constructor)) static void segalloc_init(void) {
+    pthread_atfork(prepare_fork, parent_fork, child_fork);
+}
+
+/* ---------------- 对外接口 ---------------- */
+
+/* 找到真正的块 (去掉 memalign 的偏移) */
+static inline void* real_block(void* bp) {
+    if (GET_KIND(HDRP(bp)) == KIND_OFFSET)
+        return (char*)bp - GET_SIZE(HDRP(bp));
+    return bp;
+}
+
+static size_t usable_size(void* bp) {
+    void* real = real_block(bp);
+    size_t offset = (char*)bp - (char*)real;
+    switch (GET_KIND(HDRP(real))) {
+    case KIND_SMALL:
+        return class_size((int)(GET_SIZE(HDRP(real)) >> 4)) - WSIZE - offset;
+    case KIND_LARGE:
+        return GET_SIZE(HDRP(real)) - DSIZE - offset;
+    default:
+        return GET_SIZE(HDRP(real)) - DSIZE - offset;
+    }
+}
+
+/*
+ * 内部入口: calloc/realloc/memalign 都调用它而不是 malloc,
+ * 否则 gcc 会把 malloc + memset 识别成 calloc, 在 calloc 里无限递归
+ */
+static void* seg_malloc(size_t size) {
+    if (size == 0)
+        size = 1;
+    if (size > PTRDIFF_MAX - ARENA_SIZE) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    void* bp;
+    size_t need = ALIGN(size + WSIZE);
+    if (need <= SMALL_MAX) {
+        bp = small_alloc(size_class(need < 32 ? 32 : need));
+    } else if (size > HUGE_THRESHOLD) {
+        bp = huge_alloc(size);
+    } else {
+        bp = large_alloc(ALIGN(size + DSIZE));
+    }
+    if (!bp)
+        errno = ENOMEM;
+    return bp;
+}
+
+static void seg_free(void* ptr) {
+    if (!ptr)
+        return;
+    void* bp = real_block(ptr);
+    switch (GET_KIND(HDRP(bp))) {
+    case KIND_SMALL:
+        small_free(bp);
+        break;
+    case KIND_LARGE:
+        large_free(bp);
+        break;
+    case KIND_HUGE:
+        huge_free(bp);
+        break;
+    }
+}
+
+void* malloc(size_t size) {
+    return seg_malloc(size);
+}
+
+void free(void* ptr) {
+    seg_free(ptr);
+}
+
+void* calloc(size_t nmemb, size_t size) {
+    size_t total;
+    if (__builtin_mul_overflow(nmemb, size, &total)) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    void* bp = seg_malloc(total);
+    /* mmap 出来的巨块本来就是全零 */
+    if (bp && total <= HUGE_THRESHOLD)
+        memset(bp, 0, total);
+    return bp;
+}
+
+void* realloc(void* ptr, size_t size) {
+    if (!ptr)
+        return seg_malloc(size);
+    if (size == 0) {
+        seg_free(ptr);
+        return NULL;
+    }
+    size_t old = usable_size(ptr);
+    /* 原块够用, 且不会浪费超过一半空间 */
+    if (size <= old && size >= old / 2)
+        return ptr;
+
+    void* bp = seg_malloc(size);
+    if (!bp)
+        return NULL;
+    memcpy(bp, ptr, size < old ? size : old);
+    seg_free(ptr);
+    return bp;
+}
+
+void* reallocarray(void* ptr, size_t nmemb, size_t size) {
+    size_t total;
+    if (__builtin_mul_overflow(nmemb, size, &total)) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    return realloc(ptr, total);
+}
+
+void* memalign(size_t alignment, size_t size) {
+    if (alignment <= ALIGNMENT)
+        return seg_malloc(size);
+    if (alignment & (alignment - 1)) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    /* 多分配 alignment 字节, 在块内找对齐地址, 前面放一个偏移头部;
+       size + alignment 溢出时会得到一个很小的块, 先拒绝 */
+    if (size > SIZE_MAX - alignment) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    char* bp = seg_malloc(size + alignment);
+    if (!bp)
+        return NULL;
+    char* aligned = (char*)(((uintptr_t)bp + alignment - 1) &
+                            ~(uintptr_t)(alignment - 1));
+    if (aligned != bp)
+        PUT(HDRP(aligned), PACK((size_t)(aligned - bp), KIND_OFFSET, 1));
+    return aligned;
+}
+
+int posix_memalign(void** memptr, size_t alignment, size_t size) {
+    if (alignment < sizeof(void*) || (alignment & (alignment - 1)))
+        return EINVAL;
+    void* bp = memalign(alignment, size);
+    if (!bp)
+        return ENOMEM;
+    *memptr = bp;
+    return 0;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    return memalign(alignment, size);
+}
+
+void* valloc(size_t size) {
+    return memalign((size_t)sysconf(_SC_PAGESIZE), size);
+}
+
+void* pvalloc(size_t size) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    if (size > SIZE_MAX - (page - 1)) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    return memalign(page, (size + page - 1) & ~(page - 1));
+}
+
+size_t malloc_usable_size(void* ptr) {
+    return ptr ? usable_size(ptr) : 0;
+}
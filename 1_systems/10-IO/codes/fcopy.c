@@ -0,0 +1,193 @@
+#define _GNU_SOURCE
+#include "fcopy.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "rio.h"
+
+#define CHUNK (1UL << 30)     /* 每次系统调用最多搬这么多 */
+#define RW_BUFSIZE (1 << 20)  /* read/write 路径的缓冲区 */
+#define PIPE_SIZE (1 << 20)   /* splice 用的管道容量 */
+
+const char* fcopy_method_name(fcopy_method method) {
+    static const char* names[FCOPY_NUM_METHODS] = {
+        "auto", "copy_file_range", "sendfile", "splice", "read/write"};
+    return names[method];
+}
+
+/* 这些错误说明这种方式用不了, 而不是拷贝本身出错 */
+static int unsupported(int err) {
+    return err == ENOSYS || err == EXDEV || err == EINVAL ||
+           err == EOPNOTSUPP || err == ENOTSUP || err == EBADF;
+}
+
+static size_t step(size_t left) {
+    return left < CHUNK ? left : CHUNK;
+}
+
+/*
+ * 每种方式都返回已拷贝的字节数, 在 *err 里留下停止的原因:
+ * 0 表示完成 (或 EOF), 否则是 errno
+ */
+static size_t copy_cfr(int in, int out, size_t len, int* err) {
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = copy_file_range(in, NULL, out, NULL, step(len - done), 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) {
+            *err = n < 0 ? errno : 0;
+            return done;
+        }
+        done += n;
+    }
+    *err = 0;
+    return done;
+}
+
+static size_t copy_sendfile(int in, int out, size_t len, int* err) {
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = sendfile(out, in, NULL, step(len - done));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) {
+            *err = n < 0 ? errno : 0;
+            return done;
+        }
+        done += n;
+    }
+    *err = 0;
+    return done;
+}
+
+/* 文件 -> 管道 -> 文件, 两次 splice 只搬页的引用 */
+static size_t copy_splice(int in, int out, size_t len, int* err) {
+    int p[2];
+    if (pipe(p) < 0) {
+        *err = errno;
+        return 0;
+    }
+    fcntl(p[1], F_SETPIPE_SZ, PIPE_SIZE);
+
+    size_t done = 0;
+    *err = 0;
+    while (done < len) {
+        ssize_t n = splice(in, NULL, p[1], NULL, step(len - done),
+                           SPLICE_F_MOVE | SPLICE_F_MORE);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) {
+            *err = n < 0 ? errno : 0;
+            break;
+        }
+        /* 管道里的数据必须全部送出, 否则下次会接着错位 */
+        size_t left = n;
+        while (left > 0) {
+            ssize_t m = splice(p[0], NULL, out, NULL, left,
+                               SPLICE_F_MOVE | SPLICE_F_MORE);
+            if (m < 0 && errno == EINTR)
+                continue;
+            if (m <= 0) {
+                /* 已从源读出但没写出的数据无法退回, 按出错处理 */
+                *err = m < 0 ? errno : EIO;
+                if (unsupported(*err))
+                    *err = EIO;
+                done += n - left;
+                goto out;
+            }
+            left -= m;
+        }
+        done += n;
+    }
+out:
+    close(p[0]);
+    close(p[1]);
+    return done;
+}
+
+static size_t copy_readwrite(int in, int out, size_t len, int* err) {
+    char* buf = aligned_alloc(4096, RW_BUFSIZE);
+    if (!buf) {
+        *err = ENOMEM;
+        return 0;
+    }
+    size_t done = 0;
+    *err = 0;
+    while (done < len) {
+        size_t want = len - done < RW_BUFSIZE ? len - done : RW_BUFSIZE;
+        ssize_t n = rio_readn(in, buf, want);
+        if (n <= 0) {
+            *err = n < 0 ? errno : 0;
+            break;
+        }
+        if (rio_writen(out, buf, n) < 0) {
+            *err = errno;
+            break;
+        }
+        done += n;
+        if ((size_t)n < want) /* EOF */
+            break;
+    }
+    free(buf);
+    return done;
+}
+
+ssize_t fcopy_fd(int in_fd, int out_fd, size_t len, fcopy_method method,
+                 fcopy_method* used) {
+    typedef size_t (*copy_fn)(int, int, size_t, int*);
+    static const copy_fn fns[FCOPY_NUM_METHODS] = {
+        NULL, copy_cfr, copy_sendfile, copy_splice, copy_readwrite};
+
+    size_t total = 0;
+    int m = method == FCOPY_AUTO ? FCOPY_COPY_FILE_RANGE : method;
+    for (; m < FCOPY_NUM_METHODS; m++) {
+        int err;
+        total += fns[m](in_fd, out_fd, len - total, &err);
+        if (used)
+            *used = m;
+        if (err == 0)
+            return total;
+        /* 换下一种方式从当前位置接着拷; read/write 是最后的退路 */
+        if (!unsupported(err) || m == FCOPY_READWRITE) {
+            errno = err;
+            return -1;
+        }
+    }
+    return total;
+}
+
+ssize_t fcopy_file(const char* src, const char* dst, fcopy_method method,
+                   fcopy_method* used) {
+    int in = open(src, O_RDONLY);
+    if (in < 0)
+        return -1;
+    struct stat st;
+    if (fstat(in, &st) < 0) {
+        close(in);
+        return -1;
+    }
+    int out = open(dst, O_WRONLY | O_CREAT | O_TRUNC, st.st_mode & 0777);
+    if (out < 0) {
+        close(in);
+        return -1;
+    }
+
+    /* 普通文件按大小拷, 其他 (管道, 设备) 拷到 EOF */
+    size_t len = S_ISREG(st.st_mode) ? (size_t)st.st_size : FCOPY_TO_EOF;
+    ssize_t n = fcopy_fd(in, out, len, method, used);
+    int err = errno;
+    close(in);
+    if (close(out) < 0 && n >= 0) {
+        err = errno;
+        n = -1;
+    }
+    errno = err;
+    return n;
+}
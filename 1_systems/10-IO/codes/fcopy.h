@@ -0,0 +1,40 @@
+#ifndef FCOPY_H
+#define FCOPY_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+/*
+ * 在内核里完成的文件拷贝 (10.3 节 read/write 循环的零拷贝版本)
+ *
+ * copy_file_range 和 sendfile 在内核中直接搬页缓存,
+ * splice 经过一条管道搬页引用, 都不经过用户缓冲区;
+ * 都不支持时退回到大缓冲区的 read/write。
+ */
+
+typedef enum {
+    FCOPY_AUTO, /* 按下面的顺序尝试, 不支持就换下一个 */
+    FCOPY_COPY_FILE_RANGE,
+    FCOPY_SENDFILE,
+    FCOPY_SPLICE,
+    FCOPY_READWRITE,
+    FCOPY_NUM_METHODS
+} fcopy_method;
+
+#define FCOPY_TO_EOF ((size_t)-1)
+
+const char* fcopy_method_name(fcopy_method method);
+
+/*
+ * 从 in_fd 的当前位置拷贝 len 字节 (FCOPY_TO_EOF 表示到文件尾) 到 out_fd。
+ * 指定的方式不被支持 (ENOSYS, EXDEV, EINVAL 等) 时自动换下一种,
+ * *used (可为 NULL) 返回最后实际使用的方式。返回拷贝的字节数, 出错返回 -1
+ */
+ssize_t fcopy_fd(int in_fd, int out_fd, size_t len, fcopy_method method,
+                 fcopy_method* used);
+
+/* 拷贝整个文件, 目标文件被截断并沿用源文件的权限 */
+ssize_t fcopy_file(const char* src, const char* dst, fcopy_method method,
+                   fcopy_method* used);
+
+#endif
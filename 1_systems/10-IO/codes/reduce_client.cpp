@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "../../05-performance/codes/vec.hpp"
+#include "reduce_proto.hpp"
+
+/*
+ * reduce_server 的压测客户端: 并发连接数逐级翻倍, 每个连接同时只有
+ * 一个请求在途 (闭环), 报告吞吐和 p50/p99 延迟
+ *
+ * 编译: g++ -std=c++20 -O2 -pthread reduce_client.cpp -o reduce_client
+ * 运行: ./reduce_client [-s] [-n elems] [-d secs] [-c max_conns] [-p path]
+ *       -s 用 memfd 传共享内存句柄, 不在套接字上传数据
+ */
+
+static double now_sec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+struct Options {
+    bool shm = false;
+    size_t elems = 4096;
+    double secs = 2;
+    int max_conns = 64;
+    const char* path = REDUCE_SOCKET;
+};
+
+struct Result {
+    std::vector<double> latencies;
+    size_t errors = 0;
+};
+
+static int connect_server(const char* path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_un addr = reduce_addr(path);
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror(path);
+        exit(1);
+    }
+    return fd;
+}
+
+static void client(const Options& o, const Vector<int>& data, double expect,
+                   double deadline, Result& res) {
+    int sock = connect_server(o.path);
+    size_t bytes = data.length() * sizeof(int);
+
+    // 内联模式: 头部和数据放在同一个缓冲区里一次发出
+    std::vector<char> msg(sizeof(ReqHeader) + (o.shm ? 0 : bytes));
+    ReqHeader h = {REDUCE_MAGIC, 0, TYPE_INT, '+', o.shm, 6, 0, data.length()};
+    int memfd = -1;
+    if (o.shm) {
+        memfd = memfd_create("reduce_client", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+        if (ftruncate(memfd, bytes) < 0 ||
+            pwrite(memfd, data.get_start(), bytes, 0) != (ssize_t)bytes ||
+            fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_SEAL) < 0) {
+            perror("memfd");
+            exit(1);
+        }
+    } else {
+        memcpy(msg.data() + sizeof(h), data.get_start(), bytes);
+    }
+
+    for (uint32_t id = 0; now_sec() < deadline; id++) {
+        h.id = id;
+        memcpy(msg.data(), &h, sizeof(h));
+        double t0 = now_sec();
+        Reply rep;
+        if (send_with_fd(sock, msg.data(), msg.size(), memfd) < 0 ||
+            recv(sock, &rep, sizeof(rep), MSG_WAITALL) != sizeof(rep)) {
+            res.errors++;
+            break;
+        }
+        res.latencies.push_back(now_sec() - t0);
+        if (rep.id != id || rep.status != 0 || rep.value != expect)
+            res.errors++;
+    }
+    if (memfd >= 0)
+        close(memfd);
+    close(sock);
+}
+
+int main(int argc, char** argv) {
+    Options o;
+    int opt;
+    while ((opt = getopt(argc, argv, "sn:d:c:p:")) != -1) {
+        switch (opt) {
+        case 's':
+            o.shm = true;
+            break;
+        case 'n':
+            o.elems = strtoul(optarg, nullptr, 10);
+            break;
+        case 'd':
+            o.secs = atof(optarg);
+            break;
+        case 'c':
+            o.max_conns = atoi(optarg);
+            break;
+        case 'p':
+            o.path = optarg;
+            break;
+        default:
+            fprintf(stderr,
+                    "usage: %s [-s] [-n elems] [-d secs] [-c max_conns] "
+                    "[-p path]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+
+    Vector<int> data(o.elems);
+    data.fill_random(0, 99);
+    int expect;
+    combine6(data, expect, '+');
+
+    printf("%zu ints per request, %s, %.1f s per level\n", o.elems,
+           o.shm ? "memfd handle" : "inline data", o.secs);
+    printf("%6s %10s %10s %10s %8s\n", "conns", "req/s", "p50 us", "p99 us",
+           "errors");
+    for (int conns = 1; conns <= o.max_conns; conns *= 2) {
+        std::vector<Result> results(conns);
+        std::vector<std::thread> threads;
+        double t0 = now_sec();
+        double deadline = t0 + o.secs;
+        for (int i = 0; i < conns; i++)
+            threads.emplace_back(client, std::cref(o), std::cref(data),
+                                 (double)expect, deadline,
+                                 std::ref(results[i]));
+        for (auto& t : threads)
+            t.join();
+        double elapsed = now_sec() - t0;
+
+        std::vector<double> all;
+        size_t errors = 0;
+        for (auto& r : results) {
+            all.insert(all.end(), r.latencies.begin(), r.latencies.end());
+            errors += r.errors;
+        }
+        if (all.empty())
+            break;
+        std::sort(all.begin(), all.end());
+        printf("%6d %10.0f %10.1f %10.1f %8zu\n", conns, all.size() / elapsed,
+               all[all.size() / 2] * 1e6, all[all.size() * 99 / 100] * 1e6,
+               errors);
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+#ifndef REDUCE_PROTO_HPP
+#define REDUCE_PROTO_HPP
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/un.h>
+
+// reduce_server 和 reduce_client 之间的协议 (Unix 域流套接字)
+//
+// 请求: ReqHeader, 然后
+//   - 内联模式: count 个 4 字节元素
+//   - 共享内存模式: 没有数据, 随头部用 SCM_RIGHTS 传一个 memfd,
+//     元素从文件偏移 0 开始; memfd 必须带 F_SEAL_SHRINK, 否则服务端
+//     映射之后文件可能被截短 (访问时 SIGBUS), 请求以 EPERM 拒绝
+// 应答: Reply, 按完成顺序返回, 用 id 对应请求
+
+#define REDUCE_SOCKET "/tmp/reduce.sock"
+#define REDUCE_MAGIC 0x52454431u // "RED1"
+#define REDUCE_MAX_COUNT (64u << 20)
+
+enum : uint8_t { TYPE_INT = 0, TYPE_FLOAT = 1 };
+
+struct ReqHeader {
+    uint32_t magic;
+    uint32_t id;
+    uint8_t type;   // TYPE_INT / TYPE_FLOAT
+    char op;        // '+' 或 '*'
+    uint8_t shm;    // 1: 数据在附带的 memfd 里
+    uint8_t kernel; // combine 内核编号 1..7
+    uint32_t reserved;
+    uint64_t count;
+};
+static_assert(sizeof(ReqHeader) == 24);
+
+struct Reply {
+    uint32_t id;
+    int32_t status; // 0 成功, 否则是 errno
+    double value;   // int 结果也能精确表示
+};
+static_assert(sizeof(Reply) == 16);
+
+// 发送 len 字节, 可附带一个描述符 (fd < 0 表示不带)
+inline int send_with_fd(int sock, const void* buf, size_t len, int fd) {
+    struct iovec iov = {const_cast<void*>(buf), len};
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } ctrl;
+    struct msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if (fd >= 0) {
+        msg.msg_control = ctrl.buf;
+        msg.msg_controllen = sizeof(ctrl.buf);
+        struct cmsghdr* c = CMSG_FIRSTHDR(&msg);
+        c->cmsg_level = SOL_SOCKET;
+        c->cmsg_type = SCM_RIGHTS;
+        c->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(c), &fd, sizeof(int));
+    }
+    // 描述符随第一段数据一起到达, 剩下的部分普通发送
+    ssize_t n;
+    while ((n = sendmsg(sock, &msg, MSG_NOSIGNAL)) < 0 && errno == EINTR)
+        ;
+    if (n < 0)
+        return -1;
+    const char* p = static_cast<const char*>(buf) + n;
+    size_t left = len - n;
+    while (left > 0) {
+        ssize_t m = send(sock, p, left, MSG_NOSIGNAL);
+        if (m < 0 && errno == EINTR)
+            continue;
+        if (m < 0)
+            return -1;
+        p += m;
+        left -= m;
+    }
+    return 0;
+}
+
+inline sockaddr_un reduce_addr(const char* path) {
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    return addr;
+}
+
+#endif
@@ -0,0 +1,485 @@
+#include <algorithm>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fcntl.h>
+#include <mutex>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#include "../../05-performance/codes/arena.hpp"
+#include "../../05-performance/codes/vec.hpp"
+#include "reduce_proto.hpp"
+
+/*
+ * 单进程 epoll 归约服务 (10.1 节的 I/O 多路复用)
+ *
+ * 一个事件循环线程负责所有套接字: 接受连接, 解析请求, 把同一轮
+ * epoll_wait 收到的请求攒成一批交给工作线程池; 工作线程用 combine
+ * 内核计算, 结果放进完成队列并写 eventfd 唤醒事件循环, 由它异步回复。
+ *
+ * 编译: g++ -std=c++20 -O2 -pthread reduce_server.cpp -o reduce_server
+ * 运行: ./reduce_server [-w workers] [-p socket_path]
+ */
+
+#define BATCH_MAX 64
+#define MAX_EVENTS 256
+#define MAX_FDS 16 // 一次 recvmsg 最多接收的描述符
+
+struct Request {
+    uint64_t conn;
+    ReqHeader h;
+    std::vector<char> data; // 内联模式的元素
+    int fd = -1;            // 共享内存模式的 memfd
+};
+
+struct Conn {
+    int fd;
+    uint64_t id;
+    std::vector<char> in;
+    std::vector<char> out;
+    size_t out_off = 0;
+    std::deque<int> fds; // 已收到, 还没被请求取走的描述符
+    size_t pending = 0;  // 已交给工作线程, 还没回复的请求
+    bool eof = false;    // 对端已半关闭, 回复发完后关闭连接
+    uint32_t events = EPOLLIN;
+};
+
+static volatile sig_atomic_t stop;
+
+// 工作队列和完成队列
+static std::mutex work_mu;
+static std::condition_variable work_cv;
+static std::deque<std::vector<Request>> work;
+static bool shutting_down;
+
+static std::mutex done_mu;
+static std::vector<std::pair<uint64_t, Reply>> done;
+static int done_efd;
+
+template <typename T>
+static const CombineFunction<T>& kernel(int k) {
+    static const CombineFunction<T> table[] = {
+        combine1<T>, combine2<T>, combine3<T>, combine4<T>,
+        combine5<T>, combine6<T>, combine7<T>};
+    return table[k - 1];
+}
+
+template <typename T>
+static double run_kernel(const ReqHeader& h, const char* src, Arena& arena) {
+    // 元素拷进从 arena 分配的 Vector, 批处理结束时整体回收
+    Vector<T> v(h.count, no_init, &arena);
+    memcpy(v.get_start(), src, h.count * sizeof(T));
+    T r;
+    kernel<T>(h.kernel)(v, r, h.op);
+    return (double)r;
+}
+
+static Reply serve(Request& req, Arena& arena) {
+    Reply rep = {req.h.id, 0, 0};
+    size_t bytes = req.h.count * 4;
+    const char* src = req.data.data();
+    void* map = nullptr;
+    if (req.h.shm) {
+        // 映射超出文件末尾的部分一访问就是 SIGBUS。客户端仍持有 memfd,
+        // 只检查大小挡不住之后的 ftruncate, 所以要求它已封住缩小
+        struct stat st;
+        int seals = fcntl(req.fd, F_GET_SEALS);
+        if (seals < 0)
+            rep.status = errno == EINVAL ? EPERM : errno;
+        else if (!(seals & F_SEAL_SHRINK))
+            rep.status = EPERM;
+        else if (fstat(req.fd, &st) < 0)
+            rep.status = errno;
+        else if ((size_t)st.st_size < bytes)
+            rep.status = EINVAL;
+        if (rep.status) {
+            close(req.fd);
+            return rep;
+        }
+        map = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, req.fd, 0);
+        close(req.fd);
+        if (map == MAP_FAILED) {
+            rep.status = errno;
+            return rep;
+        }
+        src = static_cast<const char*>(map);
+    }
+    rep.value = req.h.type == TYPE_INT ? run_kernel<int>(req.h, src, arena)
+                                       : run_kernel<float>(req.h, src, arena);
+    if (map)
+        munmap(map, bytes);
+    return rep;
+}
+
+static void worker() {
+    Arena arena;
+    std::vector<std::pair<uint64_t, Reply>> replies;
+    for (;;) {
+        std::vector<Request> batch;
+        {
+            std::unique_lock<std::mutex> lock(work_mu);
+            work_cv.wait(lock, [] { return shutting_down || !work.empty(); });
+            if (work.empty())
+                return;
+            batch = std::move(work.front());
+            work.pop_front();
+        }
+
+        replies.clear();
+        for (Request& req : batch)
+            replies.emplace_back(req.conn, serve(req, arena));
+        arena.reset();
+
+        {
+            std::lock_guard<std::mutex> lock(done_mu);
+            done.insert(done.end(), replies.begin(), replies.end());
+        }
+        uint64_t one = 1;
+        if (write(done_efd, &one, sizeof(one)) < 0)
+            perror("eventfd");
+    }
+}
+
+class Server {
+    int ep;
+    int listen_fd;
+    uint64_t next_id = 1;
+    std::unordered_map<uint64_t, Conn*> conns;
+    std::vector<Request> batch;
+
+public:
+    size_t requests = 0, batches = 0;
+
+    Server(int listen_fd) : listen_fd(listen_fd) {
+        ep = epoll_create1(EPOLL_CLOEXEC);
+        add(listen_fd, EPOLLIN, 0);
+        add(done_efd, EPOLLIN, 1);
+    }
+
+    // data.u64: 0 监听套接字, 1 eventfd, 其余为连接 id
+    void add(int fd, uint32_t events, uint64_t id) {
+        epoll_event ev = {};
+        ev.events = events;
+        ev.data.u64 = id;
+        epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    void close_conn(Conn* c) {
+        epoll_ctl(ep, EPOLL_CTL_DEL, c->fd, nullptr);
+        close(c->fd);
+        for (int fd : c->fds)
+            close(fd);
+        conns.erase(c->id);
+        delete c;
+    }
+
+    void accept_all() {
+        int fd;
+        while ((fd = accept4(listen_fd, nullptr, nullptr,
+                             SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+            Conn* c = new Conn;
+            c->fd = fd;
+            c->id = ++next_id;
+            conns[c->id] = c;
+            add(fd, EPOLLIN, c->id);
+        }
+    }
+
+    // 尽量写出, 写不完就等 EPOLLOUT
+    bool flush(Conn* c) {
+        while (c->out_off < c->out.size()) {
+            ssize_t n = send(c->fd, c->out.data() + c->out_off,
+                             c->out.size() - c->out_off, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n < 0 && errno != EAGAIN)
+                return false;
+            if (n < 0)
+                break;
+            c->out_off += n;
+        }
+        if (c->out_off == c->out.size()) {
+            c->out.clear();
+            c->out_off = 0;
+        }
+        update_events(c);
+        return true;
+    }
+
+    // 半关闭之后不再关心可读 (否则水平触发的 EPOLLIN 会一直报告)
+    void update_events(Conn* c) {
+        uint32_t events = 0;
+        if (!c->eof)
+            events |= EPOLLIN;
+        if (!c->out.empty())
+            events |= EPOLLOUT;
+        if (events != c->events) {
+            epoll_event ev = {};
+            ev.events = events;
+            ev.data.u64 = c->id;
+            epoll_ctl(ep, EPOLL_CTL_MOD, c->fd, &ev);
+            c->events = events;
+        }
+    }
+
+    bool finished(const Conn* c) const {
+        return c->eof && c->pending == 0 && c->out.empty();
+    }
+
+    void queue_reply(Conn* c, const Reply& r) {
+        const char* p = reinterpret_cast<const char*>(&r);
+        c->out.insert(c->out.end(), p, p + sizeof(r));
+    }
+
+    // 读入所有可读数据和描述符, 拆出完整的请求; 返回 false 表示关闭连接
+    bool read_conn(Conn* c) {
+        char buf[1 << 16];
+        for (;;) {
+            iovec iov = {buf, sizeof(buf)};
+            union {
+                cmsghdr align;
+                char buf[CMSG_SPACE(sizeof(int) * MAX_FDS)];
+            } ctrl;
+            msghdr msg = {};
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            msg.msg_control = ctrl.buf;
+            msg.msg_controllen = sizeof(ctrl.buf);
+            ssize_t n = recvmsg(c->fd, &msg, MSG_CMSG_CLOEXEC);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n < 0 && errno == EAGAIN)
+                break;
+            if (n < 0)
+                return false;
+            if (n == 0) {
+                // 对端半关闭: 已经收到的请求照常处理, 回复发完后再关
+                c->eof = true;
+                update_events(c);
+                break;
+            }
+            for (cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm;
+                 cm = CMSG_NXTHDR(&msg, cm)) {
+                if (cm->cmsg_level != SOL_SOCKET ||
+                    cm->cmsg_type != SCM_RIGHTS)
+                    continue;
+                size_t k = (cm->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                for (size_t i = 0; i < k; i++) {
+                    int fd;
+                    memcpy(&fd, CMSG_DATA(cm) + i * sizeof(int), sizeof(int));
+                    c->fds.push_back(fd);
+                }
+            }
+            // 描述符被截断后剩下的无法和请求对应, 关闭连接
+            // (已收到的在 close_conn 里关闭)
+            if (msg.msg_flags & MSG_CTRUNC)
+                return false;
+            c->in.insert(c->in.end(), buf, buf + n);
+        }
+        return parse(c);
+    }
+
+    bool parse(Conn* c) {
+        size_t off = 0;
+        while (c->in.size() - off >= sizeof(ReqHeader)) {
+            ReqHeader h;
+            memcpy(&h, c->in.data() + off, sizeof(h));
+            if (h.magic != REDUCE_MAGIC)
+                return false;
+            size_t need = h.shm ? 0 : h.count * 4;
+            if (!h.shm && h.count <= REDUCE_MAX_COUNT &&
+                c->in.size() - off - sizeof(h) < need)
+                break; // 数据还没到齐
+
+            off += sizeof(h);
+            Request req;
+            req.conn = c->id;
+            req.h = h;
+            // 共享内存请求无论是否合法都取走自己的描述符,
+            // 否则后面的请求会拿到错位的缓冲区
+            int shm_fd = -1;
+            if (h.shm && !c->fds.empty()) {
+                shm_fd = c->fds.front();
+                c->fds.pop_front();
+            }
+            int err = 0;
+            if (h.count == 0 || h.count > REDUCE_MAX_COUNT ||
+                h.type > TYPE_FLOAT || h.kernel < 1 || h.kernel > 7 ||
+                (h.op != '+' && h.op != '*'))
+                err = EINVAL;
+            else if (h.shm && shm_fd < 0)
+                err = EBADMSG;
+            if (err) {
+                if (shm_fd >= 0)
+                    close(shm_fd);
+                // 请求长度不可信时无法继续解析这个连接
+                if (h.count > REDUCE_MAX_COUNT && !h.shm)
+                    return false;
+                off += need;
+                queue_reply(c, Reply{h.id, err, 0});
+                continue;
+            }
+            if (h.shm) {
+                req.fd = shm_fd;
+            } else {
+                req.data.assign(c->in.data() + off, c->in.data() + off + need);
+                off += need;
+            }
+            batch.push_back(std::move(req));
+            c->pending++;
+            requests++;
+        }
+        c->in.erase(c->in.begin(), c->in.begin() + off);
+        return true;
+    }
+
+    void deliver_replies() {
+        uint64_t cnt;
+        if (read(done_efd, &cnt, sizeof(cnt)) < 0)
+            return;
+        std::vector<std::pair<uint64_t, Reply>> ready;
+        {
+            std::lock_guard<std::mutex> lock(done_mu);
+            ready.swap(done);
+        }
+        std::vector<Conn*> touched;
+        for (auto& [id, rep] : ready) {
+            auto it = conns.find(id);
+            if (it == conns.end()) // 连接已经关了
+                continue;
+            it->second->pending--;
+            if (it->second->out.empty())
+                touched.push_back(it->second);
+            queue_reply(it->second, rep);
+        }
+        for (Conn* c : touched) {
+            if (!flush(c) || finished(c))
+                close_conn(c);
+        }
+    }
+
+    // 把这一轮攒下的请求按 BATCH_MAX 切开交给工作线程
+    void dispatch() {
+        if (batch.empty())
+            return;
+        {
+            std::lock_guard<std::mutex> lock(work_mu);
+            for (size_t i = 0; i < batch.size(); i += BATCH_MAX) {
+                size_t end = std::min(batch.size(), i + BATCH_MAX);
+                work.emplace_back(std::make_move_iterator(batch.begin() + i),
+                                  std::make_move_iterator(batch.begin() + end));
+                batches++;
+            }
+        }
+        work_cv.notify_all();
+        batch.clear();
+    }
+
+    void run() {
+        epoll_event events[MAX_EVENTS];
+        while (!stop) {
+            int n = epoll_wait(ep, events, MAX_EVENTS, -1);
+            if (n < 0) {
+                if (errno == EINTR)
+                    continue;
+                perror("epoll_wait");
+                return;
+            }
+            for (int i = 0; i < n; i++) {
+                uint64_t id = events[i].data.u64;
+                if (id == 0) {
+                    accept_all();
+                    continue;
+                }
+                if (id == 1) {
+                    deliver_replies();
+                    continue;
+                }
+                auto it = conns.find(id);
+                if (it == conns.end())
+                    continue;
+                Conn* c = it->second;
+                uint32_t ev = events[i].events;
+                bool ok = true;
+                if ((ev & (EPOLLIN | EPOLLHUP | EPOLLERR)) && !c->eof)
+                    ok = read_conn(c);
+                if (ok && !c->out.empty())
+                    ok = flush(c);
+                // EPOLLHUP: 两个方向都关了, 回复已经送不出去
+                if (!ok || (ev & (EPOLLHUP | EPOLLERR)) || finished(c))
+                    close_conn(c);
+            }
+            dispatch();
+        }
+    }
+};
+
+static void on_signal(int) {
+    stop = 1;
+}
+
+int main(int argc, char** argv) {
+    int nworkers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    const char* path = REDUCE_SOCKET;
+    int opt;
+    while ((opt = getopt(argc, argv, "w:p:")) != -1) {
+        switch (opt) {
+        case 'w':
+            nworkers = std::max(1, atoi(optarg));
+            break;
+        case 'p':
+            path = optarg;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-w workers] [-p socket_path]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+
+    int lfd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    sockaddr_un addr = reduce_addr(path);
+    unlink(path);
+    if (bind(lfd, (sockaddr*)&addr, sizeof(addr)) < 0 ||
+        listen(lfd, 1024) < 0) {
+        perror(path);
+        return 1;
+    }
+    done_efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    struct sigaction sa = {};
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+
+    std::vector<std::thread> pool;
+    for (int i = 0; i < nworkers; i++)
+        pool.emplace_back(worker);
+    printf("listening on %s, %d workers\n", path, nworkers);
+    fflush(stdout);
+
+    Server server(lfd);
+    server.run();
+
+    {
+        std::lock_guard<std::mutex> lock(work_mu);
+        shutting_down = true;
+    }
+    work_cv.notify_all();
+    for (auto& t : pool)
+        t.join();
+    unlink(path);
+    printf("%zu requests in %zu batches (%.1f per batch)\n", server.requests,
+           server.batches,
+           server.batches ? (double)server.requests / server.batches : 0.0);
+    return 0;
+}
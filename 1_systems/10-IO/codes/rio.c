@@ -0,0 +1,229 @@
+#include "rio.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+ssize_t rio_readn(int fd, void* usrbuf, size_t n) {
+    size_t nleft = n;
+    char* bufp = usrbuf;
+
+    while (nleft > 0) {
+        ssize_t nread = read(fd, bufp, nleft);
+        if (nread < 0) {
+            if (errno == EINTR) /* 被信号处理程序打断, 重新读 */
+                continue;
+            return -1;
+        }
+        if (nread == 0) /* EOF */
+            break;
+        nleft -= nread;
+        bufp += nread;
+    }
+    return n - nleft;
+}
+
+ssize_t rio_writen(int fd, const void* usrbuf, size_t n) {
+    size_t nleft = n;
+    const char* bufp = usrbuf;
+
+    while (nleft > 0) {
+        ssize_t nwritten = write(fd, bufp, nleft);
+        if (nwritten < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        nleft -= nwritten;
+        bufp += nwritten;
+    }
+    return n;
+}
+
+int rio_init(rio_t* rp, int fd, size_t bufsize) {
+    rp->fd = fd;
+    rp->cap = bufsize ? bufsize : RIO_DEFAULT_BUFSIZE;
+    rp->buf = malloc(rp->cap);
+    rp->bufptr = rp->buf;
+    rp->cnt = 0;
+    rp->eof = 0;
+    return rp->buf ? 0 : -1;
+}
+
+void rio_free(rio_t* rp) {
+    free(rp->buf);
+    rp->buf = rp->bufptr = NULL;
+    rp->cap = rp->cnt = 0;
+}
+
+/*
+ * 把未读数据挪到缓冲区开头, 再尽量读满剩余空间 (一次 read)。
+ * 调用者保证缓冲区没满, 否则 read 0 字节会被当成 EOF
+ */
+static ssize_t rio_fill(rio_t* rp) {
+    if (rp->eof)
+        return 0;
+    if (rp->bufptr != rp->buf) {
+        memmove(rp->buf, rp->bufptr, rp->cnt);
+        rp->bufptr = rp->buf;
+    }
+    for (;;) {
+        ssize_t n = read(rp->fd, rp->buf + rp->cnt, rp->cap - rp->cnt);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n == 0)
+            rp->eof = 1;
+        if (n > 0)
+            rp->cnt += n;
+        return n;
+    }
+}
+
+/* 缓冲区放不下 need 字节时扩大 */
+static int rio_reserve(rio_t* rp, size_t need) {
+    if (need <= rp->cap)
+        return 0;
+    size_t cap = rp->cap;
+    while (cap < need)
+        cap *= 2;
+    size_t off = rp->bufptr - rp->buf;
+    char* buf = realloc(rp->buf, cap);
+    if (!buf)
+        return -1;
+    rp->buf = buf;
+    rp->bufptr = buf + off;
+    rp->cap = cap;
+    return 0;
+}
+
+ssize_t rio_read(rio_t* rp, void* usrbuf, size_t n) {
+    while (rp->cnt == 0) {
+        ssize_t r = rio_fill(rp);
+        if (r <= 0)
+            return r;
+    }
+    size_t cnt = n < rp->cnt ? n : rp->cnt;
+    memcpy(usrbuf, rp->bufptr, cnt);
+    rp->bufptr += cnt;
+    rp->cnt -= cnt;
+    return cnt;
+}
+
+ssize_t rio_readnb(rio_t* rp, void* usrbuf, size_t n) {
+    char* bufp = usrbuf;
+    size_t nleft = n;
+
+    /* 先交出缓冲区里已有的数据 */
+    size_t cnt = nleft < rp->cnt ? nleft : rp->cnt;
+    memcpy(bufp, rp->bufptr, cnt);
+    rp->bufptr += cnt;
+    rp->cnt -= cnt;
+    bufp += cnt;
+    nleft -= cnt;
+
+    /*
+     * 剩下的不小于缓冲区时, readv 把记录的其余部分直接读进用户内存,
+     * 同一次系统调用顺便把后面的数据读进缓冲区, 省掉一次拷贝
+     */
+    while (nleft >= rp->cap && !rp->eof) {
+        struct iovec iov[2] = {{bufp, nleft}, {rp->buf, rp->cap}};
+        ssize_t r = readv(rp->fd, iov, 2);
+        if (r < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        if (r == 0) {
+            rp->eof = 1;
+            break;
+        }
+        if ((size_t)r > nleft) {
+            rp->bufptr = rp->buf;
+            rp->cnt = r - nleft;
+            r = nleft;
+        }
+        bufp += r;
+        nleft -= r;
+    }
+
+    while (nleft > 0) {
+        ssize_t r = rio_read(rp, bufp, nleft);
+        if (r < 0)
+            return -1;
+        if (r == 0)
+            break;
+        bufp += r;
+        nleft -= r;
+    }
+    return n - nleft;
+}
+
+ssize_t rio_readlineb(rio_t* rp, void* usrbuf, size_t maxlen) {
+    char* bufp = usrbuf;
+    size_t n = 0;
+
+    while (n + 1 < maxlen) {
+        if (rp->cnt == 0) {
+            ssize_t r = rio_fill(rp);
+            if (r < 0)
+                return -1;
+            if (r == 0)
+                break;
+        }
+        /* 在缓冲区里整段找换行, 而不是一次一个字节 */
+        size_t avail = rp->cnt < maxlen - 1 - n ? rp->cnt : maxlen - 1 - n;
+        char* nl = memchr(rp->bufptr, '\n', avail);
+        size_t take = nl ? (size_t)(nl - rp->bufptr) + 1 : avail;
+        memcpy(bufp + n, rp->bufptr, take);
+        rp->bufptr += take;
+        rp->cnt -= take;
+        n += take;
+        if (nl)
+            break;
+    }
+    if (maxlen > 0)
+        bufp[n] = '\0';
+    return n;
+}
+
+ssize_t rio_peekline(rio_t* rp, const char** line) {
+    size_t scanned = 0; /* 已经确认不含换行的前缀长度 */
+    for (;;) {
+        char* nl = memchr(rp->bufptr + scanned, '\n', rp->cnt - scanned);
+        if (nl || (rp->eof && rp->cnt > 0)) {
+            size_t len = nl ? (size_t)(nl - rp->bufptr) + 1 : rp->cnt;
+            *line = rp->bufptr;
+            rp->bufptr += len;
+            rp->cnt -= len;
+            return len;
+        }
+        if (rp->eof)
+            return 0;
+        scanned = rp->cnt;
+        if (rp->cnt == rp->cap && rio_reserve(rp, rp->cap * 2) < 0)
+            return -1;
+        if (rio_fill(rp) < 0)
+            return -1;
+    }
+}
+
+ssize_t rio_peek(rio_t* rp, const char** p, size_t n) {
+    if (rio_reserve(rp, n) < 0)
+        return -1;
+    while (rp->cnt < n && !rp->eof) {
+        /* 缓冲区尾部放不下时 rio_fill 会先把未读数据挪到开头 */
+        if (rio_fill(rp) < 0)
+            return -1;
+    }
+    *p = rp->bufptr;
+    return rp->cnt < n ? rp->cnt : n;
+}
+
+void rio_consume(rio_t* rp, size_t n) {
+    if (n > rp->cnt)
+        n = rp->cnt;
+    rp->bufptr += n;
+    rp->cnt -= n;
+}
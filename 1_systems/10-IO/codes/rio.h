@@ -0,0 +1,59 @@
+#ifndef RIO_H
+#define RIO_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+/*
+ * 健壮的 I/O 包 (RIO): 处理 read/write 的不足值和 EINTR (10.3 节)
+ *
+ * - 无缓冲: rio_readn / rio_writen 一直读写到 n 字节, EOF 或出错为止
+ * - 带缓冲: rio_t 包装一个描述符, 提供按行 (rio_readlineb) 和
+ *   按记录 (rio_readnb) 读取; 大记录用 readv 同时读进用户内存和缓冲区
+ * - 零拷贝: rio_peekline / rio_peek 直接返回指向内部缓冲区的指针,
+ *   在下一次调用该 rio_t 之前有效
+ *
+ * 同一个描述符不要混用带缓冲和无缓冲的函数。
+ */
+
+#define RIO_DEFAULT_BUFSIZE (64 << 10)
+
+typedef struct {
+    int fd;
+    char* buf;    /* 内部缓冲区 */
+    size_t cap;   /* 缓冲区大小 */
+    char* bufptr; /* 下一个未读字节 */
+    size_t cnt;   /* 未读字节数 */
+    int eof;      /* 已经读到 EOF */
+} rio_t;
+
+ssize_t rio_readn(int fd, void* usrbuf, size_t n);
+ssize_t rio_writen(int fd, const void* usrbuf, size_t n);
+
+/* bufsize 为 0 时用 RIO_DEFAULT_BUFSIZE, 失败返回 -1 */
+int rio_init(rio_t* rp, int fd, size_t bufsize);
+void rio_free(rio_t* rp);
+
+/* 读至多 n 字节, 可能返回不足值; 0 表示 EOF */
+ssize_t rio_read(rio_t* rp, void* usrbuf, size_t n);
+
+/* 记录模式: 读满 n 字节, 只有遇到 EOF 才返回不足值 */
+ssize_t rio_readnb(rio_t* rp, void* usrbuf, size_t n);
+
+/* 行模式: 读一行 (含 '\n') 到 usrbuf, 至多 maxlen-1 字节, 末尾补 '\0' */
+ssize_t rio_readlineb(rio_t* rp, void* usrbuf, size_t maxlen);
+
+/*
+ * 零拷贝行模式: *line 指向缓冲区里的下一行 (含 '\n', 不以 '\0' 结尾),
+ * 返回其长度并消费掉它。行比缓冲区长时缓冲区会扩大。0 表示 EOF
+ */
+ssize_t rio_peekline(rio_t* rp, const char** line);
+
+/*
+ * 零拷贝记录模式: 保证缓冲区里至少有 n 字节 (EOF 时可能更少),
+ * *p 指向它们, 返回可用字节数。不消费数据, 用 rio_consume 跳过
+ */
+ssize_t rio_peek(rio_t* rp, const char** p, size_t n);
+void rio_consume(rio_t* rp, size_t n);
+
+#endif
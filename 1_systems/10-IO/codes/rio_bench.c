@@ -0,0 +1,209 @@
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "rio.h"
+
+/*
+ * RIO 和 stdio 的对比: 按行读文本 (fgets / rio_readlineb / rio_peekline),
+ * 按记录读二进制 (fread / rio_readnb / rio_peek), 以及大记录的 readv 路径。
+ * 文件先读一遍进页缓存, 测的是用户态的缓冲开销
+ *
+ * 编译: gcc -O2 rio.c rio_bench.c -o rio_bench
+ * 运行: ./rio_bench [MB] [bufsize_KB]
+ */
+
+#define MAXLINE 8192
+#define RECORD 100
+#define BIG_RECORD (1 << 20)
+
+static const char* text_path = "rio_bench.txt";
+static const char* bin_path = "rio_bench.bin";
+static size_t bufsize;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* 随机长度 (1..200 字节) 的文本行, 以及随机字节的二进制文件 */
+static void make_files(size_t bytes) {
+    static char buf[1 << 16];
+    int tfd = open(text_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    int bfd = open(bin_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (tfd < 0 || bfd < 0) {
+        perror("open");
+        exit(1);
+    }
+    uint64_t x = 88172645463325252ULL;
+    for (size_t done = 0; done < bytes; done += sizeof(buf)) {
+        size_t n = 0;
+        while (n < sizeof(buf) - 256) {
+            x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+            size_t len = 1 + x % 200;
+            for (size_t i = 0; i < len; i++)
+                buf[n++] = 'a' + (x >> (i % 32)) % 26;
+            buf[n++] = '\n';
+        }
+        rio_writen(tfd, buf, n);
+        for (size_t i = 0; i < sizeof(buf); i += 8) {
+            x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+            memcpy(buf + i, &x, 8);
+        }
+        rio_writen(bfd, buf, sizeof(buf));
+    }
+    close(tfd);
+    close(bfd);
+}
+
+static int open_or_die(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        exit(1);
+    }
+    return fd;
+}
+
+/* 每种读法都算一个校验和, 结果一致才说明读到的数据相同 */
+static uint64_t mix(uint64_t h, const char* p, size_t n) {
+    h = h * 31 + n;
+    if (n > 0)
+        h = h * 31 + (unsigned char)p[0] + (unsigned char)p[n - 1];
+    return h;
+}
+
+static uint64_t lines_fgets(size_t maxlen) {
+    FILE* f = fopen(text_path, "r");
+    static char line[MAXLINE];
+    uint64_t h = 0;
+    while (fgets(line, maxlen, f))
+        h = mix(h, line, strlen(line));
+    fclose(f);
+    return h;
+}
+
+static uint64_t lines_readlineb(size_t maxlen) {
+    rio_t rio;
+    static char line[MAXLINE];
+    int fd = open_or_die(text_path);
+    rio_init(&rio, fd, bufsize);
+    uint64_t h = 0;
+    ssize_t n;
+    while ((n = rio_readlineb(&rio, line, maxlen)) > 0)
+        h = mix(h, line, n);
+    rio_free(&rio);
+    close(fd);
+    return h;
+}
+
+static uint64_t lines_peekline(size_t maxlen) {
+    (void)maxlen; /* 行多长都行 */
+    rio_t rio;
+    int fd = open_or_die(text_path);
+    rio_init(&rio, fd, bufsize);
+    uint64_t h = 0;
+    const char* line;
+    ssize_t n;
+    while ((n = rio_peekline(&rio, &line)) > 0)
+        h = mix(h, line, n);
+    rio_free(&rio);
+    close(fd);
+    return h;
+}
+
+static uint64_t records_fread(size_t size) {
+    FILE* f = fopen(bin_path, "rb");
+    char* rec = malloc(size);
+    uint64_t h = 0;
+    size_t n;
+    while ((n = fread(rec, 1, size, f)) > 0)
+        h = mix(h, rec, n);
+    free(rec);
+    fclose(f);
+    return h;
+}
+
+static uint64_t records_readnb(size_t size) {
+    rio_t rio;
+    int fd = open_or_die(bin_path);
+    rio_init(&rio, fd, bufsize);
+    char* rec = malloc(size);
+    uint64_t h = 0;
+    ssize_t n;
+    while ((n = rio_readnb(&rio, rec, size)) > 0)
+        h = mix(h, rec, n);
+    free(rec);
+    rio_free(&rio);
+    close(fd);
+    return h;
+}
+
+static uint64_t records_peek(size_t size) {
+    rio_t rio;
+    int fd = open_or_die(bin_path);
+    rio_init(&rio, fd, bufsize);
+    uint64_t h = 0;
+    const char* rec;
+    ssize_t n;
+    while ((n = rio_peek(&rio, &rec, size)) > 0) {
+        h = mix(h, rec, n);
+        rio_consume(&rio, n);
+    }
+    rio_free(&rio);
+    close(fd);
+    return h;
+}
+
+static uint64_t reference;
+
+static void run(const char* name, uint64_t (*fn)(size_t), size_t arg,
+                size_t bytes, int first) {
+    double best = 1e9;
+    uint64_t h = 0;
+    for (int r = 0; r < 3; r++) {
+        double t0 = now_sec();
+        h = fn(arg);
+        double t = now_sec() - t0;
+        if (t < best)
+            best = t;
+    }
+    if (first)
+        reference = h;
+    printf("  %-16s %8.0f MB/s%s\n", name, bytes / best / 1e6,
+           h == reference ? "" : "  CHECKSUM MISMATCH");
+}
+
+int main(int argc, char** argv) {
+    size_t mb = argc > 1 ? strtoul(argv[1], NULL, 10) : 256;
+    bufsize = argc > 2 ? strtoul(argv[2], NULL, 10) << 10 : 0;
+    size_t bytes = mb << 20;
+
+    make_files(bytes);
+    records_fread(BIG_RECORD); /* 预热页缓存 */
+    lines_fgets(MAXLINE);
+
+    printf("%zu MB, rio buffer %zu KB, stdio buffer %d B\n", mb,
+           (bufsize ? bufsize : RIO_DEFAULT_BUFSIZE) >> 10, BUFSIZ);
+    printf("text lines:\n");
+    run("fgets", lines_fgets, MAXLINE, bytes, 1);
+    run("rio_readlineb", lines_readlineb, MAXLINE, bytes, 0);
+    run("rio_peekline", lines_peekline, MAXLINE, bytes, 0);
+
+    size_t sizes[] = {RECORD, BIG_RECORD};
+    for (int i = 0; i < 2; i++) {
+        printf("binary, %zu-byte records:\n", sizes[i]);
+        run("fread", records_fread, sizes[i], bytes, 1);
+        run("rio_readnb", records_readnb, sizes[i], bytes, 0);
+        run("rio_peek", records_peek, sizes[i], bytes, 0);
+    }
+
+    unlink(text_path);
+    unlink(bin_path);
+    return 0;
+}